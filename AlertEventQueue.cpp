@@ -0,0 +1,92 @@
+#include "AlertEventQueue.h"
+
+#include <algorithm>
+#include <utility>
+
+AlertEventQueue::AlertEventQueue(size_t capacity)
+    : m_capacity(capacity > 0 ? capacity : 1) {
+}
+
+bool AlertEventQueue::push(AlertEvent event) {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_stopped) {
+            return false;
+        }
+        ++m_pushed;
+        // 同类型的待处理事件移除后把新事件放到队尾，消费者最后看到的是最新状态、动作和帧
+        auto it = std::find_if(m_events.begin(), m_events.end(),
+            [&event](const AlertEvent& pending) { return pending.type == event.type; });
+        if (it != m_events.end()) {
+            m_events.erase(it);
+            ++m_coalesced;
+        }
+        else if (m_events.size() >= m_capacity) {
+            m_events.pop_front();
+            ++m_dropped;
+        }
+        m_events.emplace_back(std::move(event));
+    }
+    m_cond.notify_one();
+    return true;
+}
+
+bool AlertEventQueue::waitPop(AlertEvent& event, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_cond.wait_for(lock, timeout, [this] { return m_stopped || !m_events.empty(); });
+    if (m_stopped || m_events.empty()) {
+        return false;
+    }
+    event = std::move(m_events.front());
+    m_events.pop_front();
+
+    double waitMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - event.timestamp).count();
+    ++m_popped;
+    m_waitSumMs += waitMs;
+    m_waitMaxMs = (std::max)(m_waitMaxMs, waitMs);
+    return true;
+}
+
+void AlertEventQueue::markHandled(const AlertEvent& event) {
+    double e2eMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - event.timestamp).count();
+    std::lock_guard<std::mutex> lock(m_mtx);
+    ++m_handled;
+    m_e2eSumMs += e2eMs;
+    m_e2eMaxMs = (std::max)(m_e2eMaxMs, e2eMs);
+}
+
+void AlertEventQueue::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_stopped = true;
+        m_events.clear();
+    }
+    m_cond.notify_all();
+}
+
+void AlertEventQueue::reset() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_stopped = false;
+    m_events.clear();
+}
+
+size_t AlertEventQueue::size() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_events.size();
+}
+
+AlertEventQueue::Stats AlertEventQueue::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    Stats stats;
+    stats.pushed = m_pushed;
+    stats.coalesced = m_coalesced;
+    stats.dropped = m_dropped;
+    stats.handled = m_handled;
+    stats.queueWaitAvgMs = m_popped ? m_waitSumMs / m_popped : 0.0;
+    stats.queueWaitMaxMs = m_waitMaxMs;
+    stats.endToEndAvgMs = m_handled ? m_e2eSumMs / m_handled : 0.0;
+    stats.endToEndMaxMs = m_e2eMaxMs;
+    return stats;
+}
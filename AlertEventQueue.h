@@ -0,0 +1,72 @@
+#ifndef ALERT_EVENT_QUEUE_H
+#define ALERT_EVENT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include "FramePool.h"
+
+// 告警事件：类型 + 动作(证据类型) + 触发时刻 + 触发帧
+struct AlertEvent {
+    int type{ 0 };
+    uint32_t actions{ 0 };
+    std::chrono::steady_clock::time_point timestamp;
+    FrameHandle frame;
+};
+
+/**
+ * AlertEventQueue - 有界多生产者/单消费者告警事件队列
+ * 消费者通过条件变量阻塞等待，事件入队即唤醒，不再轮询；
+ * 同一类型在队列中最多保留一个待处理事件：新事件替换旧事件并移到队尾，保证队尾是检测线程的最新状态；
+ * 不同类型的突发事件各自保留，不会被最后写入的覆盖。
+ */
+class AlertEventQueue {
+public:
+    struct Stats {
+        uint64_t pushed{ 0 };
+        uint64_t coalesced{ 0 };      // 同类型事件合并次数
+        uint64_t dropped{ 0 };        // 队列满丢弃的最旧事件
+        uint64_t handled{ 0 };
+        double queueWaitAvgMs{ 0.0 }; // 触发到出队
+        double queueWaitMaxMs{ 0.0 };
+        double endToEndAvgMs{ 0.0 };  // 触发到处理完成
+        double endToEndMaxMs{ 0.0 };
+    };
+
+    explicit AlertEventQueue(size_t capacity = 16);
+
+    // 生产者：入队，同类型已在队列中时合并；已停止返回false
+    bool push(AlertEvent event);
+    // 消费者：阻塞等待事件，超时或停止返回false
+    bool waitPop(AlertEvent& event, std::chrono::milliseconds timeout);
+    // 消费者：事件处理完成，记录端到端延迟
+    void markHandled(const AlertEvent& event);
+
+    void stop();
+    void reset();
+    size_t size() const;
+    Stats getStats() const;
+
+private:
+    const size_t m_capacity;
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cond;
+    std::deque<AlertEvent> m_events;
+    bool m_stopped{ false };
+
+    uint64_t m_pushed{ 0 };
+    uint64_t m_coalesced{ 0 };
+    uint64_t m_dropped{ 0 };
+    uint64_t m_handled{ 0 };
+    uint64_t m_popped{ 0 };
+    double m_waitSumMs{ 0.0 };
+    double m_waitMaxMs{ 0.0 };
+    double m_e2eSumMs{ 0.0 };
+    double m_e2eMaxMs{ 0.0 };
+};
+
+#endif // ALERT_EVENT_QUEUE_H
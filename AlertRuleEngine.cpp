@@ -0,0 +1,248 @@
+#include "AlertRuleEngine.h"
+#include "json/json.h"
+
+#include <sstream>
+
+namespace {
+
+int32_t classFromName(const std::string& name) {
+    if ("face" == name) { return CLASS_FACE; }
+    if ("lens" == name) { return CLASS_LENS; }
+    if ("phone" == name) { return CLASS_PHONE; }
+    if ("suspect" == name) { return CLASS_SUSPECT; }
+    return -1;
+}
+
+uint32_t actionFromName(const std::string& name) {
+    if ("alert" == name) { return ACTION_ALERT; }
+    if ("screenshot" == name) { return ACTION_SCREENSHOT; }
+    if ("camera" == name) { return ACTION_CAMERA; }
+    if ("lock" == name) { return ACTION_LOCK; }
+    return 0;
+}
+
+} // namespace
+
+void AlertRuleTable::addRule(const Rule& rule) {
+    m_rules.push_back(rule);
+    if (rule.occluded >= 0) {
+        m_needsOcclusion = true;
+    }
+    if (rule.alertType >= 0) {
+        const size_t type = static_cast<size_t>(rule.alertType);
+        if (type >= m_typeActions.size()) {
+            m_typeActions.resize(type + 1, 0);
+            m_typeSeen.resize(type + 1, 0);
+        }
+        if (!m_typeSeen[type]) {
+            m_typeSeen[type] = 1;
+            m_typeActions[type] = rule.actions;
+            m_typeOrder.push_back(rule.alertType);
+        }
+    }
+}
+
+uint32_t AlertRuleTable::getTypeActions(int32_t alertType) const {
+    if (alertType < 0 || static_cast<size_t>(alertType) >= m_typeActions.size()) {
+        return 0;
+    }
+    return m_typeActions[alertType];
+}
+
+std::shared_ptr<AlertRuleTable> AlertRuleTable::compile(const std::string& json,
+    const AlertTypeResolver& resolver, std::string& error) {
+    Json::Value root;
+    Json::CharReaderBuilder reader;
+    std::string errs;
+    std::istringstream stream(json);
+    if (!Json::parseFromStream(reader, stream, &root, &errs)) {
+        error = "json parse error: " + errs;
+        return nullptr;
+    }
+    if (!root.isArray()) {
+        error = "rules must be an array";
+        return nullptr;
+    }
+
+    auto table = std::make_shared<AlertRuleTable>();
+    for (Json::ArrayIndex i = 0; i < root.size(); ++i) {
+        const Json::Value& item = root[i];
+        Rule rule;
+        rule.name = item.get("name", "rule" + std::to_string(i)).asString();
+        const std::string prefix = "rule " + rule.name + ": ";
+
+        if (item.isMember("alert")) {
+            rule.alertType = resolver(item["alert"].asString());
+            if (rule.alertType < 0) {
+                error = prefix + "unknown alert type " + item["alert"].asString();
+                return nullptr;
+            }
+        }
+
+        const Json::Value& when = item["when"];
+        if (!when.isArray() || when.size() > MAX_CONDITIONS) {
+            error = prefix + "when must be an array of at most " + std::to_string(MAX_CONDITIONS) + " conditions";
+            return nullptr;
+        }
+        for (const auto& cond : when) {
+            Condition c;
+            for (const auto& cls : cond["classes"]) {
+                const int32_t index = classFromName(cls.asString());
+                if (index < 0) {
+                    error = prefix + "unknown class " + cls.asString();
+                    return nullptr;
+                }
+                c.classMask |= 1u << index;
+            }
+            if (0 == c.classMask) {
+                error = prefix + "condition without classes";
+                return nullptr;
+            }
+            c.minCount = cond.get("min", 0).asUInt();
+            c.maxCount = cond.isMember("max") ? cond["max"].asUInt() : UINT32_MAX;
+            rule.conditions[rule.conditionCount++] = c;
+        }
+
+        if (item.isMember("occluded")) {
+            rule.occluded = item["occluded"].asBool() ? 1 : 0;
+        }
+        rule.holdMs = item.get("hold_ms", 0).asInt64();
+
+        for (const auto& action : item["actions"]) {
+            const uint32_t bit = actionFromName(action.asString());
+            if (0 == bit) {
+                error = prefix + "unknown action " + action.asString();
+                return nullptr;
+            }
+            rule.actions |= bit;
+        }
+        // 锁屏需要周期触发，与告警判定分开成独立规则
+        if ((rule.alertType < 0) != (0 != (rule.actions & ACTION_LOCK))) {
+            error = prefix + "lock must be a separate rule without alert type";
+            return nullptr;
+        }
+        table->addRule(rule);
+    }
+    return table;
+}
+
+std::shared_ptr<AlertRuleTable> AlertRuleTable::fromSwitches(const Switches& switches,
+    const AlertTypeResolver& resolver) {
+    auto table = std::make_shared<AlertRuleTable>();
+    auto makeRule = [](const char* name, int32_t type, uint32_t mask, uint32_t minCount, uint32_t maxCount) {
+        Rule rule;
+        rule.name = name;
+        rule.alertType = type;
+        rule.conditions[0] = { mask, minCount, maxCount };
+        rule.conditionCount = 1;
+        return rule;
+    };
+    const uint32_t faceMask = 1u << CLASS_FACE;
+    const uint32_t phoneMask = (1u << CLASS_LENS) | (1u << CLASS_PHONE);
+
+    Rule phone = makeRule("phone", resolver("phone"), phoneMask, 1, UINT32_MAX);
+    phone.actions = (switches.phoneAlert ? ACTION_ALERT : 0u) | (switches.phoneScreen ? ACTION_SCREENSHOT : 0u)
+        | (switches.phoneCamera ? ACTION_CAMERA : 0u);
+    table->addRule(phone);
+
+    Rule peep = makeRule("peep", resolver("peep"), faceMask, 2, UINT32_MAX);
+    peep.actions = (switches.peepAlert ? ACTION_ALERT : 0u) | ACTION_CAMERA;
+    table->addRule(peep);
+
+    Rule occlude = makeRule("occlude", resolver("occlude"), faceMask, 0, 0);
+    occlude.occluded = 1;
+    occlude.actions = (switches.occludeAlert ? ACTION_ALERT : 0u) | ACTION_CAMERA;
+    table->addRule(occlude);
+
+    Rule nobody = makeRule("nobody", resolver("nobody"), faceMask, 0, 0);
+    nobody.actions = (switches.nobodyAlert ? ACTION_ALERT : 0u) | ACTION_CAMERA;
+    table->addRule(nobody);
+
+    Rule suspect = makeRule("suspect", resolver("suspect"), 1u << CLASS_SUSPECT, 1, UINT32_MAX);
+    suspect.actions = (switches.suspectAlert ? ACTION_ALERT : 0u) | (switches.suspectScreen ? ACTION_SCREENSHOT : 0u)
+        | (switches.suspectCamera ? ACTION_CAMERA : 0u);
+    table->addRule(suspect);
+
+    if (switches.nobodyLock && (switches.nobodyAlert || switches.occludeAlert)) {
+        Rule lock = makeRule("nobody_lock", -1, faceMask, 0, 0);
+        lock.conditions[1] = { phoneMask, 0, 0 };
+        lock.conditionCount = 2;
+        lock.holdMs = switches.lockTimeoutMs;
+        lock.actions = ACTION_LOCK;
+        table->addRule(lock);
+    }
+    return table;
+}
+
+void AlertRuleEvaluator::reset() {
+    m_table.reset();
+    m_matchSince.clear();
+    m_matching.clear();
+}
+
+AlertRuleEvaluator::Result AlertRuleEvaluator::evaluate(const std::shared_ptr<const AlertRuleTable>& table,
+    const std::array<uint32_t, CLASS_SLOTS>& counts, const std::function<bool()>& occlusionProbe,
+    std::chrono::steady_clock::time_point now) {
+    Result result;
+    if (!table) {
+        return result;
+    }
+    const std::vector<AlertRuleTable::Rule>& rules = table->getRules();
+    if (m_table != table) {
+        m_table = table;
+        m_matchSince.assign(rules.size(), now);
+        m_matching.assign(rules.size(), 0);
+    }
+
+    for (size_t i = 0; i < rules.size(); ++i) {
+        const AlertRuleTable::Rule& rule = rules[i];
+        // 计数条件按位与合并，不做逐项短路
+        bool match = true;
+        for (uint32_t c = 0; c < rule.conditionCount; ++c) {
+            const AlertRuleTable::Condition& cond = rule.conditions[c];
+            uint32_t sum = 0;
+            for (uint32_t k = 0; k < CLASS_SLOTS; ++k) {
+                sum += counts[k] * ((cond.classMask >> k) & 1u);
+            }
+            match &= (sum >= cond.minCount) & (sum <= cond.maxCount);
+        }
+        // 遮挡判定较重：已有更高优先级的告警规则成立时不再为低优先级规则计算
+        if (match && rule.occluded >= 0 && rule.alertType >= 0 && result.ruleIndex >= 0) {
+            match = false;
+        }
+        // 其余情况在计数条件成立时最多计算一次
+        if (match && rule.occluded >= 0) {
+            if (!result.occlusionChecked) {
+                result.occluded = occlusionProbe ? occlusionProbe() : false;
+                result.occlusionChecked = true;
+            }
+            match = (rule.occluded > 0) == result.occluded;
+        }
+
+        if (!match) {
+            m_matching[i] = 0;
+            continue;
+        }
+        if (!m_matching[i]) {
+            m_matching[i] = 1;
+            m_matchSince[i] = now;
+        }
+        if (now - m_matchSince[i] < std::chrono::milliseconds(rule.holdMs)) {
+            continue;
+        }
+
+        if (rule.alertType >= 0) {
+            if (result.ruleIndex < 0) {
+                result.ruleIndex = static_cast<int32_t>(i);
+                result.alertType = rule.alertType;
+                result.actions = rule.actions;
+            }
+        }
+        else {
+            // 独立锁屏规则：触发后重新计时，条件持续时按hold_ms周期触发
+            result.lock = true;
+            m_matchSince[i] = now;
+        }
+    }
+    return result;
+}
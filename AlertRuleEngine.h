@@ -0,0 +1,128 @@
+#ifndef ALERT_RULE_ENGINE_H
+#define ALERT_RULE_ENGINE_H
+
+#include "TemporalVoter.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// 规则可引用的检测类别计数，下标与模型类别一致
+enum AlertClass {
+    CLASS_FACE = 0,
+    CLASS_LENS,
+    CLASS_PHONE,
+    CLASS_SUSPECT,
+    CLASS_SLOTS,
+};
+
+// 规则命中后的动作
+enum AlertAction : uint32_t {
+    ACTION_ALERT = 1u << 0,        // 投递告警(弹窗/计数)
+    ACTION_SCREENSHOT = 1u << 1,   // 屏幕截图证据
+    ACTION_CAMERA = 1u << 2,       // 摄像头画面证据
+    ACTION_LOCK = 1u << 3,         // 锁屏
+};
+
+/**
+ * AlertRuleTable - 编译后的告警规则表(只读，整体替换)
+ * 规则JSON示例：
+ *   {"name": "phone", "alert": "phone", "when": [{"classes": ["lens", "phone"], "min": 1}],
+ *    "occluded": false, "hold_ms": 0, "actions": ["alert", "screenshot", "camera"]}
+ * when内各条件为与关系，每个条件对所列类别计数之和做[min, max]区间判断；
+ * 带alert的规则按顺序取第一条成立的作为本帧判定，不带alert的规则(如锁屏)独立生效
+ */
+class AlertRuleTable {
+public:
+    static constexpr size_t MAX_CONDITIONS = 4;
+
+    struct Condition {
+        uint32_t classMask{ 0 };
+        uint32_t minCount{ 0 };
+        uint32_t maxCount{ UINT32_MAX };
+    };
+
+    struct Rule {
+        std::string name;
+        int32_t alertType{ -1 };     // 告警类型下标，-1为独立规则
+        uint32_t actions{ 0 };
+        uint32_t conditionCount{ 0 };
+        std::array<Condition, MAX_CONDITIONS> conditions{};
+        int8_t occluded{ -1 };       // -1不关心，0未遮挡，1遮挡
+        int64_t holdMs{ 0 };         // 条件需持续的时间
+    };
+
+    using AlertTypeResolver = std::function<int32_t(const std::string&)>;
+
+    // 未配置alert_rules时由各告警开关生成规则
+    struct Switches {
+        bool phoneAlert{ false };
+        bool phoneScreen{ false };
+        bool phoneCamera{ false };
+        bool peepAlert{ false };
+        bool occludeAlert{ false };
+        bool nobodyAlert{ false };
+        bool nobodyLock{ false };
+        bool suspectAlert{ false };
+        bool suspectScreen{ false };
+        bool suspectCamera{ false };
+        int64_t lockTimeoutMs{ 5000 };
+    };
+
+    // 从JSON数组编译，失败返回nullptr并给出原因
+    static std::shared_ptr<AlertRuleTable> compile(const std::string& json,
+        const AlertTypeResolver& resolver, std::string& error);
+    // 按开关生成与原判定顺序一致的规则：镜头/手机 -> 偷窥 -> 遮挡 -> 无人 -> 可疑，无人锁屏为独立规则
+    static std::shared_ptr<AlertRuleTable> fromSwitches(const Switches& switches, const AlertTypeResolver& resolver);
+
+    const std::vector<Rule>& getRules() const { return m_rules; }
+    bool needsOcclusion() const { return m_needsOcclusion; }
+    // 该告警类型第一条规则的动作，投票后的告警类型按此决定是否告警和取哪些证据
+    uint32_t getTypeActions(int32_t alertType) const;
+    // 规则中出现的告警类型，按优先级(首次出现的顺序)
+    const std::vector<int32_t>& getTypeOrder() const { return m_typeOrder; }
+    void addRule(const Rule& rule);
+
+    // 随规则一起整体替换的判定参数，检测线程读取时无需加锁
+    int32_t alertIntervalMs{ 500 };
+    int32_t idleIntervalMs{ 300 };
+    std::vector<TemporalVoter::Rule> voteRules;
+
+private:
+    std::vector<Rule> m_rules;
+    std::vector<uint32_t> m_typeActions;
+    std::vector<uint8_t> m_typeSeen;
+    std::vector<int32_t> m_typeOrder;
+    bool m_needsOcclusion{ false };
+};
+
+/**
+ * AlertRuleEvaluator - 每路摄像头一份的规则求值状态(持续时间计时)
+ * 只在检测线程使用；规则表替换后计时状态自动重置
+ */
+class AlertRuleEvaluator {
+public:
+    struct Result {
+        int32_t ruleIndex{ -1 };     // 本帧判定命中的告警规则
+        int32_t alertType{ -1 };
+        uint32_t actions{ 0 };
+        bool lock{ false };          // 独立规则触发了锁屏
+        bool occlusionChecked{ false };
+        bool occluded{ false };
+    };
+
+    Result evaluate(const std::shared_ptr<const AlertRuleTable>& table, const std::array<uint32_t, CLASS_SLOTS>& counts,
+        const std::function<bool()>& occlusionProbe, std::chrono::steady_clock::time_point now);
+    void reset();
+
+private:
+    std::shared_ptr<const AlertRuleTable> m_table;   // 持有引用，保证按指针判断替换可靠
+    std::vector<std::chrono::steady_clock::time_point> m_matchSince;
+    std::vector<uint8_t> m_matching;
+};
+
+#endif // ALERT_RULE_ENGINE_H
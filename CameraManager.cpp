@@ -0,0 +1,164 @@
+#include "CameraManager.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+ReconnectBackoff::ReconnectBackoff(int32_t initialMs, int32_t maxMs, double jitter)
+    : m_initialMs((std::max)(initialMs, 1)),
+    m_maxMs((std::max)(maxMs, initialMs)),
+    m_jitter((std::min)((std::max)(jitter, 0.0), 1.0)),
+    m_rng(std::random_device{}()) {
+}
+
+std::chrono::milliseconds ReconnectBackoff::nextDelay() {
+    double delay = static_cast<double>(m_initialMs);
+    for (uint32_t i = 0; i < m_attempts && delay < m_maxMs; ++i) {
+        delay *= 2.0;
+    }
+    m_atMax = delay >= m_maxMs;
+    delay = (std::min)(delay, static_cast<double>(m_maxMs));
+    ++m_attempts;
+    std::uniform_real_distribution<double> dist(1.0 - m_jitter, 1.0 + m_jitter);
+    return std::chrono::milliseconds(static_cast<int64_t>(delay * dist(m_rng)));
+}
+
+CameraManager::~CameraManager() {
+    stopHotplugMonitor();
+}
+
+void CameraManager::setEnumerator(Enumerator enumerator) {
+    std::lock_guard<std::mutex> lock(m_cacheMtx);
+    m_enumerator = std::move(enumerator);
+    m_cacheValid = false;
+}
+
+std::vector<CameraDeviceInfo> CameraManager::getDevices() {
+    std::lock_guard<std::mutex> lock(m_cacheMtx);
+    if (!m_cacheValid) {
+        m_devices = m_enumerator ? m_enumerator() : enumerateVideoNodes();
+        m_cacheValid = true;
+        MY_SPDLOG_INFO("camera devices enumerated: {}", m_devices.size());
+        for (const auto& dev : m_devices) {
+            MY_SPDLOG_INFO("  Device {}: {} (uniqueID: {})", dev.index, dev.name, dev.uniqueId);
+        }
+    }
+    return m_devices;
+}
+
+int32_t CameraManager::findDeviceIndex(const std::string& uniqueId) {
+    std::vector<CameraDeviceInfo> devices = getDevices();
+    for (const auto& dev : devices) {
+        if (dev.uniqueId == uniqueId) {
+            return dev.index;
+        }
+    }
+    return -1;
+}
+
+void CameraManager::notifyDeviceChange() {
+    {
+        std::lock_guard<std::mutex> lock(m_cacheMtx);
+        m_cacheValid = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_waitMtx);
+        m_generation.fetch_add(1);
+    }
+    m_waitCond.notify_all();
+    MY_SPDLOG_INFO("camera device change, generation: {}", m_generation.load());
+}
+
+bool CameraManager::waitForDeviceChange(uint64_t seenGeneration, std::chrono::milliseconds timeout,
+    const std::atomic_bool& keepRunning) {
+    std::unique_lock<std::mutex> lock(m_waitMtx);
+    return m_waitCond.wait_for(lock, timeout, [&] {
+        return m_generation.load() != seenGeneration || !keepRunning.load();
+    }) && m_generation.load() != seenGeneration;
+}
+
+void CameraManager::wakeAll() {
+    { std::lock_guard<std::mutex> lock(m_waitMtx); }
+    m_waitCond.notify_all();
+}
+
+std::vector<CameraDeviceInfo> CameraManager::enumerateVideoNodes() {
+    std::vector<CameraDeviceInfo> devices;
+#if defined(__linux__)
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev", ec)) {
+        const std::string name = entry.path().filename().string();
+        if (0 != name.rfind("video", 0) || name.size() <= 5) {
+            continue;
+        }
+        const std::string suffix = name.substr(5);
+        if (!std::all_of(suffix.begin(), suffix.end(), ::isdigit)) {
+            continue;
+        }
+        CameraDeviceInfo info;
+        info.uniqueId = entry.path().string();
+        info.name = name;
+        info.index = std::stoi(suffix);
+        devices.emplace_back(std::move(info));
+    }
+    std::sort(devices.begin(), devices.end(),
+        [](const CameraDeviceInfo& a, const CameraDeviceInfo& b) { return a.index < b.index; });
+#endif
+    return devices;
+}
+
+void CameraManager::startHotplugMonitor() {
+#if defined(__linux__)
+    if (m_hotplugContinue.exchange(true)) {
+        return;
+    }
+    m_hotplugThd = std::thread(&CameraManager::hotplugLoop, this);
+#endif
+}
+
+void CameraManager::stopHotplugMonitor() {
+    m_hotplugContinue.store(false);
+    if (m_hotplugThd.joinable()) {
+        m_hotplugThd.join();
+    }
+}
+
+void CameraManager::hotplugLoop() {
+#if defined(__linux__)
+    MY_SPDLOG_INFO(">>>");
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, "/dev", IN_CREATE | IN_DELETE | IN_ATTRIB) < 0) {
+        MY_SPDLOG_WARN("inotify on /dev unavailable, camera hotplug relies on backoff retry");
+        if (fd >= 0) { close(fd); }
+        return;
+    }
+    alignas(struct inotify_event) char buf[4096];
+    while (m_hotplugContinue.load()) {
+        struct pollfd pfd { fd, POLLIN, 0 };
+        // 超时只用于检查停止标志
+        if (poll(&pfd, 1, 500) <= 0) {
+            continue;
+        }
+        ssize_t len = read(fd, buf, sizeof(buf));
+        bool videoChanged = false;
+        for (ssize_t offset = 0; offset < len;) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>(buf + offset);
+            if (event->len > 0 && 0 == std::string(event->name).rfind("video", 0)) {
+                videoChanged = true;
+            }
+            offset += sizeof(struct inotify_event) + event->len;
+        }
+        if (videoChanged) {
+            notifyDeviceChange();
+        }
+    }
+    close(fd);
+    MY_SPDLOG_INFO("<<<");
+#endif
+}
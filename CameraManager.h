@@ -0,0 +1,102 @@
+#ifndef CAMERA_MANAGER_H
+#define CAMERA_MANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct CameraDeviceInfo {
+    std::string uniqueId;   // macOS为AVCaptureDevice uniqueID，Linux为设备路径
+    std::string name;
+    int32_t index{ 0 };     // cv::VideoCapture设备序号
+};
+
+/**
+ * ReconnectBackoff - 带抖动的指数退避
+ * 每次失败延迟翻倍直到上限，并在[1-jitter, 1+jitter]范围内随机，避免多路摄像头同步重试
+ */
+class ReconnectBackoff {
+public:
+    ReconnectBackoff(int32_t initialMs, int32_t maxMs, double jitter = 0.2);
+
+    std::chrono::milliseconds nextDelay();
+    void reset() { m_attempts = 0; }
+    uint32_t attempts() const { return m_attempts; }
+    bool atMax() const { return m_atMax; }
+
+private:
+    int32_t m_initialMs;
+    int32_t m_maxMs;
+    double m_jitter;
+    uint32_t m_attempts{ 0 };
+    bool m_atMax{ false };
+    std::mt19937 m_rng;
+};
+
+/**
+ * CameraManager - 摄像头设备枚举缓存与插拔通知
+ * 枚举结果缓存到设备发生变化为止；平台层(macOS AVFoundation通知、Linux /dev inotify)
+ * 调用notifyDeviceChange使缓存失效并唤醒等待重连的采集线程，设备重新插上后立即重连
+ */
+class CameraManager {
+public:
+    static CameraManager* getInstance() {
+        static CameraManager instance;
+        return &instance;
+    }
+
+    using Enumerator = std::function<std::vector<CameraDeviceInfo>()>;
+
+    // 平台枚举实现；未设置时Linux下扫描/dev/video*
+    void setEnumerator(Enumerator enumerator);
+
+    // 缓存的设备列表，设备变化后首次调用时重新枚举
+    std::vector<CameraDeviceInfo> getDevices();
+    // 按uniqueID查找设备序号，未找到返回-1
+    int32_t findDeviceIndex(const std::string& uniqueId);
+
+    // 设备插拔：缓存失效，代数加一，唤醒等待者
+    void notifyDeviceChange();
+    uint64_t getDeviceGeneration() const { return m_generation.load(); }
+
+    // 等待设备代数变化，超时或keepRunning为false时返回；设备变化返回true
+    bool waitForDeviceChange(uint64_t seenGeneration, std::chrono::milliseconds timeout,
+        const std::atomic_bool& keepRunning);
+    // 停止时唤醒所有等待者重新检查keepRunning
+    void wakeAll();
+
+    // Linux下启动inotify监听/dev；其他平台由平台层调用notifyDeviceChange
+    void startHotplugMonitor();
+    void stopHotplugMonitor();
+
+private:
+    CameraManager() = default;
+    ~CameraManager();
+    CameraManager(const CameraManager&) = delete;
+    CameraManager& operator=(const CameraManager&) = delete;
+
+    static std::vector<CameraDeviceInfo> enumerateVideoNodes();
+    void hotplugLoop();
+
+private:
+    Enumerator m_enumerator;
+    std::mutex m_cacheMtx;
+    std::vector<CameraDeviceInfo> m_devices;
+    bool m_cacheValid{ false };
+
+    std::atomic<uint64_t> m_generation{ 0 };
+    std::mutex m_waitMtx;
+    std::condition_variable m_waitCond;
+
+    std::thread m_hotplugThd;
+    std::atomic_bool m_hotplugContinue{ false };
+};
+
+#endif // CAMERA_MANAGER_H
@@ -0,0 +1,239 @@
+#include "CaptureSource.h"
+#include "V4l2CaptureSource.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+
+#ifndef HAS_TURBOJPEG
+#define HAS_TURBOJPEG 0
+#endif
+
+#if HAS_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+namespace {
+
+#ifdef __APPLE__
+constexpr int CAMERA_API = cv::CAP_AVFOUNDATION;
+#elif defined(_WIN32)
+constexpr int CAMERA_API = cv::CAP_DSHOW;
+#else
+constexpr int CAMERA_API = cv::CAP_ANY;
+#endif
+
+#if HAS_TURBOJPEG
+// 每个线程一份解码句柄，采集线程与告警线程各自使用
+struct DecoderState {
+    tjhandle tj{ nullptr };
+    DecoderState() { tj = tjInitDecompress(); }
+    ~DecoderState() { if (tj) { tjDestroy(tj); } }
+};
+
+DecoderState& threadDecoderState() {
+    static thread_local DecoderState state;
+    return state;
+}
+#endif
+
+// 按缩放分母解码；无TurboJPEG时由OpenCV的libjpeg以scale_denom解码
+bool decodeJpeg(const uint8_t* data, size_t size, int32_t denom, cv::Mat& out) {
+#if HAS_TURBOJPEG
+    DecoderState& state = threadDecoderState();
+    int width = 0;
+    int height = 0;
+    int subsamp = 0;
+    int colorspace = 0;
+    if (state.tj && 0 == tjDecompressHeader3(state.tj, data, static_cast<unsigned long>(size),
+        &width, &height, &subsamp, &colorspace)) {
+        const tjscalingfactor factor{ 1, denom };
+        out.create(TJSCALED(height, factor), TJSCALED(width, factor), CV_8UC3);
+        if (0 == tjDecompress2(state.tj, data, static_cast<unsigned long>(size), out.data,
+            out.cols, static_cast<int>(out.step), out.rows, TJPF_BGR, TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE)) {
+            return true;
+        }
+        MY_SPDLOG_WARN("tjDecompress2 failed: {}, fallback to imdecode", tjGetErrorStr2(state.tj));
+    }
+#endif
+    int flags = cv::IMREAD_COLOR;
+    switch (denom) {
+    case 2: flags = cv::IMREAD_REDUCED_COLOR_2; break;
+    case 4: flags = cv::IMREAD_REDUCED_COLOR_4; break;
+    case 8: flags = cv::IMREAD_REDUCED_COLOR_8; break;
+    default: break;
+    }
+    cv::Mat raw(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    out = cv::imdecode(raw, flags);
+    return !out.empty();
+}
+
+// 不解码像素，仅读取SOF中的宽高
+bool readJpegSize(const uint8_t* data, size_t size, int32_t& width, int32_t& height) {
+    size_t pos = 2;
+    if (size < 4 || 0xFF != data[0] || 0xD8 != data[1]) {
+        return false;
+    }
+    while (pos + 4 <= size) {
+        if (0xFF != data[pos]) {
+            return false;
+        }
+        const uint8_t marker = data[pos + 1];
+        const size_t segLen = (static_cast<size_t>(data[pos + 2]) << 8) | data[pos + 3];
+        // SOF0-SOF15，排除DHT(C4)、JPG(C8)、DAC(CC)
+        if (marker >= 0xC0 && marker <= 0xCF && 0xC4 != marker && 0xC8 != marker && 0xCC != marker) {
+            if (pos + 9 > size) {
+                return false;
+            }
+            height = (data[pos + 5] << 8) | data[pos + 6];
+            width = (data[pos + 7] << 8) | data[pos + 8];
+            return width > 0 && height > 0;
+        }
+        pos += 2 + segLen;
+    }
+    return false;
+}
+
+} // namespace
+
+std::unique_ptr<CaptureSource> CaptureSource::create(const std::string& backend,
+    int32_t captureWidth, int32_t captureHeight, const std::string& pixelFormat) {
+    if ("mjpeg" == backend) {
+#if defined(__linux__)
+        // 压缩帧经V4L2 mmap缓冲直接交给DCT缩放解码
+        return std::make_unique<V4l2CaptureSource>(captureWidth, captureHeight, "mjpeg");
+#elif defined(__APPLE__)
+        // AVFoundation忽略CAP_PROP_CONVERT_RGB，只会给出解码后的BGR帧
+        MY_SPDLOG_WARN("mjpeg capture backend is not available on AVFoundation, use opencv");
+        return std::make_unique<OpenCvCaptureSource>();
+#else
+        // DirectShow关闭颜色转换后retrieve得到原始JPEG
+        return std::make_unique<MjpegCaptureSource>(captureWidth, captureHeight);
+#endif
+    }
+    if ("v4l2" == backend) {
+#if defined(__linux__)
+        return std::make_unique<V4l2CaptureSource>(captureWidth, captureHeight, pixelFormat);
+#else
+        MY_SPDLOG_WARN("v4l2 capture backend is only available on Linux, use opencv");
+        (void)pixelFormat;
+        return std::make_unique<OpenCvCaptureSource>();
+#endif
+    }
+    if ("opencv" != backend) {
+        MY_SPDLOG_WARN("unknown capture backend: {}, use opencv", backend);
+    }
+    return std::make_unique<OpenCvCaptureSource>();
+}
+
+// ---------------- OpenCvCaptureSource ----------------
+
+bool OpenCvCaptureSource::open(int32_t deviceIndex, int32_t width, int32_t height) {
+    m_cap.reset(new cv::VideoCapture(deviceIndex, CAMERA_API));
+    if (!m_cap->isOpened()) {
+        return false;
+    }
+    m_cap->set(cv::CAP_PROP_FRAME_WIDTH, width);
+    m_cap->set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    return true;
+}
+
+bool OpenCvCaptureSource::retrieve(FrameHandle& frame) {
+    return m_cap && m_cap->retrieve(frame.writable()) && !frame.empty();
+}
+
+cv::Size OpenCvCaptureSource::getFrameSize() const {
+    if (!m_cap) {
+        return cv::Size();
+    }
+    return cv::Size(static_cast<int>(m_cap->get(cv::CAP_PROP_FRAME_WIDTH)),
+        static_cast<int>(m_cap->get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+// ---------------- MjpegCaptureSource ----------------
+
+MjpegCaptureSource::MjpegCaptureSource(int32_t captureWidth, int32_t captureHeight)
+    : m_captureWidth(captureWidth), m_captureHeight(captureHeight) {
+}
+
+bool MjpegCaptureSource::open(int32_t deviceIndex, int32_t width, int32_t height) {
+    m_cap.reset(new cv::VideoCapture(deviceIndex, CAMERA_API));
+    if (!m_cap->isOpened()) {
+        return false;
+    }
+    // FOURCC需在分辨率之前设置，部分驱动按FOURCC决定可选分辨率
+    m_cap->set(cv::CAP_PROP_FOURCC, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'));
+    m_cap->set(cv::CAP_PROP_FRAME_WIDTH, m_captureWidth);
+    m_cap->set(cv::CAP_PROP_FRAME_HEIGHT, m_captureHeight);
+    // 关闭后端的颜色转换，retrieve得到未解码的JPEG数据
+    m_cap->set(cv::CAP_PROP_CONVERT_RGB, 0);
+    m_targetLongSide = (std::max)(width, height);
+    m_frameSize = cv::Size(static_cast<int>(m_cap->get(cv::CAP_PROP_FRAME_WIDTH)),
+        static_cast<int>(m_cap->get(cv::CAP_PROP_FRAME_HEIGHT)));
+    m_rawWarned = false;
+    MY_SPDLOG_INFO("mjpeg capture opened, request {}x{}, real {}x{}, detect long side: {}",
+        m_captureWidth, m_captureHeight, m_frameSize.width, m_frameSize.height, m_targetLongSide);
+    return true;
+}
+
+bool MjpegCaptureSource::decodeForDetect(const uint8_t* data, size_t size, int32_t targetLongSide,
+    cv::Mat& out, cv::Size& fullSize, int32_t& denom) {
+    int32_t jpegWidth = 0;
+    int32_t jpegHeight = 0;
+    if (!readJpegSize(data, size, jpegWidth, jpegHeight)) {
+        return false;
+    }
+    fullSize = cv::Size(jpegWidth, jpegHeight);
+    // 取缩小后长边仍不小于检测尺寸的最大分母，避免检测前再放大
+    const int32_t longSide = (std::max)(jpegWidth, jpegHeight);
+    denom = 1;
+    for (int32_t candidate : { 8, 4, 2 }) {
+        if ((longSide + candidate - 1) / candidate >= targetLongSide) {
+            denom = candidate;
+            break;
+        }
+    }
+    return decodeJpeg(data, size, denom, out);
+}
+
+bool MjpegCaptureSource::decodeScaled(const uint8_t* data, size_t size, cv::Mat& out) {
+    cv::Size fullSize;
+    int32_t denom = 1;
+    const bool ok = decodeForDetect(data, size, m_targetLongSide, out, fullSize, denom);
+    if (fullSize.area() > 0 && (denom != m_scaleDenom || m_frameSize != fullSize)) {
+        MY_SPDLOG_INFO("mjpeg frame {}x{}, decode scale 1/{}", fullSize.width, fullSize.height, denom);
+        m_scaleDenom = denom;
+        m_frameSize = fullSize;
+    }
+    return ok;
+}
+
+bool MjpegCaptureSource::retrieve(FrameHandle& frame) {
+    if (!m_cap || !m_cap->retrieve(m_rawBuf) || m_rawBuf.empty()) {
+        return false;
+    }
+    // 驱动不提供MJPEG而退回未压缩格式时得到的已是解码后的图像，直接使用
+    if (CV_8UC1 != m_rawBuf.type() || (1 != m_rawBuf.rows && 1 != m_rawBuf.cols)) {
+        if (!m_rawWarned) {
+            MY_SPDLOG_WARN("capture backend returns decoded frames, mjpeg scaled decode disabled");
+            m_rawWarned = true;
+        }
+        m_rawBuf.copyTo(frame.writable());
+        return true;
+    }
+
+    const uint8_t* data = m_rawBuf.ptr<uint8_t>();
+    const size_t size = m_rawBuf.total();
+    if (!decodeScaled(data, size, frame.writable())) {
+        MY_SPDLOG_WARN("mjpeg decode failed, size: {}", size);
+        return false;
+    }
+    frame.writableEncoded().assign(data, data + size);
+    return true;
+}
+
+bool MjpegCaptureSource::decodeFull(const std::vector<uint8_t>& jpeg, cv::Mat& out) {
+    if (jpeg.empty()) {
+        return false;
+    }
+    return decodeJpeg(jpeg.data(), jpeg.size(), 1, out);
+}
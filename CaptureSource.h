@@ -0,0 +1,90 @@
+#ifndef CAPTURE_SOURCE_H
+#define CAPTURE_SOURCE_H
+
+#include "FramePool.h"
+
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * CaptureSource - 摄像头采集后端接口
+ * grab只从驱动取出一帧不解码，retrieve把最近grab的帧解码写入帧池缓冲
+ */
+class CaptureSource {
+public:
+    virtual ~CaptureSource() = default;
+
+    // width/height为检测需要的分辨率，后端据此决定采集和解码尺寸
+    virtual bool open(int32_t deviceIndex, int32_t width, int32_t height) = 0;
+    virtual bool isOpened() const = 0;
+    virtual bool grab() = 0;
+    virtual bool retrieve(FrameHandle& frame) = 0;
+    // 摄像头实际输出分辨率(解码缩小前)
+    virtual cv::Size getFrameSize() const = 0;
+    virtual const char* getName() const = 0;
+    // 最近grab帧的驱动采集时间，后端不提供时返回false
+    virtual bool getCaptureTime(std::chrono::steady_clock::time_point& /* captureTime */) const { return false; }
+
+    // backend: "opencv"(默认) / "mjpeg" / "v4l2"(仅Linux)；mjpeg在Linux上由V4L2后端以MJPEG格式采集，
+    // Windows上经DirectShow取原始JPEG，macOS的AVFoundation不输出压缩帧，退回opencv；
+    // captureWidth/captureHeight为mjpeg/v4l2向摄像头请求的分辨率，pixelFormat为v4l2像素格式(mjpeg/yuyv/nv12)
+    static std::unique_ptr<CaptureSource> create(const std::string& backend,
+        int32_t captureWidth, int32_t captureHeight, const std::string& pixelFormat = "mjpeg");
+};
+
+// OpenCV默认路径：由VideoCapture解码为全分辨率BGR
+class OpenCvCaptureSource : public CaptureSource {
+public:
+    bool open(int32_t deviceIndex, int32_t width, int32_t height) override;
+    bool isOpened() const override { return m_cap && m_cap->isOpened(); }
+    bool grab() override { return m_cap && m_cap->grab(); }
+    bool retrieve(FrameHandle& frame) override;
+    cv::Size getFrameSize() const override;
+    const char* getName() const override { return "opencv"; }
+
+private:
+    std::unique_ptr<cv::VideoCapture> m_cap;
+};
+
+/**
+ * MjpegCaptureSource - 请求摄像头输出MJPEG，按DCT缩放(1/2、1/4、1/8)直接解码到检测所需尺寸
+ * 原始JPEG保存在帧缓冲中，只有成为告警证据时才通过decodeFull做一次全分辨率解码。
+ * 依赖VideoCapture在CAP_PROP_CONVERT_RGB=0时交出原始数据，仅用于DirectShow；
+ * 解码函数同时供V4l2CaptureSource使用
+ */
+class MjpegCaptureSource : public CaptureSource {
+public:
+    MjpegCaptureSource(int32_t captureWidth, int32_t captureHeight);
+
+    bool open(int32_t deviceIndex, int32_t width, int32_t height) override;
+    bool isOpened() const override { return m_cap && m_cap->isOpened(); }
+    bool grab() override { return m_cap && m_cap->grab(); }
+    bool retrieve(FrameHandle& frame) override;
+    cv::Size getFrameSize() const override { return m_frameSize; }
+    const char* getName() const override { return "mjpeg"; }
+
+    // 全分辨率解码JPEG为BGR
+    static bool decodeFull(const std::vector<uint8_t>& jpeg, cv::Mat& out);
+    // 取缩小后长边仍不小于targetLongSide的最大DCT缩放解码，返回原始尺寸和所用分母
+    static bool decodeForDetect(const uint8_t* data, size_t size, int32_t targetLongSide,
+        cv::Mat& out, cv::Size& fullSize, int32_t& denom);
+
+private:
+    bool decodeScaled(const uint8_t* data, size_t size, cv::Mat& out);
+
+private:
+    std::unique_ptr<cv::VideoCapture> m_cap;
+    int32_t m_captureWidth;
+    int32_t m_captureHeight;
+    int32_t m_targetLongSide{ 640 };
+    int32_t m_scaleDenom{ 1 };        // 最近一次使用的缩放分母
+    cv::Size m_frameSize;
+    cv::Mat m_rawBuf;                 // retrieve出的压缩数据
+    bool m_rawWarned{ false };
+};
+
+#endif // CAPTURE_SOURCE_H
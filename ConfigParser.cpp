@@ -194,6 +194,13 @@ void ConfigParser::populateMeta(std::shared_ptr<MyMeta> &meta, const Json::Value
             meta->set(key, value.asString());
             MY_SPDLOG_DEBUG("{} set to asString {}", key, value.asString());
         }
+        else if (value.isArray() || value.isObject()) {
+            // 数组/对象(如告警规则)以紧凑JSON字符串保存，由使用方解析
+            Json::StreamWriterBuilder writer;
+            writer["indentation"] = "";
+            meta->set(key, Json::writeString(writer, value));
+            MY_SPDLOG_DEBUG("{} set to json {}", key, meta->getStringOrDefault(key, ""));
+        }
         else {
             throw std::runtime_error("Unsupported JSON type for key: " + key);
         }
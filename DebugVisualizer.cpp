@@ -0,0 +1,244 @@
+#include "DebugVisualizer.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+static constexpr const char* DEBUG_WINDOW_NAME = "debug";
+static constexpr int32_t WINDOW_REFRESH_MS = 30;
+
+DebugVisualizer::~DebugVisualizer() {
+    stop();
+}
+
+void DebugVisualizer::start(const std::string& recordPath, double recordFps) {
+    if (m_running.load()) {
+        return;
+    }
+    m_recordPath = recordPath;
+    m_recordFps = recordFps > 0.0 ? recordFps : 10.0;
+    m_recordFailed = false;
+    m_quitRequested.store(false);
+    m_droppedCnt.store(0);
+    m_running.store(true);
+    m_renderThd = std::thread(&DebugVisualizer::renderWork, this);
+#ifdef __APPLE__
+    // 预览窗口由主队列定时刷新，渲染线程不触碰HighGUI
+    if (m_recordPath.empty() && !m_windowTimer) {
+        m_windowTimer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+        dispatch_source_set_timer(m_windowTimer, DISPATCH_TIME_NOW,
+            WINDOW_REFRESH_MS * NSEC_PER_MSEC, 5 * NSEC_PER_MSEC);
+        dispatch_set_context(m_windowTimer, this);
+        dispatch_source_set_event_handler_f(m_windowTimer, [](void* ctx) {
+            static_cast<DebugVisualizer*>(ctx)->showPending();
+        });
+        dispatch_resume(m_windowTimer);
+    }
+#endif
+    MY_SPDLOG_INFO("debug visualizer started, mode: {}",
+        m_recordPath.empty() ? "window" : m_recordPath);
+}
+
+void DebugVisualizer::stop() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_queueCond.notify_all();
+    if (m_renderThd.joinable()) {
+        m_renderThd.join();
+    }
+#ifdef __APPLE__
+    if (m_windowTimer) {
+        dispatch_source_cancel(m_windowTimer);
+        dispatch_release(m_windowTimer);
+        m_windowTimer = nullptr;
+        // 关闭窗口同样交给主线程
+        dispatch_async_f(dispatch_get_main_queue(), this, [](void* ctx) {
+            static_cast<DebugVisualizer*>(ctx)->showPending();
+        });
+    }
+#endif
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    m_queue.clear();
+    MY_SPDLOG_INFO("debug visualizer stopped, dropped frames: {}", m_droppedCnt.load());
+}
+
+void DebugVisualizer::setClassNames(const std::vector<std::string>& classNames) {
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    m_classNames = classNames;
+}
+
+void DebugVisualizer::submit(const cv::Mat& frame, const std::vector<Detection>& detections,
+    const std::string& info) {
+    if (!m_running.load() || frame.empty()) {
+        return;
+    }
+
+    VisFrame item;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        if (!m_freeList.empty()) {
+            item = std::move(m_freeList.back());
+            m_freeList.pop_back();
+        }
+    }
+    // 复用的缓冲尺寸一致时copyTo不会重新分配
+    frame.copyTo(item.image);
+    item.detections = detections;
+    item.info = info;
+
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        if (m_queue.size() >= QUEUE_CAPACITY) {
+            m_freeList.emplace_back(std::move(m_queue.front()));
+            m_queue.pop_front();
+            ++m_droppedCnt;
+        }
+        m_queue.emplace_back(std::move(item));
+    }
+    m_queueCond.notify_one();
+}
+
+void DebugVisualizer::renderWork() {
+    MY_SPDLOG_DEBUG(">>>");
+    while (m_running.load()) {
+        VisFrame item;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMtx);
+            m_queueCond.wait_for(lock, std::chrono::milliseconds(30), [this] {
+                return !m_queue.empty() || !m_running.load();
+            });
+            if (!m_running.load()) break;
+            if (m_queue.empty()) {
+                continue;
+            }
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        drawFrame(item);
+        if (m_recordPath.empty()) {
+            publishWindowFrame(item.image);
+        }
+        else {
+            recordFrame(item.image);
+        }
+
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        m_freeList.emplace_back(std::move(item));
+    }
+
+    if (m_writer.isOpened()) {
+        m_writer.release();
+    }
+    MY_SPDLOG_DEBUG("<<<");
+}
+
+void DebugVisualizer::drawFrame(VisFrame& item) {
+    const std::vector<cv::Scalar> colors = {
+        {0, 255, 0}, {0, 165, 255}, {255, 0, 0},
+        {0, 255, 255}, {255, 0, 255}
+    };
+
+    std::vector<std::string> classNames;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        classNames = m_classNames;
+    }
+
+    cv::Mat& frame = item.image;
+    for (const auto& det : item.detections) {
+        if (det.box.area() <= 0) continue;  // 跳过无效框
+
+        cv::Scalar color = colors[det.class_id % colors.size()];
+        cv::rectangle(frame, det.box, color, 2);
+
+        // 构建标签
+        std::string label = (det.class_id >= 0 && det.class_id < static_cast<int>(classNames.size())) ?
+            classNames[det.class_id] :
+            "Class " + std::to_string(det.class_id);
+        label += cv::format(" %.2f", det.conf);
+
+        // 计算文本位置，保证文本在图像内
+        int baseline = 0;
+        cv::Size text_size = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.6, 1, &baseline);
+        cv::Point text_origin(det.box.x, det.box.y - 5);
+        if (text_origin.y < 10) text_origin.y = det.box.y + 20;
+
+        // 绘制文本背景和文本
+        cv::rectangle(frame,
+            cv::Rect(text_origin.x, text_origin.y - text_size.height,
+                text_size.width, text_size.height + 5),
+            color, cv::FILLED);
+        cv::putText(frame, label,
+            cv::Point(text_origin.x, text_origin.y),
+            cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 255), 1);
+    }
+
+    if (!item.info.empty()) {
+        cv::putText(frame, item.info, cv::Point(10, 30),
+            cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
+    }
+}
+
+void DebugVisualizer::publishWindowFrame(cv::Mat& image) {
+    // 与待显示帧交换，主线程来不及显示的旧帧直接被覆盖
+    std::lock_guard<std::mutex> lock(m_windowMtx);
+    std::swap(m_pendingFrame, image);
+    m_framePending = true;
+}
+
+void DebugVisualizer::showPending() {
+    if (!m_running.load()) {
+        if (m_windowOpen) {
+            cv::destroyAllWindows();
+            m_windowOpen = false;
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_windowMtx);
+        if (m_framePending) {
+            std::swap(m_windowFrame, m_pendingFrame);
+            m_framePending = false;
+        }
+        else if (!m_windowOpen) {
+            return;
+        }
+    }
+    if (!m_windowFrame.empty()) {
+        cv::imshow(DEBUG_WINDOW_NAME, m_windowFrame);
+        m_windowOpen = true;
+    }
+    if (cv::waitKey(1) >= 0) {
+        m_quitRequested.store(true);
+    }
+}
+
+void DebugVisualizer::pumpWindow(int32_t durationMs) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(durationMs);
+    while (std::chrono::steady_clock::now() < deadline) {
+        showPending();
+        const auto remain = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+        std::this_thread::sleep_for((std::min)(remain, std::chrono::milliseconds(WINDOW_REFRESH_MS)));
+    }
+}
+
+void DebugVisualizer::recordFrame(const cv::Mat& image) {
+    if (m_recordFailed) {
+        return;
+    }
+    if (!m_writer.isOpened()) {
+        int fourcc = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+        if (!m_writer.open(m_recordPath, fourcc, m_recordFps, image.size(), true)) {
+            MY_SPDLOG_ERROR("open debug record file {} failed", m_recordPath);
+            m_recordFailed = true;  // 无界面环境下不回退到窗口模式
+            return;
+        }
+        MY_SPDLOG_INFO("debug record to {} ({}x{} @ {} fps)", m_recordPath,
+            image.cols, image.rows, m_recordFps);
+    }
+    m_writer.write(image);
+}
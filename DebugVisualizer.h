@@ -0,0 +1,97 @@
+#ifndef DEBUG_VISUALIZER_H
+#define DEBUG_VISUALIZER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Detection.h"
+
+#ifdef __APPLE__
+#include <dispatch/dispatch.h>
+#endif
+
+/**
+ * DebugVisualizer - 调试可视化输出
+ * 检测线程只负责把帧和检测结果投递到丢弃最旧帧的队列，
+ * 绘制(rectangle/putText)与MJPEG录制在独立的渲染线程完成，保证开启预览与否检测耗时一致。
+ * HighGUI窗口只能在主线程操作(macOS强制要求)，渲染线程只准备好最新一帧，
+ * 由主线程通过showPending/pumpWindow显示；macOS上start时自动在主队列注册定时器
+ */
+class DebugVisualizer {
+public:
+    static DebugVisualizer* getInstance() {
+        static DebugVisualizer instance;
+        return &instance;
+    }
+
+    // recordPath为空时弹窗预览，否则无界面写入MJPEG AVI文件
+    void start(const std::string& recordPath = "", double recordFps = 10.0);
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    void setClassNames(const std::vector<std::string>& classNames);
+    // 投递一帧，队列满时丢弃最旧的帧，不阻塞检测线程
+    void submit(const cv::Mat& frame, const std::vector<Detection>& detections,
+        const std::string& info = "");
+    // 以下只能在主线程调用：显示渲染线程准备好的最新一帧并处理窗口事件
+    void showPending();
+    // 在durationMs内持续显示，供没有事件循环的主线程使用；未开启预览窗口时直接休眠
+    void pumpWindow(int32_t durationMs);
+    // 预览窗口中按下任意键
+    bool isQuitRequested() const { return m_quitRequested.load(); }
+    uint64_t getDroppedCount() const { return m_droppedCnt.load(); }
+
+private:
+    struct VisFrame {
+        cv::Mat image;
+        std::vector<Detection> detections;
+        std::string info;
+    };
+
+    DebugVisualizer() = default;
+    ~DebugVisualizer();
+    DebugVisualizer(const DebugVisualizer&) = delete;
+    DebugVisualizer& operator=(const DebugVisualizer&) = delete;
+
+    void renderWork();
+    void drawFrame(VisFrame& item);
+    void recordFrame(const cv::Mat& image);
+    void publishWindowFrame(cv::Mat& image);
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 2;
+
+    std::atomic_bool m_running{ false };
+    std::atomic_bool m_quitRequested{ false };
+    std::atomic<uint64_t> m_droppedCnt{ 0 };
+    std::thread m_renderThd;
+    std::mutex m_queueMtx;
+    std::condition_variable m_queueCond;
+    std::deque<VisFrame> m_queue;
+    std::vector<VisFrame> m_freeList;   // 复用帧缓冲，避免每帧分配
+    std::vector<std::string> m_classNames;
+
+    std::string m_recordPath{ "" };
+    double m_recordFps{ 10.0 };
+    bool m_recordFailed{ false };
+    cv::VideoWriter m_writer;
+
+    // 渲染线程交给主线程显示的帧，两者交换缓冲不拷贝
+    std::mutex m_windowMtx;
+    cv::Mat m_pendingFrame;
+    bool m_framePending{ false };
+    cv::Mat m_windowFrame;           // 仅主线程访问
+    bool m_windowOpen{ false };      // 仅主线程访问
+#ifdef __APPLE__
+    dispatch_source_t m_windowTimer{ nullptr };
+#endif
+};
+
+#endif // DEBUG_VISUALIZER_H
@@ -0,0 +1,84 @@
+#include "DetectScheduler.h"
+
+#include <algorithm>
+
+void DetectScheduler::reset() {
+    m_interrupted.store(false);
+    m_lastTick = Clock::now();
+    m_started = true;
+    std::lock_guard<std::mutex> lock(m_statsMtx);
+    m_ticks = 0;
+    m_overruns = 0;
+    m_skippedTicks = 0;
+    m_jitterSumUs = 0.0;
+    m_jitterMaxUs = 0.0;
+    m_jitterCnt = 0;
+}
+
+bool DetectScheduler::waitNext(std::chrono::milliseconds period) {
+    if (!m_started) {
+        reset();
+    }
+    if (period.count() <= 0) {
+        period = std::chrono::milliseconds(1);
+    }
+
+    Clock::time_point deadline = m_lastTick + period;
+    const Clock::time_point now = Clock::now();
+    uint64_t skipped = 0;
+    bool overrun = false;
+    if (now > deadline) {
+        // 处理耗时超出周期：跳过错过的节拍，对齐到下一个节拍点
+        overrun = true;
+        skipped = static_cast<uint64_t>((now - deadline) / period) + 1;
+        deadline += period * static_cast<int64_t>(skipped);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock(m_waitMtx);
+        m_waitCond.wait_until(lock, deadline, [this] { return m_interrupted.load(); });
+    }
+    if (m_interrupted.load()) {
+        return false;
+    }
+
+    const double jitterUs = std::chrono::duration<double, std::micro>(Clock::now() - deadline).count();
+    m_lastTick = deadline;
+
+    std::lock_guard<std::mutex> lock(m_statsMtx);
+    ++m_ticks;
+    if (overrun) {
+        ++m_overruns;
+        m_skippedTicks += skipped;
+    }
+    m_jitterSumUs += jitterUs;
+    m_jitterMaxUs = (std::max)(m_jitterMaxUs, jitterUs);
+    ++m_jitterCnt;
+    return true;
+}
+
+void DetectScheduler::interrupt() {
+    m_interrupted.store(true);
+    { std::lock_guard<std::mutex> lock(m_waitMtx); }
+    m_waitCond.notify_all();
+}
+
+DetectScheduler::Stats DetectScheduler::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMtx);
+    Stats stats;
+    stats.ticks = m_ticks;
+    stats.overruns = m_overruns;
+    stats.skippedTicks = m_skippedTicks;
+    stats.jitterAvgUs = m_jitterCnt ? m_jitterSumUs / m_jitterCnt : 0.0;
+    stats.jitterMaxUs = m_jitterMaxUs;
+    return stats;
+}
+
+DetectScheduler::Stats DetectScheduler::takeStats() {
+    Stats stats = getStats();
+    std::lock_guard<std::mutex> lock(m_statsMtx);
+    m_jitterSumUs = 0.0;
+    m_jitterMaxUs = 0.0;
+    m_jitterCnt = 0;
+    return stats;
+}
@@ -0,0 +1,55 @@
+#ifndef DETECT_SCHEDULER_H
+#define DETECT_SCHEDULER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * DetectScheduler - 基于steady_clock绝对截止时间的检测节拍调度
+ * 节拍点按 上一节拍 + 周期 推进，处理耗时不会累加到周期上；
+ * 处理超时(overrun)时跳过已错过的节拍，对齐到下一个节拍点，而不是连续补跑积累延迟。
+ * 等待可被interrupt()立即唤醒，用于停止线程
+ */
+class DetectScheduler {
+public:
+    struct Stats {
+        uint64_t ticks{ 0 };          // 已触发节拍数
+        uint64_t overruns{ 0 };       // 处理耗时超过周期的次数
+        uint64_t skippedTicks{ 0 };   // 因overrun跳过的节拍数
+        double jitterAvgUs{ 0.0 };    // 实际唤醒时刻相对截止时间的平均偏差
+        double jitterMaxUs{ 0.0 };
+    };
+
+    // 以当前时刻作为第一个节拍点
+    void reset();
+    // 等待下一个节拍，period可随告警状态变化；被中断返回false
+    bool waitNext(std::chrono::milliseconds period);
+    void interrupt();
+
+    Stats getStats() const;
+    // 取出自上次调用以来的统计并清零jitter(计数累计保留)
+    Stats takeStats();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point m_lastTick;
+    bool m_started{ false };
+
+    std::atomic_bool m_interrupted{ false };
+    std::mutex m_waitMtx;
+    std::condition_variable m_waitCond;
+
+    mutable std::mutex m_statsMtx;
+    uint64_t m_ticks{ 0 };
+    uint64_t m_overruns{ 0 };
+    uint64_t m_skippedTicks{ 0 };
+    double m_jitterSumUs{ 0.0 };
+    double m_jitterMaxUs{ 0.0 };
+    uint64_t m_jitterCnt{ 0 };
+};
+
+#endif // DETECT_SCHEDULER_H
@@ -0,0 +1,13 @@
+#ifndef DETECTION_H
+#define DETECTION_H
+
+#include <opencv2/opencv.hpp>
+
+// 检测结果结构体
+struct Detection {
+    cv::Rect box;       // 边界框
+    float conf;         // 置信度
+    int class_id;       // 类别ID
+};
+
+#endif // DETECTION_H
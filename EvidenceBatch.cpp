@@ -0,0 +1,367 @@
+#include "EvidenceBatch.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+constexpr char BATCH_MAGIC[4] = { 'P', 'A', 'E', 'B' };
+constexpr char TRAILER_MAGIC[4] = { 'P', 'A', 'E', 'E' };
+constexpr size_t BATCH_HEADER_SIZE = 20;
+constexpr size_t RECORD_HEADER_SIZE = 24;
+constexpr size_t TRAILER_SIZE = 12;
+constexpr size_t MAX_PACKET_NAME_LEN = 4096;
+
+std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+void putU16(std::string& out, uint16_t v) {
+    out.push_back(static_cast<char>(v >> 8));
+    out.push_back(static_cast<char>(v));
+}
+
+void putU32(std::string& out, uint32_t v) {
+    putU16(out, static_cast<uint16_t>(v >> 16));
+    putU16(out, static_cast<uint16_t>(v));
+}
+
+void putU64(std::string& out, uint64_t v) {
+    putU32(out, static_cast<uint32_t>(v >> 32));
+    putU32(out, static_cast<uint32_t>(v));
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(getU16(p)) << 16) | getU16(p + 2);
+}
+
+uint64_t getU64(const uint8_t* p) {
+    return (static_cast<uint64_t>(getU32(p)) << 32) | getU32(p + 4);
+}
+
+} // namespace
+
+uint32_t EvidenceBatch::crc32(uint32_t crc, const void* data, size_t len) {
+    static const std::array<uint32_t, 256> table = makeCrcTable();
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+bool EvidenceBatch::parsePacketSuspected(const uint8_t* packet, size_t size, bool& suspected) {
+    if (size < 5) {
+        return false;
+    }
+    const uint32_t nameLen = getU32(packet);
+    if (nameLen > MAX_PACKET_NAME_LEN || 4 + static_cast<size_t>(nameLen) >= size) {
+        return false;
+    }
+    suspected = 0 != packet[4 + nameLen];
+    return true;
+}
+
+bool EvidenceBatch::decode(const uint8_t* data, size_t size, std::vector<DecodedEvidenceRecord>& records,
+    std::string& error) {
+    records.clear();
+    if (size < BATCH_HEADER_SIZE + TRAILER_SIZE || 0 != std::memcmp(data, BATCH_MAGIC, 4)) {
+        error = "bad batch magic";
+        return false;
+    }
+    const uint16_t version = getU16(data + 4);
+    const uint16_t headerSize = getU16(data + 6);
+    const uint32_t count = getU32(data + 8);
+    if (0 == version || version > EVIDENCE_BATCH_VERSION) {
+        error = "unsupported batch version " + std::to_string(version);
+        return false;
+    }
+    if (headerSize < BATCH_HEADER_SIZE || headerSize > size - TRAILER_SIZE) {
+        error = "bad batch header size";
+        return false;
+    }
+    // 每条记录至少RECORD_HEADER_SIZE+4字节，数量明显不符时提前拒绝
+    if (count > (size - headerSize) / (RECORD_HEADER_SIZE + 4)) {
+        error = "record count exceeds batch size";
+        return false;
+    }
+    records.reserve(count);
+
+    size_t pos = headerSize;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (size - pos < RECORD_HEADER_SIZE) {
+            error = "truncated record header " + std::to_string(i);
+            return false;
+        }
+        const uint8_t* head = data + pos;
+        const uint16_t recordHeaderSize = getU16(head);
+        const uint32_t nameLen = getU32(head + 4);
+        const uint32_t payloadLen = getU32(head + 8);
+        if (recordHeaderSize < RECORD_HEADER_SIZE || recordHeaderSize > size - pos) {
+            error = "bad record header size " + std::to_string(i);
+            return false;
+        }
+        const size_t bodyPos = pos + recordHeaderSize;
+        const uint64_t bodyLen = static_cast<uint64_t>(nameLen) + payloadLen;
+        if (size - bodyPos < bodyLen + 4) {
+            error = "truncated record " + std::to_string(i);
+            return false;
+        }
+        const uint32_t crc = crc32(0, data + bodyPos, static_cast<size_t>(bodyLen));
+        if (crc != getU32(data + bodyPos + bodyLen)) {
+            error = "record checksum mismatch " + std::to_string(i);
+            return false;
+        }
+
+        DecodedEvidenceRecord record;
+        record.flags = getU16(head + 2);
+        record.timestampMs = static_cast<int64_t>(getU64(head + 12));
+        record.priority = head[20];
+        record.attempts = head[21];
+        record.name.assign(reinterpret_cast<const char*>(data + bodyPos), nameLen);
+        record.payload.assign(data + bodyPos + nameLen, data + bodyPos + bodyLen);
+        records.emplace_back(std::move(record));
+        pos = bodyPos + static_cast<size_t>(bodyLen) + 4;
+    }
+
+    if (size - pos != TRAILER_SIZE || 0 != std::memcmp(data + pos, TRAILER_MAGIC, 4)) {
+        error = "bad batch trailer";
+        return false;
+    }
+    if (getU32(data + pos + 4) != count) {
+        error = "trailer record count mismatch";
+        return false;
+    }
+    if (crc32(0, data, pos) != getU32(data + pos + 8)) {
+        error = "batch checksum mismatch";
+        return false;
+    }
+    return true;
+}
+
+EvidenceBatchWriter::~EvidenceBatchWriter() {
+    if (m_file) {
+        fclose(m_file);
+    }
+}
+
+bool EvidenceBatchWriter::prepare(std::vector<EvidenceRecord> records, int64_t createdMs) {
+    m_records = std::move(records);
+    m_createdMs = createdMs;
+    m_totalSize = BATCH_HEADER_SIZE + TRAILER_SIZE;
+    for (auto& record : m_records) {
+        bool suspected = false;
+        if (record.data) {
+            record.size = record.data->size();
+            if (EvidenceBatch::parsePacketSuspected(record.data->data(), record.data->size(), suspected) && suspected) {
+                record.flags |= EVIDENCE_FLAG_SUSPECTED;
+            }
+        }
+        else if (record.view) {
+            if (EvidenceBatch::parsePacketSuspected(record.view, static_cast<size_t>(record.size), suspected) && suspected) {
+                record.flags |= EVIDENCE_FLAG_SUSPECTED;
+            }
+            record.flags |= EVIDENCE_FLAG_FROM_DISK;
+        }
+        else {
+            std::error_code ec;
+            record.size = std::filesystem::file_size(record.filePath, ec);
+            if (ec) {
+                MY_SPDLOG_ERROR("stat evidence file {} failed: {}", record.filePath.string(), ec.message());
+                return false;
+            }
+            // 只读报文头取疑似标志，报文本身在发送时再读
+            std::ifstream in(record.filePath, std::ios::binary);
+            std::vector<uint8_t> head(4);
+            if (in.read(reinterpret_cast<char*>(head.data()), head.size())) {
+                const uint32_t nameLen = getU32(head.data());
+                if (nameLen <= MAX_PACKET_NAME_LEN) {
+                    head.resize(4 + nameLen + 1);
+                    in.read(reinterpret_cast<char*>(head.data() + 4), nameLen + 1);
+                    if (in && EvidenceBatch::parsePacketSuspected(head.data(), head.size(), suspected) && suspected) {
+                        record.flags |= EVIDENCE_FLAG_SUSPECTED;
+                    }
+                }
+            }
+            record.flags |= EVIDENCE_FLAG_FROM_DISK;
+        }
+        if (record.size > UINT32_MAX || record.name.size() > UINT32_MAX) {
+            MY_SPDLOG_ERROR("evidence record {} too large: {} bytes", record.name, record.size);
+            return false;
+        }
+        m_totalSize += RECORD_HEADER_SIZE + record.name.size() + record.size + 4;
+    }
+    rewind();
+    return true;
+}
+
+void EvidenceBatchWriter::rewind() {
+    if (m_file) {
+        fclose(m_file);
+        m_file = nullptr;
+    }
+    m_recordIndex = 0;
+    m_payloadOffset = 0;
+    m_recordCrc = 0;
+    m_batchCrc = 0;
+    m_failed = false;
+
+    std::string header(BATCH_MAGIC, sizeof(BATCH_MAGIC));
+    putU16(header, EVIDENCE_BATCH_VERSION);
+    putU16(header, static_cast<uint16_t>(BATCH_HEADER_SIZE));
+    putU32(header, static_cast<uint32_t>(m_records.size()));
+    putU64(header, static_cast<uint64_t>(m_createdMs));
+    setPending(std::move(header), true);
+    m_stage = Stage::Header;
+}
+
+void EvidenceBatchWriter::setPending(std::string bytes, bool inBatchCrc) {
+    if (inBatchCrc) {
+        m_batchCrc = EvidenceBatch::crc32(m_batchCrc, bytes.data(), bytes.size());
+    }
+    m_pending = std::move(bytes);
+    m_pendingOffset = 0;
+}
+
+void EvidenceBatchWriter::advance() {
+    auto beginRecordOrTrailer = [this]() {
+        if (m_recordIndex < m_records.size()) {
+            const EvidenceRecord& record = m_records[m_recordIndex];
+            std::string head;
+            head.reserve(RECORD_HEADER_SIZE + record.name.size());
+            putU16(head, static_cast<uint16_t>(RECORD_HEADER_SIZE));
+            putU16(head, record.flags);
+            putU32(head, static_cast<uint32_t>(record.name.size()));
+            putU32(head, static_cast<uint32_t>(record.size));
+            putU64(head, static_cast<uint64_t>(record.timestampMs));
+            head.push_back(static_cast<char>(record.priority));
+            head.push_back(static_cast<char>(record.attempts));
+            putU16(head, 0);
+            head += record.name;
+            m_recordCrc = EvidenceBatch::crc32(0, record.name.data(), record.name.size());
+            setPending(std::move(head), true);
+            m_stage = Stage::RecordHead;
+            return;
+        }
+        std::string trailer(TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+        putU32(trailer, static_cast<uint32_t>(m_records.size()));
+        putU32(trailer, m_batchCrc);
+        setPending(std::move(trailer), false);
+        m_stage = Stage::Trailer;
+    };
+
+    switch (m_stage) {
+    case Stage::Header:
+        beginRecordOrTrailer();
+        break;
+    case Stage::RecordHead: {
+        const EvidenceRecord& record = m_records[m_recordIndex];
+        if (!record.data && !record.view) {
+            m_file = fopen(record.filePath.string().c_str(), "rb");
+            if (!m_file) {
+                MY_SPDLOG_ERROR("open evidence file {} failed", record.filePath.string());
+                m_failed = true;
+                return;
+            }
+        }
+        m_payloadOffset = 0;
+        m_stage = Stage::Payload;
+        break;
+    }
+    case Stage::Payload: {
+        if (m_file) {
+            fclose(m_file);
+            m_file = nullptr;
+        }
+        std::string crc;
+        putU32(crc, m_recordCrc);
+        setPending(std::move(crc), true);
+        m_stage = Stage::RecordCrc;
+        break;
+    }
+    case Stage::RecordCrc:
+        ++m_recordIndex;
+        beginRecordOrTrailer();
+        break;
+    case Stage::Trailer:
+    case Stage::Done:
+        m_stage = Stage::Done;
+        break;
+    }
+}
+
+size_t EvidenceBatchWriter::read(char* buf, size_t len) {
+    size_t written = 0;
+    while (written < len && Stage::Done != m_stage && !m_failed) {
+        if (Stage::Payload == m_stage) {
+            const EvidenceRecord& record = m_records[m_recordIndex];
+            const uint64_t remain = record.size - m_payloadOffset;
+            if (0 == remain) {
+                advance();
+                continue;
+            }
+            size_t n = static_cast<size_t>((std::min)(static_cast<uint64_t>(len - written), remain));
+            if (record.data) {
+                std::memcpy(buf + written, record.data->data() + m_payloadOffset, n);
+            }
+            else if (record.view) {
+                std::memcpy(buf + written, record.view + m_payloadOffset, n);
+            }
+            else {
+                n = fread(buf + written, 1, n, m_file);
+                if (0 == n) {
+                    // 文件在prepare之后被截断或删除
+                    MY_SPDLOG_ERROR("read evidence file {} failed", record.filePath.string());
+                    m_failed = true;
+                    break;
+                }
+            }
+            m_recordCrc = EvidenceBatch::crc32(m_recordCrc, buf + written, n);
+            m_batchCrc = EvidenceBatch::crc32(m_batchCrc, buf + written, n);
+            m_payloadOffset += n;
+            written += n;
+            continue;
+        }
+        if (m_pendingOffset < m_pending.size()) {
+            const size_t n = (std::min)(len - written, m_pending.size() - m_pendingOffset);
+            std::memcpy(buf + written, m_pending.data() + m_pendingOffset, n);
+            m_pendingOffset += n;
+            written += n;
+            continue;
+        }
+        advance();
+    }
+    return written;
+}
+
+bool EvidenceBatchWriter::encode(std::vector<uint8_t>& out) {
+    rewind();
+    out.resize(static_cast<size_t>(m_totalSize));
+    size_t offset = 0;
+    while (offset < out.size()) {
+        const size_t n = read(reinterpret_cast<char*>(out.data()) + offset, out.size() - offset);
+        if (0 == n) {
+            break;
+        }
+        offset += n;
+    }
+    const bool ok = !m_failed && offset == out.size();
+    rewind();
+    return ok;
+}
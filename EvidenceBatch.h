@@ -0,0 +1,105 @@
+#ifndef EVIDENCE_BATCH_H
+#define EVIDENCE_BATCH_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * 批量证据容器格式 v1，整数均为网络字节序:
+ *   批头 : "PAEB" | u16 version | u16 headerSize | u32 recordCount | u64 createdMs
+ *   记录 : u16 recordHeaderSize | u16 flags | u32 nameLen | u32 payloadLen | u64 timestampMs
+ *          | u8 priority | u8 attempts | u16 reserved | name | payload | u32 crc32(name + payload)
+ *   批尾 : "PAEE" | u32 recordCount | u32 crc32(批头到最后一条记录)
+ * payload为单条上传的原有报文(长度 + base64路径 + 疑似标志 + JPEG)，服务端可复用单条解析。
+ * headerSize/recordHeaderSize大于已知长度时解码方跳过多出的字段，便于后续版本追加元数据
+ */
+constexpr uint16_t EVIDENCE_BATCH_VERSION = 1;
+constexpr uint16_t EVIDENCE_FLAG_SUSPECTED = 0x0001;
+constexpr uint16_t EVIDENCE_FLAG_FROM_DISK = 0x0002;     // 证据曾落盘(离线积压或重启恢复)
+
+struct EvidenceRecord {
+    std::string name;
+    uint16_t flags{ 0 };
+    uint8_t priority{ 0 };
+    uint8_t attempts{ 0 };
+    int64_t timestampMs{ 0 };                            // 证据产生时间，0表示未知
+    std::shared_ptr<const std::vector<uint8_t>> data;   // 内存中的报文
+    const uint8_t* view{ nullptr };                      // data为空时指向映射内存中的报文，长度由调用方填入size
+    std::shared_ptr<const void> viewOwner;               // 持有view所在的映射
+    std::filesystem::path filePath;                      // data和view都为空时从落盘文件读取
+    uint64_t size{ 0 };                                  // 报文长度，由prepare填写
+};
+
+struct DecodedEvidenceRecord {
+    std::string name;
+    uint16_t flags{ 0 };
+    uint8_t priority{ 0 };
+    uint8_t attempts{ 0 };
+    int64_t timestampMs{ 0 };
+    std::vector<uint8_t> payload;
+};
+
+class EvidenceBatch {
+public:
+    // 与zlib crc32兼容，crc传0开始
+    static uint32_t crc32(uint32_t crc, const void* data, size_t len);
+    // 解码并校验整个批次，失败时error给出原因
+    static bool decode(const uint8_t* data, size_t size, std::vector<DecodedEvidenceRecord>& records,
+        std::string& error);
+    // 从单条报文头读取疑似标志
+    static bool parsePacketSuspected(const uint8_t* packet, size_t size, bool& suspected);
+};
+
+/**
+ * EvidenceBatchWriter - 按批量格式流式生成请求体
+ * 内存和映射中的报文直接拷贝，落盘文件中的报文边读边发送，整个批次不需要在内存中拼接；
+ * 总长度在prepare时算出，用作Content-Length。read按顺序调用，供curl READFUNCTION使用
+ */
+class EvidenceBatchWriter {
+public:
+    EvidenceBatchWriter() = default;
+    ~EvidenceBatchWriter();
+
+    // 计算各记录长度并从报文头解析标志，落盘文件不可读时返回false
+    bool prepare(std::vector<EvidenceRecord> records, int64_t createdMs);
+    uint64_t totalSize() const { return m_totalSize; }
+    size_t recordCount() const { return m_records.size(); }
+    const std::vector<EvidenceRecord>& records() const { return m_records; }
+
+    // 返回写入字节数，0表示结束；文件读取失败时failed()为true
+    size_t read(char* buf, size_t len);
+    bool failed() const { return m_failed; }
+    // 回到开头重新生成
+    void rewind();
+    // 一次性编码到内存
+    bool encode(std::vector<uint8_t>& out);
+
+private:
+    EvidenceBatchWriter(const EvidenceBatchWriter&) = delete;
+    EvidenceBatchWriter& operator=(const EvidenceBatchWriter&) = delete;
+
+    enum class Stage { Header, RecordHead, Payload, RecordCrc, Trailer, Done };
+    // 当前定长片段发送完后进入下一阶段
+    void advance();
+    void setPending(std::string bytes, bool inBatchCrc);
+
+    std::vector<EvidenceRecord> m_records;
+    int64_t m_createdMs{ 0 };
+    uint64_t m_totalSize{ 0 };
+
+    Stage m_stage{ Stage::Header };
+    size_t m_recordIndex{ 0 };
+    std::string m_pending;
+    size_t m_pendingOffset{ 0 };
+    uint64_t m_payloadOffset{ 0 };
+    FILE* m_file{ nullptr };
+    uint32_t m_recordCrc{ 0 };
+    uint32_t m_batchCrc{ 0 };
+    bool m_failed{ false };
+};
+
+#endif // EVIDENCE_BATCH_H
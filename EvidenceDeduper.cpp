@@ -0,0 +1,82 @@
+#include "EvidenceDeduper.h"
+
+#include <bitset>
+
+uint64_t EvidenceDeduper::dHash(const cv::Mat& image) {
+    if (image.empty()) {
+        return 0;
+    }
+    // 先缩小再转灰度，大图上只做一次面积平均
+    cv::Mat small, gray;
+    cv::resize(image, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+    if (small.channels() == 1) {
+        gray = small;
+    }
+    else {
+        cv::cvtColor(small, gray, small.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    }
+
+    uint64_t hash = 0;
+    for (int y = 0; y < 8; ++y) {
+        const uint8_t* row = gray.ptr<uint8_t>(y);
+        for (int x = 0; x < 8; ++x) {
+            hash = (hash << 1) | (row[x] > row[x + 1] ? 1u : 0u);
+        }
+    }
+    return hash;
+}
+
+int32_t EvidenceDeduper::hammingDistance(uint64_t a, uint64_t b) {
+    return static_cast<int32_t>(std::bitset<64>(a ^ b).count());
+}
+
+void EvidenceDeduper::setParams(const Params& params) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_params = params;
+    if (!m_params.enable) {
+        m_history.clear();
+    }
+}
+
+EvidenceDeduper::Params EvidenceDeduper::getParams() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_params;
+}
+
+bool EvidenceDeduper::shouldKeep(const std::string& key, const cv::Mat& image, int64_t nowMs) {
+    Params params = getParams();
+    if (!params.enable || params.hammingThreshold < 0 || image.empty()) {
+        return true;
+    }
+    // 哈希在锁外计算，多个告警线程互不阻塞
+    const uint64_t hash = dHash(image);
+
+    std::lock_guard<std::mutex> lock(m_mtx);
+    ++m_stats.checked;
+    std::deque<Entry>& history = m_history[key];
+    while (!history.empty() && nowMs - history.front().timeMs >= params.windowMs) {
+        history.pop_front();
+    }
+    for (const Entry& entry : history) {
+        if (hammingDistance(entry.hash, hash) <= params.hammingThreshold) {
+            ++m_stats.dropped;
+            return false;
+        }
+    }
+    if (history.size() >= MAX_HISTORY_PER_KEY) {
+        history.pop_front();
+    }
+    history.push_back({ hash, nowMs });
+    return true;
+}
+
+EvidenceDeduper::Stats EvidenceDeduper::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return m_stats;
+}
+
+void EvidenceDeduper::clear() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_history.clear();
+    m_stats = Stats();
+}
@@ -0,0 +1,55 @@
+#ifndef EVIDENCE_DEDUPER_H
+#define EVIDENCE_DEDUPER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * EvidenceDeduper - 证据近重复帧过滤
+ * 每张证据先用INTER_AREA缩到9x8灰度，相邻像素比较得到64位dHash；
+ * 同一个key(告警类型+来源)在时间窗口内已保留过汉明距离不超过阈值的帧时丢弃，在编码前完成。
+ * 被丢弃的帧不刷新历史时间戳，静止画面每个窗口仍保留一张。线程安全
+ */
+class EvidenceDeduper {
+public:
+    struct Params {
+        bool enable{ true };
+        int32_t hammingThreshold{ 6 };    // 距离不超过此值视为重复，<0时不过滤
+        int32_t windowMs{ 60000 };        // 历史帧保留时长
+    };
+
+    struct Stats {
+        uint64_t checked{ 0 };
+        uint64_t dropped{ 0 };
+    };
+
+    static uint64_t dHash(const cv::Mat& image);
+    static int32_t hammingDistance(uint64_t a, uint64_t b);
+
+    void setParams(const Params& params);
+    Params getParams() const;
+
+    // 返回false表示与窗口内已保留的帧重复，调用方直接丢弃
+    bool shouldKeep(const std::string& key, const cv::Mat& image, int64_t nowMs);
+    Stats getStats() const;
+    void clear();
+
+private:
+    struct Entry {
+        uint64_t hash{ 0 };
+        int64_t timeMs{ 0 };
+    };
+
+    mutable std::mutex m_mtx;
+    Params m_params;
+    std::unordered_map<std::string, std::deque<Entry>> m_history;
+    Stats m_stats;
+
+    static constexpr size_t MAX_HISTORY_PER_KEY = 8;
+};
+
+#endif // EVIDENCE_DEDUPER_H
@@ -0,0 +1,524 @@
+#include "EvidenceSegmentStore.h"
+#include "EvidenceBatch.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[4] = { 'P', 'A', 'S', 'G' };
+constexpr char RECORD_MAGIC[4] = { 'P', 'A', 'S', 'R' };
+constexpr size_t SEGMENT_HEADER_SIZE = 8;
+constexpr size_t RECORD_HEADER_SIZE = 28;
+constexpr size_t MAX_RECORD_NAME_LEN = 4096;
+constexpr const char* SEGMENT_PREFIX = "evidence_";
+constexpr const char* SEGMENT_EXT = ".seg";
+constexpr const char* ACK_EXT = ".ack";
+
+void putU16(uint8_t* p, uint16_t v) {
+    p[0] = static_cast<uint8_t>(v >> 8);
+    p[1] = static_cast<uint8_t>(v);
+}
+
+void putU32(uint8_t* p, uint32_t v) {
+    putU16(p, static_cast<uint16_t>(v >> 16));
+    putU16(p + 2, static_cast<uint16_t>(v));
+}
+
+void putU64(uint8_t* p, uint64_t v) {
+    putU32(p, static_cast<uint32_t>(v >> 32));
+    putU32(p + 4, static_cast<uint32_t>(v));
+}
+
+uint16_t getU16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t getU32(const uint8_t* p) {
+    return (static_cast<uint32_t>(getU16(p)) << 16) | getU16(p + 2);
+}
+
+uint64_t getU64(const uint8_t* p) {
+    return (static_cast<uint64_t>(getU32(p)) << 32) | getU32(p + 4);
+}
+
+// evidence_<id>.seg -> id，不匹配返回0
+uint64_t parseSegmentId(const fs::path& path) {
+    const std::string name = path.filename().string();
+    const size_t prefixLen = std::strlen(SEGMENT_PREFIX);
+    if (path.extension() != SEGMENT_EXT || name.compare(0, prefixLen, SEGMENT_PREFIX) != 0) {
+        return 0;
+    }
+    const std::string digits = path.stem().string().substr(prefixLen);
+    if (digits.empty() || !std::all_of(digits.begin(), digits.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return 0;
+    }
+    return std::strtoull(digits.c_str(), nullptr, 10);
+}
+
+bool hasSuffix(const std::string& name, const char* suffix) {
+    const size_t len = std::strlen(suffix);
+    return name.size() >= len && name.compare(name.size() - len, len, suffix) == 0;
+}
+
+// 旧版本上传器写出的证据文件名: [camN_]screen_*.jpg 或 [camN_]camera_*.jpg
+bool isLegacyEvidenceName(const std::string& name) {
+    if (!hasSuffix(name, ".jpg")) {
+        return false;
+    }
+    size_t pos = 0;
+    if (name.compare(0, 3, "cam") == 0) {
+        size_t end = 3;
+        while (end < name.size() && name[end] >= '0' && name[end] <= '9') {
+            ++end;
+        }
+        if (end > 3 && end < name.size() && '_' == name[end]) {
+            pos = end + 1;
+        }
+    }
+    return name.compare(pos, 7, "screen_") == 0 || name.compare(pos, 7, "camera_") == 0;
+}
+
+} // namespace
+
+// 段文件的只读映射；Windows上退化为整段读入内存
+struct EvidenceSegmentStore::Mapping {
+    const uint8_t* data{ nullptr };
+    size_t size{ 0 };
+#ifdef _WIN32
+    std::vector<uint8_t> buffer;
+#endif
+
+    ~Mapping() {
+#ifndef _WIN32
+        if (data) {
+            munmap(const_cast<uint8_t*>(data), size);
+        }
+#endif
+    }
+
+    static std::shared_ptr<Mapping> create(const std::string& path, uint64_t size) {
+        auto mapping = std::make_shared<Mapping>();
+        if (0 == size) {
+            return mapping;
+        }
+#ifdef _WIN32
+        std::ifstream in(path, std::ios::binary);
+        mapping->buffer.resize(static_cast<size_t>(size));
+        if (!in.read(reinterpret_cast<char*>(mapping->buffer.data()), mapping->buffer.size())) {
+            return nullptr;
+        }
+        mapping->data = mapping->buffer.data();
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return nullptr;
+        }
+        void* addr = mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (MAP_FAILED == addr) {
+            return nullptr;
+        }
+        mapping->data = static_cast<const uint8_t*>(addr);
+#endif
+        mapping->size = static_cast<size_t>(size);
+        return mapping;
+    }
+};
+
+EvidenceSegmentStore::~EvidenceSegmentStore() {
+    close();
+}
+
+void EvidenceSegmentStore::configure(const std::string& dir, uint64_t segmentMaxBytes) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_segmentMaxBytes = (std::max)(segmentMaxBytes, static_cast<uint64_t>(1u << 20));
+    if (dir == m_dir) {
+        return;
+    }
+    sealActiveLocked();
+    m_dir = dir;
+    // 新目录里可能已有段，下次追加前重新扫描编号；编号在进程内只增不减
+    m_nextSegmentId = 0;
+}
+
+std::string EvidenceSegmentStore::segmentPath(uint64_t id, const char* ext) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%016llu%s", SEGMENT_PREFIX, static_cast<unsigned long long>(id), ext);
+    return (fs::path(m_dir) / name).string();
+}
+
+void EvidenceSegmentStore::scanSegmentIdsLocked(std::vector<uint64_t>& ids) const {
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+        const uint64_t id = entry.is_regular_file(ec) ? parseSegmentId(entry.path()) : 0;
+        if (id > 0) {
+            ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+}
+
+bool EvidenceSegmentStore::openActiveLocked() {
+    if (m_activeFile) {
+        return true;
+    }
+    std::error_code ec;
+    fs::create_directories(m_dir, ec);
+    if (0 == m_nextSegmentId) {
+        std::vector<uint64_t> ids;
+        scanSegmentIdsLocked(ids);
+        uint64_t next = ids.empty() ? 1 : ids.back() + 1;
+        if (!m_segments.empty()) {
+            next = (std::max)(next, m_segments.rbegin()->first + 1);
+        }
+        m_nextSegmentId = next;
+    }
+    const uint64_t id = m_nextSegmentId++;
+    Segment segment;
+    segment.path = segmentPath(id, SEGMENT_EXT);
+    segment.ackPath = segmentPath(id, ACK_EXT);
+    m_activeFile = fopen(segment.path.c_str(), "wb");
+    if (!m_activeFile) {
+        MY_SPDLOG_ERROR("create evidence segment {} failed", segment.path);
+        return false;
+    }
+    uint8_t header[SEGMENT_HEADER_SIZE];
+    std::memcpy(header, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    putU16(header + 4, EVIDENCE_SEGMENT_VERSION);
+    putU16(header + 6, static_cast<uint16_t>(SEGMENT_HEADER_SIZE));
+    if (fwrite(header, 1, sizeof(header), m_activeFile) != sizeof(header) || fflush(m_activeFile) != 0) {
+        MY_SPDLOG_ERROR("write evidence segment {} header failed", segment.path);
+        fclose(m_activeFile);
+        m_activeFile = nullptr;
+        fs::remove(segment.path, ec);
+        return false;
+    }
+    segment.size = SEGMENT_HEADER_SIZE;
+    MY_SPDLOG_DEBUG("open evidence segment {}", segment.path);
+    m_segments[id] = std::move(segment);
+    m_activeId = id;
+    return true;
+}
+
+bool EvidenceSegmentStore::append(const std::string& name, uint8_t priority, int64_t createdMs,
+    const uint8_t* payload, size_t size, SegmentRecordRef& ref) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return appendLocked(name, priority, createdMs, payload, size, ref);
+}
+
+bool EvidenceSegmentStore::appendLocked(const std::string& name, uint8_t priority, int64_t createdMs,
+    const uint8_t* payload, size_t size, SegmentRecordRef& ref) {
+    if (name.size() > MAX_RECORD_NAME_LEN || size > UINT32_MAX) {
+        MY_SPDLOG_ERROR("evidence record {} too large: {} bytes", name, size);
+        return false;
+    }
+    const uint64_t recordSize = RECORD_HEADER_SIZE + name.size() + size;
+    // 当前段放不下时换新段，单条超过段上限的单独占一段
+    if (m_activeFile) {
+        const Segment& active = m_segments[m_activeId];
+        if (active.records > 0 && active.size + recordSize > m_segmentMaxBytes) {
+            sealActiveLocked();
+        }
+    }
+    if (!openActiveLocked()) {
+        return false;
+    }
+
+    uint8_t header[RECORD_HEADER_SIZE] = { 0 };
+    std::memcpy(header, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+    putU32(header + 4, static_cast<uint32_t>(name.size()));
+    putU32(header + 8, static_cast<uint32_t>(size));
+    putU64(header + 12, static_cast<uint64_t>(createdMs));
+    header[20] = priority;
+    uint32_t crc = EvidenceBatch::crc32(0, name.data(), name.size());
+    crc = EvidenceBatch::crc32(crc, payload, size);
+    putU32(header + 24, crc);
+
+    Segment& segment = m_segments[m_activeId];
+    const bool ok = fwrite(header, 1, sizeof(header), m_activeFile) == sizeof(header)
+        && fwrite(name.data(), 1, name.size(), m_activeFile) == name.size()
+        && fwrite(payload, 1, size, m_activeFile) == size
+        && fflush(m_activeFile) == 0;
+    if (!ok) {
+        // 截掉写了一半的记录，之后写入新段
+        MY_SPDLOG_ERROR("append evidence {} to segment {} failed", name, segment.path);
+        const uint64_t validSize = segment.size;
+        const std::string path = segment.path;
+        sealActiveLocked();
+        std::error_code ec;
+        fs::resize_file(path, validSize, ec);
+        return false;
+    }
+    ref.segmentId = m_activeId;
+    ref.offset = segment.size;
+    ref.payloadSize = static_cast<uint32_t>(size);
+    segment.size += recordSize;
+    ++segment.records;
+    ++m_stats.appended;
+    return true;
+}
+
+void EvidenceSegmentStore::sealActiveLocked() {
+    if (!m_activeFile) {
+        return;
+    }
+    fclose(m_activeFile);
+    m_activeFile = nullptr;
+    const uint64_t id = m_activeId;
+    m_activeId = 0;
+    reclaimIfDoneLocked(id);
+}
+
+bool EvidenceSegmentStore::view(const SegmentRecordRef& ref, SegmentRecordView& out) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_segments.find(ref.segmentId);
+    if (it == m_segments.end()) {
+        return false;
+    }
+    Segment& segment = it->second;
+    if (ref.offset + RECORD_HEADER_SIZE > segment.size) {
+        return false;
+    }
+    // 当前段追加后原有映射可能不够长，按当前长度重新映射；旧映射由在途上传继续持有
+    if (!segment.mapping || segment.mapping->size < segment.size) {
+        segment.mapping = Mapping::create(segment.path, segment.size);
+        if (!segment.mapping) {
+            MY_SPDLOG_ERROR("map evidence segment {} failed", segment.path);
+            return false;
+        }
+    }
+    const uint8_t* head = segment.mapping->data + ref.offset;
+    const uint32_t nameLen = getU32(head + 4);
+    const uint32_t payloadLen = getU32(head + 8);
+    if (std::memcmp(head, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0 || payloadLen != ref.payloadSize
+        || ref.offset + RECORD_HEADER_SIZE + nameLen + payloadLen > segment.mapping->size) {
+        MY_SPDLOG_ERROR("bad evidence record at {}:{}", segment.path, ref.offset);
+        return false;
+    }
+    out.payload = head + RECORD_HEADER_SIZE + nameLen;
+    out.size = payloadLen;
+    out.owner = segment.mapping;
+    return true;
+}
+
+void EvidenceSegmentStore::acknowledge(const SegmentRecordRef& ref) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    auto it = m_segments.find(ref.segmentId);
+    if (it == m_segments.end()) {
+        return;
+    }
+    Segment& segment = it->second;
+    if (!segment.ackFile) {
+        segment.ackFile = fopen(segment.ackPath.c_str(), "ab");
+    }
+    if (segment.ackFile) {
+        uint8_t offset[8];
+        putU64(offset, ref.offset);
+        fwrite(offset, 1, sizeof(offset), segment.ackFile);
+        fflush(segment.ackFile);
+    }
+    ++segment.acked;
+    ++m_stats.acknowledged;
+    // 积压已全部上传时结束当前段，让它立即被回收
+    if (ref.segmentId == m_activeId && segment.acked >= segment.records) {
+        sealActiveLocked();
+        return;
+    }
+    reclaimIfDoneLocked(ref.segmentId);
+}
+
+void EvidenceSegmentStore::reclaimIfDoneLocked(uint64_t id) {
+    auto it = m_segments.find(id);
+    if (it == m_segments.end() || id == m_activeId || it->second.acked < it->second.records) {
+        return;
+    }
+    Segment& segment = it->second;
+    if (segment.ackFile) {
+        fclose(segment.ackFile);
+        segment.ackFile = nullptr;
+    }
+    // 在途上传持有的映射在删除文件后仍然有效
+    std::error_code ec;
+    fs::remove(segment.path, ec);
+    fs::remove(segment.ackPath, ec);
+    MY_SPDLOG_DEBUG("reclaim evidence segment {} ({} records)", segment.path, segment.records);
+    ++m_stats.reclaimedSegments;
+    m_segments.erase(it);
+}
+
+bool EvidenceSegmentStore::recover(std::vector<SegmentStoredRecord>& pending) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    std::error_code ec;
+    fs::create_directories(m_dir, ec);
+    std::vector<uint64_t> ids;
+    scanSegmentIdsLocked(ids);
+    for (uint64_t id : ids) {
+        auto it = m_segments.find(id);
+        if (it != m_segments.end()) {
+            // 目录变化前打开的同编号段还未回收时，新目录的这个段留到下次recover再加载
+            if (it->second.path != segmentPath(id, SEGMENT_EXT)) {
+                MY_SPDLOG_WARN("evidence segment {} deferred, id in use by {}", segmentPath(id, SEGMENT_EXT), it->second.path);
+            }
+            continue;
+        }
+        loadSegmentLocked(id, pending);
+        m_nextSegmentId = (std::max)(m_nextSegmentId, id + 1);
+    }
+    migrateLooseFilesLocked(pending);
+    return true;
+}
+
+bool EvidenceSegmentStore::loadSegmentLocked(uint64_t id, std::vector<SegmentStoredRecord>& pending) {
+    Segment segment;
+    segment.path = segmentPath(id, SEGMENT_EXT);
+    segment.ackPath = segmentPath(id, ACK_EXT);
+    const std::string& ackPath = segment.ackPath;
+    std::error_code ec;
+    const uint64_t fileSize = fs::file_size(segment.path, ec);
+    std::shared_ptr<Mapping> mapping = ec ? nullptr : Mapping::create(segment.path, fileSize);
+    if (!mapping || fileSize < SEGMENT_HEADER_SIZE
+        || std::memcmp(mapping->data, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) != 0) {
+        // 段头都没写完，没有可恢复的记录
+        MY_SPDLOG_WARN("drop invalid evidence segment {}", segment.path);
+        fs::remove(segment.path, ec);
+        fs::remove(ackPath, ec);
+        return false;
+    }
+    const uint64_t headerSize = (std::max)(static_cast<uint64_t>(getU16(mapping->data + 6)),
+        static_cast<uint64_t>(SEGMENT_HEADER_SIZE));
+
+    std::unordered_set<uint64_t> acked;
+    std::ifstream ackIn(ackPath, std::ios::binary);
+    uint8_t buf[8];
+    while (ackIn.read(reinterpret_cast<char*>(buf), sizeof(buf))) {
+        acked.insert(getU64(buf));
+    }
+
+    // 顺序校验记录，遇到写了一半或损坏的记录时截断，之后的数据不可信
+    const size_t firstPending = pending.size();
+    uint64_t offset = headerSize;
+    while (offset + RECORD_HEADER_SIZE <= fileSize) {
+        const uint8_t* head = mapping->data + offset;
+        const uint32_t nameLen = getU32(head + 4);
+        const uint32_t payloadLen = getU32(head + 8);
+        const uint64_t end = offset + RECORD_HEADER_SIZE + nameLen + payloadLen;
+        if (std::memcmp(head, RECORD_MAGIC, sizeof(RECORD_MAGIC)) != 0 || nameLen > MAX_RECORD_NAME_LEN
+            || end > fileSize) {
+            break;
+        }
+        uint32_t crc = EvidenceBatch::crc32(0, head + RECORD_HEADER_SIZE, nameLen + static_cast<size_t>(payloadLen));
+        if (crc != getU32(head + 24)) {
+            break;
+        }
+        ++segment.records;
+        if (acked.count(offset) > 0) {
+            ++segment.acked;
+        }
+        else {
+            SegmentStoredRecord record;
+            record.ref.segmentId = id;
+            record.ref.offset = offset;
+            record.ref.payloadSize = payloadLen;
+            record.name.assign(reinterpret_cast<const char*>(head + RECORD_HEADER_SIZE), nameLen);
+            record.priority = head[20];
+            record.createdMs = static_cast<int64_t>(getU64(head + 12));
+            pending.emplace_back(std::move(record));
+        }
+        offset = end;
+    }
+    if (offset < fileSize) {
+        MY_SPDLOG_WARN("truncate evidence segment {} at {} (file size {})", segment.path, offset, fileSize);
+        mapping.reset();
+        fs::resize_file(segment.path, offset, ec);
+    }
+    segment.size = offset;
+    segment.mapping = std::move(mapping);
+    MY_SPDLOG_INFO("load evidence segment {}: {} records, {} pending", segment.path, segment.records,
+        pending.size() - firstPending);
+    m_segments[id] = std::move(segment);
+    reclaimIfDoneLocked(id);
+    return true;
+}
+
+void EvidenceSegmentStore::migrateLooseFilesLocked(std::vector<SegmentStoredRecord>& pending) {
+    // 旧版本每条证据一个文件，按修改时间顺序迁入段中，迁移成功后删除原文件；
+    // 只处理旧上传器命名的证据，目录中的其他文件保持不动
+    std::error_code ec;
+    std::vector<std::pair<fs::file_time_type, fs::path>> files;
+    for (const auto& entry : fs::directory_iterator(m_dir, ec)) {
+        if (!entry.is_regular_file(ec)) {
+            continue;
+        }
+        const fs::path& path = entry.path();
+        const std::string name = path.filename().string();
+        // 旧上传器写了一半的临时文件<name>.jpg.tmp直接清理
+        if (hasSuffix(name, ".tmp")) {
+            if (isLegacyEvidenceName(name.substr(0, name.size() - 4))) {
+                fs::remove(path, ec);
+            }
+            continue;
+        }
+        if (isLegacyEvidenceName(name)) {
+            files.emplace_back(entry.last_write_time(ec), path);
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    std::vector<uint8_t> data;
+    for (const auto& file : files) {
+        std::ifstream in(file.second, std::ios::binary);
+        if (!in) {
+            MY_SPDLOG_ERROR("open evidence file {} failed", file.second.string());
+            continue;
+        }
+        data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        SegmentStoredRecord record;
+        record.name = file.second.filename().string();
+        if (!appendLocked(record.name, 0, 0, data.data(), data.size(), record.ref)) {
+            continue;
+        }
+        in.close();
+        fs::remove(file.second, ec);
+        pending.emplace_back(std::move(record));
+    }
+    if (!files.empty()) {
+        MY_SPDLOG_INFO("migrated {} evidence files into segments", files.size());
+    }
+}
+
+void EvidenceSegmentStore::close() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    sealActiveLocked();
+    for (auto& entry : m_segments) {
+        if (entry.second.ackFile) {
+            fclose(entry.second.ackFile);
+        }
+    }
+    // 索引随之丢弃，再次recover时从磁盘重建
+    m_segments.clear();
+}
+
+SegmentStoreStats EvidenceSegmentStore::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    SegmentStoreStats stats = m_stats;
+    stats.segments = m_segments.size();
+    stats.diskBytes = 0;
+    for (const auto& entry : m_segments) {
+        stats.diskBytes += entry.second.size;
+    }
+    return stats;
+}
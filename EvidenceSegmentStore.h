@@ -0,0 +1,110 @@
+#ifndef EVIDENCE_SEGMENT_STORE_H
+#define EVIDENCE_SEGMENT_STORE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * 证据段文件 evidence_<id>.seg，只追加，整数均为网络字节序:
+ *   段头 : "PASG" | u16 version | u16 headerSize
+ *   记录 : "PASR" | u32 nameLen | u32 payloadLen | u64 createdMs | u8 priority | u8 reserved | u16 reserved
+ *          | u32 crc32(name + payload) | name | payload
+ * 确认日志 evidence_<id>.ack 追加已上传记录的u64偏移。
+ * 启动时按记录头重建索引，末尾写了一半或校验失败的记录截断丢弃
+ */
+constexpr uint16_t EVIDENCE_SEGMENT_VERSION = 1;
+
+// 记录在段中的位置，由append返回
+struct SegmentRecordRef {
+    uint64_t segmentId{ 0 };
+    uint64_t offset{ 0 };                // 记录头在段文件中的偏移
+    uint32_t payloadSize{ 0 };
+};
+
+// 指向映射内存的报文，owner持有映射直到上传结束，段被回收后仍然有效
+struct SegmentRecordView {
+    const uint8_t* payload{ nullptr };
+    size_t size{ 0 };
+    std::shared_ptr<const void> owner;
+};
+
+struct SegmentStoredRecord {
+    SegmentRecordRef ref;
+    std::string name;
+    uint8_t priority{ 0 };
+    int64_t createdMs{ 0 };
+};
+
+struct SegmentStoreStats {
+    uint64_t appended{ 0 };
+    uint64_t acknowledged{ 0 };
+    uint64_t reclaimedSegments{ 0 };
+    size_t segments{ 0 };
+    uint64_t diskBytes{ 0 };
+};
+
+/**
+ * EvidenceSegmentStore - 证据追加式分段存储
+ * 离线或内存积压的证据顺序追加到当前段，超过segmentMaxBytes后换新段，不再每条证据一个小文件。
+ * 上传时mmap段文件直接把报文交给curl，不拷贝；段内记录全部确认后整段删除。线程安全
+ */
+class EvidenceSegmentStore {
+public:
+    EvidenceSegmentStore() = default;
+    ~EvidenceSegmentStore();
+
+    // 目录变化时先关闭当前段，之后的追加写入新目录；已打开的段仍在原目录确认和回收
+    void configure(const std::string& dir, uint64_t segmentMaxBytes);
+    // 加载目录中本进程尚未打开的段，返回未确认的记录；目录中旧版本的单个证据文件迁入新段
+    bool recover(std::vector<SegmentStoredRecord>& pending);
+    bool append(const std::string& name, uint8_t priority, int64_t createdMs,
+        const uint8_t* payload, size_t size, SegmentRecordRef& ref);
+    bool view(const SegmentRecordRef& ref, SegmentRecordView& out);
+    // 记录已上传；段不再追加且记录全部确认后删除整段
+    void acknowledge(const SegmentRecordRef& ref);
+    // 停止时关闭当前段并丢弃索引，此前返回的引用失效，需要重新recover
+    void close();
+    SegmentStoreStats getStats() const;
+
+private:
+    EvidenceSegmentStore(const EvidenceSegmentStore&) = delete;
+    EvidenceSegmentStore& operator=(const EvidenceSegmentStore&) = delete;
+
+    struct Mapping;
+    struct Segment {
+        std::string path;                   // 打开或加载时的完整路径，不随m_dir变化
+        std::string ackPath;
+        uint64_t size{ 0 };
+        uint32_t records{ 0 };
+        uint32_t acked{ 0 };
+        FILE* ackFile{ nullptr };
+        std::shared_ptr<Mapping> mapping;   // 按需映射，段增长后重新映射
+    };
+
+    // 以下调用方持有m_mtx
+    std::string segmentPath(uint64_t id, const char* ext) const;
+    void scanSegmentIdsLocked(std::vector<uint64_t>& ids) const;
+    bool openActiveLocked();
+    bool appendLocked(const std::string& name, uint8_t priority, int64_t createdMs,
+        const uint8_t* payload, size_t size, SegmentRecordRef& ref);
+    void sealActiveLocked();
+    bool loadSegmentLocked(uint64_t id, std::vector<SegmentStoredRecord>& pending);
+    void migrateLooseFilesLocked(std::vector<SegmentStoredRecord>& pending);
+    void reclaimIfDoneLocked(uint64_t id);
+
+    mutable std::mutex m_mtx;
+    std::string m_dir;
+    uint64_t m_segmentMaxBytes{ 64u << 20 };
+    std::map<uint64_t, Segment> m_segments;
+    uint64_t m_nextSegmentId{ 0 };           // 0表示尚未扫描目录
+    uint64_t m_activeId{ 0 };                // 0表示没有正在追加的段
+    FILE* m_activeFile{ nullptr };
+    SegmentStoreStats m_stats;
+};
+
+#endif // EVIDENCE_SEGMENT_STORE_H
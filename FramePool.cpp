@@ -0,0 +1,126 @@
+#include "FramePool.h"
+#include "MyLogger.hpp"
+
+#include <utility>
+
+// ---------------- FrameHandle ----------------
+
+FrameHandle::FrameHandle(FramePool* pool, Slot* slot)
+    : m_pool(pool), m_slot(slot) {
+    m_slot->refs.store(1, std::memory_order_relaxed);
+}
+
+FrameHandle::FrameHandle(const FrameHandle& other)
+    : m_pool(other.m_pool), m_slot(other.m_slot) {
+    if (m_slot) {
+        m_slot->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+FrameHandle::FrameHandle(FrameHandle&& other) noexcept
+    : m_pool(other.m_pool), m_slot(other.m_slot) {
+    other.m_pool = nullptr;
+    other.m_slot = nullptr;
+}
+
+FrameHandle& FrameHandle::operator=(const FrameHandle& other) {
+    if (this != &other) {
+        FrameHandle tmp(other);
+        *this = std::move(tmp);
+    }
+    return *this;
+}
+
+FrameHandle& FrameHandle::operator=(FrameHandle&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_pool = other.m_pool;
+        m_slot = other.m_slot;
+        other.m_pool = nullptr;
+        other.m_slot = nullptr;
+    }
+    return *this;
+}
+
+FrameHandle::~FrameHandle() {
+    reset();
+}
+
+const cv::Mat& FrameHandle::image() const {
+    static const cv::Mat emptyMat;
+    return m_slot ? m_slot->image : emptyMat;
+}
+
+cv::Mat& FrameHandle::writable() {
+    // 仅在发布前由唯一持有者写入
+    CV_Assert(m_slot && 1 == m_slot->refs.load(std::memory_order_relaxed));
+    return m_slot->image;
+}
+
+const std::vector<uint8_t>& FrameHandle::encoded() const {
+    static const std::vector<uint8_t> emptyData;
+    return m_slot ? m_slot->encoded : emptyData;
+}
+
+std::vector<uint8_t>& FrameHandle::writableEncoded() {
+    CV_Assert(m_slot && 1 == m_slot->refs.load(std::memory_order_relaxed));
+    return m_slot->encoded;
+}
+
+void FrameHandle::reset() {
+    if (nullptr == m_slot) {
+        return;
+    }
+    if (1 == m_slot->refs.fetch_sub(1, std::memory_order_acq_rel)) {
+        m_pool->release(m_slot);
+    }
+    m_pool = nullptr;
+    m_slot = nullptr;
+}
+
+// ---------------- FramePool ----------------
+
+FramePool::FramePool(size_t capacity) {
+    m_slots.reserve(capacity);
+    m_freeSlots.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        m_slots.emplace_back(new FrameHandle::Slot());
+        m_freeSlots.push_back(m_slots.back().get());
+    }
+}
+
+FramePool::~FramePool() {
+    std::lock_guard<std::mutex> lock(m_freeMtx);
+    if (m_freeSlots.size() != m_slots.size()) {
+        MY_SPDLOG_ERROR("frame pool destroyed with {} frames still referenced",
+            m_slots.size() - m_freeSlots.size());
+    }
+}
+
+FrameHandle FramePool::acquire() {
+    FrameHandle::Slot* slot = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_freeMtx);
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+    }
+    if (nullptr == slot) {
+        ++m_exhaustedCnt;
+        return FrameHandle();
+    }
+    return FrameHandle(this, slot);
+}
+
+size_t FramePool::available() const {
+    std::lock_guard<std::mutex> lock(m_freeMtx);
+    return m_freeSlots.size();
+}
+
+void FramePool::release(FrameHandle::Slot* slot) {
+    // 保留slot->image的内存，下次acquire直接复用；压缩数据只清空不释放
+    slot->encoded.clear();
+    std::lock_guard<std::mutex> lock(m_freeMtx);
+    m_freeSlots.push_back(slot);
+}
@@ -0,0 +1,82 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class FramePool;
+
+/**
+ * FrameHandle - 帧缓冲的引用计数句柄
+ * 拷贝句柄只增加引用计数，不拷贝像素；最后一个句柄析构时缓冲归还帧池。
+ * 约定：只有持有唯一引用的生产者可以通过writable()写入，发布后各线程只读
+ */
+class FrameHandle {
+public:
+    FrameHandle() = default;
+    FrameHandle(const FrameHandle& other);
+    FrameHandle(FrameHandle&& other) noexcept;
+    FrameHandle& operator=(const FrameHandle& other);
+    FrameHandle& operator=(FrameHandle&& other) noexcept;
+    ~FrameHandle();
+
+    bool empty() const { return nullptr == m_slot || m_slot->image.empty(); }
+    explicit operator bool() const { return nullptr != m_slot; }
+
+    const cv::Mat& image() const;
+    cv::Mat& writable();
+    // 采集端的压缩原始帧(MJPEG)，image()为缩小解码结果时用于按需全分辨率解码；无则为空
+    const std::vector<uint8_t>& encoded() const;
+    std::vector<uint8_t>& writableEncoded();
+    void reset();
+
+private:
+    friend class FramePool;
+    struct Slot {
+        cv::Mat image;
+        std::vector<uint8_t> encoded;
+        std::atomic<int32_t> refs{ 0 };
+    };
+
+    FrameHandle(FramePool* pool, Slot* slot);
+
+    FramePool* m_pool{ nullptr };
+    Slot* m_slot{ nullptr };
+};
+
+/**
+ * FramePool - 固定数量的可复用帧缓冲
+ * 缓冲尺寸不变时cv::Mat::create/VideoCapture::retrieve直接复用已有内存，
+ * 采集、检测、告警线程之间通过FrameHandle共享同一份像素，不做整帧拷贝
+ */
+class FramePool {
+public:
+    explicit FramePool(size_t capacity = DEFAULT_CAPACITY);
+    ~FramePool();
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    // 取一个空闲缓冲，池耗尽时返回空句柄
+    FrameHandle acquire();
+
+    size_t capacity() const { return m_slots.size(); }
+    size_t available() const;
+    uint64_t getExhaustedCount() const { return m_exhaustedCnt.load(); }
+
+    static constexpr size_t DEFAULT_CAPACITY = 8;
+
+private:
+    friend class FrameHandle;
+    void release(FrameHandle::Slot* slot);
+
+    std::vector<std::unique_ptr<FrameHandle::Slot>> m_slots;
+    std::vector<FrameHandle::Slot*> m_freeSlots;
+    mutable std::mutex m_freeMtx;
+    std::atomic<uint64_t> m_exhaustedCnt{ 0 };
+};
+
+#endif // FRAME_POOL_H
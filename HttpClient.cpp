@@ -1,7 +1,6 @@
 #include <algorithm>
 #include <cctype>
 #include <chrono>
-#include <thread>
 #include <sstream>
 #include <filesystem>
 
@@ -12,12 +11,129 @@
 // HttpClient实现
 HttpClient::HttpClient() {
     curl_global_init(CURL_GLOBAL_DEFAULT);
+
+    // DNS、TLS会话和连接缓存在所有句柄间共享，重复请求免去解析和握手
+    m_share = curl_share_init();
+    if (m_share) {
+        curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, &HttpClient::shareLock);
+        curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, &HttpClient::shareUnlock);
+        curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+#if LIBCURL_VERSION_NUM >= 0x073900
+        curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+#endif
+    }
+    m_engine.start();
 }
 
 HttpClient::~HttpClient() {
+    // 先停引擎，句柄全部释放后才能清理共享缓存
+    m_engine.stop();
+    if (m_share) {
+        curl_share_cleanup(m_share);
+        m_share = nullptr;
+    }
     curl_global_cleanup();
 }
 
+void HttpClient::shareLock(CURL* /* handle */, curl_lock_data data, curl_lock_access /* access */, void* userptr) {
+    static_cast<HttpClient*>(userptr)->m_shareMtx[data].lock();
+}
+
+void HttpClient::shareUnlock(CURL* /* handle */, curl_lock_data data, void* userptr) {
+    static_cast<HttpClient*>(userptr)->m_shareMtx[data].unlock();
+}
+
+void HttpClient::setConnectionReuse(bool enable) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_reuseConnections = enable;
+}
+
+void HttpClient::setMaxConcurrentUploads(int32_t maxConcurrency) {
+    m_engine.setMaxConcurrency(maxConcurrency);
+}
+
+void HttpClient::setMaxUploadSpeed(int64_t bytesPerSec) {
+    m_maxUploadSpeed.store(bytesPerSec);
+}
+
+HttpTransferStats HttpClient::getTransferStats() const {
+    return m_engine.getStats();
+}
+
+bool HttpClient::cancelTransfer(uint64_t id) {
+    return m_engine.cancel(id);
+}
+
+void HttpClient::configureHandle(CURL* curl, const std::string& certPath, bool https, bool reuse, CURLSH* share) {
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, TRANSFER_TIMEOUT);
+
+    if (reuse) {
+        if (share) {
+            curl_easy_setopt(curl, CURLOPT_SHARE, share);
+        }
+        curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+        // 服务端支持时经ALPN协商HTTP/2，明文HTTP仍用HTTP/1.1
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    }
+    else {
+        curl_easy_setopt(curl, CURLOPT_FRESH_CONNECT, 1L);
+        curl_easy_setopt(curl, CURLOPT_FORBID_REUSE, 1L);
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_1);
+    }
+
+    if (https) {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
+        curl_easy_setopt(curl, CURLOPT_CAINFO, certPath.c_str());
+#if LIBCURL_VERSION_NUM >= 0x075700
+        // 解析后的CA证书库缓存一天，新连接不再重新加载ca-bundle.crt
+        if (reuse) {
+            curl_easy_setopt(curl, CURLOPT_CA_CACHE_TIMEOUT, 86400L);
+        }
+#endif
+    }
+    else {
+        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    }
+}
+
+bool HttpClient::buildRequest(const std::string& path, const std::vector<std::string>& extraHeaders,
+    HttpTransferRequest& request) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    request.url = m_baseUrl + path;
+    request.headers = buildCommonHeaders();
+    request.headers.insert(request.headers.end(), extraHeaders.begin(), extraHeaders.end());
+
+    bool isHTTPS = false;
+    size_t pos = request.url.find("://");
+    if (pos != std::string::npos) {
+        std::string scheme = request.url.substr(0, pos);
+        std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
+        isHTTPS = (scheme == "https");
+    }
+    else {
+        MY_SPDLOG_WARN("Invalid URL format: {}", request.url);
+    }
+    if (isHTTPS && m_certPath.empty()) {
+        MY_SPDLOG_ERROR("HTTPS requires certificate file");
+        return false;
+    }
+    if (isHTTPS) {
+        MY_SPDLOG_TRACE("Using SSL verification with cert: {}", m_certPath);
+    }
+    else {
+        MY_SPDLOG_TRACE("Disabled SSL verification for HTTP");
+    }
+
+    // I/O线程执行时参数可能已被修改，按值捕获提交时的快照
+    request.configure = [certPath = m_certPath, isHTTPS, reuse = m_reuseConnections, share = m_share](CURL* curl) {
+        configureHandle(curl, certPath, isHTTPS, reuse, share);
+    };
+    return true;
+}
+
 HttpClient* HttpClient::getInstance()
 {
     static HttpClient instance;
@@ -39,199 +155,205 @@ void HttpClient::setHttpClientParam(const std::string& computerName, const std::
 }
 
 bool HttpClient::uploadPicData(const std::vector<uint8_t>& data) {
-    std::vector<std::string> headers = {
-        "Content-Type: application/octet-stream",
-        "Expect:"
-    };
-
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        MY_SPDLOG_ERROR("Failed to initialize CURL handle");
+    const std::string path = "/client/risk/upload";
+    HttpTransferRequest request;
+    if (!buildRequest(path, { "Content-Type: application/octet-stream", "Expect:" }, request)) {
         return false;
     }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    bool result = performRequest(curl, "/client/risk/upload",
-        reinterpret_cast<const char*>(data.data()),
-        data.size(), headers);
-    curl_easy_cleanup(curl);
-    return result;
+    // 同步等待结果，数据由调用方持有
+    request.body = reinterpret_cast<const char*>(data.data());
+    request.bodySize = data.size();
+    return performRequest(request, path);
 }
 
 bool HttpClient::requestKey() {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        MY_SPDLOG_ERROR("Failed to initialize CURL handle");
+    const std::string path = "/client/activate";
+    HttpTransferRequest request;
+    if (!buildRequest(path, {}, request)) {
         return false;
     }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    bool result = performRequest(curl, "/client/activate", nullptr, 0, {});
+    request.urgent = true;
+    bool result = performRequest(request, path);
     if (result) {
-        MY_SPDLOG_INFO("License key acquired: {}", m_licenseKey);
+        MY_SPDLOG_INFO("License key acquired: {}", getLicenseKey());
     }
-    curl_easy_cleanup(curl);
     return result;
 }
 
 bool HttpClient::requestUnKey() {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        MY_SPDLOG_ERROR("Failed to initialize CURL handle");
+    const std::string path = "/client/unActivate";
+    HttpTransferRequest request;
+    if (!buildRequest(path, {}, request)) {
         return false;
     }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    bool result = performRequest(curl, "/client/unActivate", nullptr, 0, {});
+    request.urgent = true;
+    bool result = performRequest(request, path);
     if (result) {
-        MY_SPDLOG_INFO("License key acquired: {}", m_licenseUnKey);
+        MY_SPDLOG_INFO("License key acquired: {}", getLicenseUnKey());
     }
-    curl_easy_cleanup(curl);
     return result;
 }
 
 bool HttpClient::requestConfig() {
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        MY_SPDLOG_ERROR("Failed to initialize CURL handle");
+    const std::string path = "/client/getCfg";
+    HttpTransferRequest request;
+    if (!buildRequest(path, {}, request)) {
         return false;
     }
-
-    std::lock_guard<std::mutex> lock(m_mutex);
-    bool result = performRequest(curl, "/client/getCfg", nullptr, 0, {});
+    request.urgent = true;
+    bool result = performRequest(request, path);
     if (result) {
-        MY_SPDLOG_INFO("Config acquired: {}", m_configCfg);
+        MY_SPDLOG_INFO("Config acquired: {}", getConfig());
     }
-    curl_easy_cleanup(curl);
     return result;
 }
 
+bool HttpClient::uploadFile(const std::filesystem::path& filePath) {
+    const std::string path = "/client/risk/upload";
+    HttpTransferRequest request;
+    if (!buildRequest(path, { "Content-Type: application/octet-stream", "Expect:" }, request)) {
+        return false;
+    }
+    request.filePath = filePath;
+    return performRequest(request, path);
+}
+
+uint64_t HttpClient::uploadPicDataAsync(std::shared_ptr<const std::vector<uint8_t>> data, UploadCallback callback) {
+    if (!data) {
+        return 0;
+    }
+    const uint8_t* bytes = data->data();
+    const size_t size = data->size();
+    return uploadPicDataAsync(bytes, size, std::move(data), std::move(callback));
+}
+
+uint64_t HttpClient::uploadPicDataAsync(const uint8_t* data, size_t size, std::shared_ptr<const void> owner,
+    UploadCallback callback) {
+    HttpTransferRequest request;
+    if (!data || !buildRequest("/client/risk/upload", { "Content-Type: application/octet-stream", "Expect:" }, request)) {
+        return 0;
+    }
+    request.body = reinterpret_cast<const char*>(data);
+    request.bodySize = size;
+    request.bodyOwner = std::move(owner);
+    return submitUpload("/client/risk/upload", std::move(request), std::move(callback));
+}
+
+uint64_t HttpClient::uploadFileAsync(const std::filesystem::path& filePath, UploadCallback callback) {
+    HttpTransferRequest request;
+    if (!buildRequest("/client/risk/upload", { "Content-Type: application/octet-stream", "Expect:" }, request)) {
+        return 0;
+    }
+    request.filePath = filePath;
+    return submitUpload("/client/risk/upload", std::move(request), std::move(callback));
+}
+
+uint64_t HttpClient::uploadBatchAsync(std::shared_ptr<EvidenceBatchWriter> batch, UploadCallback callback) {
+    const std::string path = "/client/risk/uploadBatch";
+    HttpTransferRequest request;
+    if (!batch || !buildRequest(path, { "Content-Type: application/x-padetect-batch",
+        "x-batch-version: " + std::to_string(EVIDENCE_BATCH_VERSION), "Expect:" }, request)) {
+        return 0;
+    }
+    batch->rewind();
+    request.bodyReaderSize = batch->totalSize();
+    request.bodyReader = [batch](char* buffer, size_t len) -> size_t {
+        const size_t n = batch->read(buffer, len);
+        return batch->failed() ? CURL_READFUNC_ABORT : n;
+    };
+    return submitUpload(path, std::move(request), std::move(callback));
+}
+
+uint64_t HttpClient::submitUpload(const std::string& path, HttpTransferRequest&& request, UploadCallback callback) {
+    const int64_t maxSpeed = m_maxUploadSpeed.load();
+    if (maxSpeed > 0) {
+        request.configure = [configure = std::move(request.configure), maxSpeed](CURL* curl) {
+            if (configure) {
+                configure(curl);
+            }
+            curl_easy_setopt(curl, CURLOPT_MAX_SEND_SPEED_LARGE, static_cast<curl_off_t>(maxSpeed));
+        };
+    }
+    return m_engine.submit(std::move(request), [this, path, callback](HttpTransferResult&& result) {
+        const bool success = !result.cancelled && checkResult(result, path);
+        if (callback) {
+            callback(success, result.cancelled);
+        }
+    });
+}
+
 std::string HttpClient::getLicenseKey() const
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_licenseKey;
 }
 
 std::string HttpClient::getLicenseUnKey() const
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_licenseUnKey;
 }
 
 std::string HttpClient::getConfig() const
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_configCfg;
 }
 
 std::string HttpClient::getConfigCheckSums() const
 {
+    std::lock_guard<std::mutex> lock(m_mutex);
     return m_configChecksums;
 }
 
-size_t HttpClient::writeCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
-    size_t total = size * nmemb;
-    output->append(static_cast<char*>(contents), total);
-    return total;
-}
-
-bool HttpClient::performRequest(CURL* curl, const std::string& path, const char* data,
-                              size_t dataSize, const std::vector<std::string>& extraHeaders) {
-    std::string url = m_baseUrl + path;
-    std::string response;
-    long httpCode = 0;
-
-    struct curl_slist* headers = buildCommonHeaders();
-
-    for (const auto& h : extraHeaders) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-    bool isHTTPS = false;
-    size_t pos = url.find("://");
-    if (pos != std::string::npos) {
-        std::string scheme = url.substr(0, pos);
-        std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
-        isHTTPS = (scheme == "https");
-    }
-    else {
-        MY_SPDLOG_WARN("Invalid URL format: {}", url);
-    }
-
-    if (isHTTPS) {
-        if (!m_certPath.empty()) {
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-            curl_easy_setopt(curl, CURLOPT_CAINFO, m_certPath.c_str());
-            MY_SPDLOG_DEBUG("Using SSL verification with cert: {}", m_certPath);
+bool HttpClient::performRequest(const HttpTransferRequest& request, const std::string& path) {
+    for (int attempt = 1; ; ++attempt) {
+        HttpTransferResult result = m_engine.submit(request).get();
+        if (CURLE_OK == result.code || result.cancelled) {
+            return !result.cancelled && checkResult(result, path);
         }
-        else {
-            MY_SPDLOG_ERROR("HTTPS requires certificate file");
+        MY_SPDLOG_WARN("CURL error: {} ({}), attempt {}/{}",
+                      curl_easy_strerror(result.code), result.error, attempt, MAX_RETRIES);
+        // 可重试的错误类型：连接失败、超时、发送/接收中断
+        const bool retryable = result.code == CURLE_COULDNT_CONNECT ||
+            result.code == CURLE_OPERATION_TIMEDOUT ||
+            result.code == CURLE_SEND_ERROR ||
+            result.code == CURLE_RECV_ERROR;
+        if (!retryable) {
+            MY_SPDLOG_ERROR("Non-recoverable error: {} ({})",
+                           curl_easy_strerror(result.code), result.error);
+            return false;
+        }
+        if (attempt >= MAX_RETRIES) {
             return false;
         }
     }
-    else {
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        MY_SPDLOG_DEBUG("Disabled SSL verification for HTTP");
-    }
+}
 
-    if (data && dataSize > 0) {
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data);
-        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, dataSize);
+bool HttpClient::checkResult(const HttpTransferResult& result, const std::string& path) {
+    if (CURLE_OK != result.code) {
+        MY_SPDLOG_WARN("CURL error: {} ({}), path: {}", curl_easy_strerror(result.code), result.error, path);
+        return false;
     }
-
-    char errorBuffer[CURL_ERROR_SIZE] = { 0 };
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorBuffer);
-
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, TRANSFER_TIMEOUT);
-
-    int retryCount = 0;
-    bool shouldRetry = false;
-
-    do {
-        shouldRetry = false;
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-
-        // 错误分类处理
-        if (res != CURLE_OK) {
-            MY_SPDLOG_WARN("CURL error: {} ({}), attempt {}/{}",
-                          curl_easy_strerror(res), errorBuffer, retryCount + 1, MAX_RETRIES);
-
-            // 可重试的错误类型
-            if (res == CURLE_COULDNT_CONNECT ||     // 连接失败
-                res == CURLE_OPERATION_TIMEDOUT ||  // 超时
-                res == CURLE_SEND_ERROR ||          // 发送中断
-                res == CURLE_RECV_ERROR) {          // 接收中断
-                shouldRetry = true;
-                retryCount++;
-
-                // 指数退避重试
-                //std::this_thread::sleep_for(std::chrono::seconds(1 << retryCount));
-            }
-            else {
-                // 不可恢复的错误
-                MY_SPDLOG_ERROR("Non-recoverable error: {} ({})",
-                               curl_easy_strerror(res), errorBuffer);
-                curl_slist_free_all(headers);
-                return false;
-            }
-        }
-    } while (shouldRetry && retryCount < MAX_RETRIES);
     // 处理HTTP协议级错误
-    if (httpCode != 200) {
-        MY_SPDLOG_ERROR("HTTP error: {}, Response: {}", httpCode, response);
+    if (result.httpCode != 200) {
+        MY_SPDLOG_ERROR("HTTP error: {}, Response: {}", result.httpCode, result.response);
+
+        // 旧服务端没有批量接口，之后退回单条上传
+        if (path == "/client/risk/uploadBatch" &&
+            (result.httpCode == 404 || result.httpCode == 405 || result.httpCode == 415 || result.httpCode == 501)) {
+            MY_SPDLOG_WARN("server does not support batch upload, fall back to single uploads");
+            m_batchSupported.store(false);
+        }
 
         // 特殊处理401/403等认证错误
-        if (httpCode == 401 || httpCode == 403) {
+        if (result.httpCode == 401 || result.httpCode == 403) {
             MY_SPDLOG_CRITICAL("Authentication failure, check credentials");
         }
         return false;
     }
 
-    return parseResponse(response, path);
+    return parseResponse(result.response, path);
 }
 
 bool HttpClient::parseResponse(const std::string& response, const std::string& path) {
@@ -254,6 +376,7 @@ bool HttpClient::parseResponse(const std::string& response, const std::string& p
         return false;
     }
 
+    std::lock_guard<std::mutex> lock(m_mutex);
     if (path == "/client/activate") {
         m_licenseKey = root["data"]["key"].asString();
     }
@@ -268,174 +391,16 @@ bool HttpClient::parseResponse(const std::string& response, const std::string& p
     return true;
 }
 
-bool HttpClient::uploadFile(const std::filesystem::path& filePath) {
-    // 设置 HTTP 请求头
-    std::vector<std::string> headers = {
-        "Content-Type: application/octet-stream",
-        "Expect:"
-    };
-
-    // 初始化 CURL
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        MY_SPDLOG_ERROR("Failed to initialize CURL handle");
-        return false;
-    }
-
-    // 加锁，确保线程安全
-    std::lock_guard<std::mutex> lock(m_mutex);
-
-    // 调用私有函数处理文件上传
-    bool result = performFileRequest(curl, "/client/risk/upload", filePath, headers);
-
-    // 清理 CURL
-    curl_easy_cleanup(curl);
-    return result;
-}
-
-static FILE* openFile(const std::filesystem::path& filePath, const char* mode) {
-#ifdef _WIN32
-    return _wfopen(filePath.c_str(), L"rb"); // Windows 使用宽字符版本
-#else
-    return fopen(filePath.c_str(), mode); // Linux/Mac 使用标准版本
-#endif
-}
-
-bool HttpClient::performFileRequest(CURL* curl, const std::string& path, const std::filesystem::path& filePath,
-    const std::vector<std::string>& extraHeaders) {
-    // 构造完整的 URL
-    std::string url = m_baseUrl + path;
-    std::string response;
-    long httpCode = 0;
-
-    struct curl_slist* headers = buildCommonHeaders();
-
-    // 添加额外的请求头
-    for (const auto& h : extraHeaders) {
-        headers = curl_slist_append(headers, h.c_str());
-    }
-
-    // 设置 CURL 选项
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-
-    // 处理 HTTPS
-    bool isHTTPS = false;
-    size_t pos = url.find("://");
-    if (pos != std::string::npos) {
-        std::string scheme = url.substr(0, pos);
-        std::transform(scheme.begin(), scheme.end(), scheme.begin(), ::tolower);
-        isHTTPS = (scheme == "https");
-    }
-    else {
-        MY_SPDLOG_WARN("Invalid URL format: {}", url);
-    }
-
-    // 设置 SSL 验证
-    if (isHTTPS) {
-        if (!m_certPath.empty()) {
-            curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L);
-            curl_easy_setopt(curl, CURLOPT_CAINFO, m_certPath.c_str());
-            MY_SPDLOG_DEBUG("Using SSL verification with cert: {}", m_certPath);
-        }
-        else {
-            MY_SPDLOG_ERROR("HTTPS requires certificate file");
-            return false;
-        }
-    }
-    else {
-        curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-        MY_SPDLOG_TRACE("Disabled SSL verification for HTTP");
-    }
-
-    // 打开文件
-    FILE* file = openFile(filePath.string().c_str(), "rb");
-    if (!file) {
-        MY_SPDLOG_ERROR("Failed to open file: {}", filePath.string());
-        curl_slist_free_all(headers);
-        return false;
-    }
-
-    // 获取文件大小
-    fseek(file, 0, SEEK_END);
-    long fileSize = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    // 设置文件上传选项
-    curl_easy_setopt(curl, CURLOPT_POST, 1L);
-    curl_easy_setopt(curl, CURLOPT_READFUNCTION, fread);
-    curl_easy_setopt(curl, CURLOPT_READDATA, file);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(fileSize));
-
-    // 设置错误缓冲区
-    char errorBuffer[CURL_ERROR_SIZE] = { 0 };
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, errorBuffer);
-
-    // 设置超时
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, TRANSFER_TIMEOUT);
-
-    // 重试逻辑
-    int retryCount = 0;
-    bool shouldRetry = false;
-    do {
-        shouldRetry = false;
-        CURLcode res = curl_easy_perform(curl);
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
-
-        if (res != CURLE_OK) {
-            MY_SPDLOG_WARN("CURL error: {} ({}), attempt {}/{}",
-                          curl_easy_strerror(res), errorBuffer, retryCount + 1, MAX_RETRIES);
-
-            // 可重试的错误
-            if (res == CURLE_COULDNT_CONNECT ||
-                res == CURLE_OPERATION_TIMEDOUT ||
-                res == CURLE_SEND_ERROR ||
-                res == CURLE_RECV_ERROR) {
-                shouldRetry = true;
-                retryCount++;
-            }
-            else {
-                // 不可恢复的错误
-                MY_SPDLOG_ERROR("Non-recoverable error: {} ({})",
-                               curl_easy_strerror(res), errorBuffer);
-                fclose(file);
-                curl_slist_free_all(headers);
-                return false;
-            }
-        }
-    } while (shouldRetry && retryCount < MAX_RETRIES);
-
-    // 关闭文件
-    fclose(file);
-
-    // 处理 HTTP 错误
-    if (httpCode != 200) {
-        MY_SPDLOG_ERROR("HTTP error: {}, Response: {}", httpCode, response);
-        if (httpCode == 401 || httpCode == 403) {
-            MY_SPDLOG_CRITICAL("Authentication failure, check credentials");
-        }
-        curl_slist_free_all(headers);
-        return false;
-    }
-
-    // 解析响应
-    curl_slist_free_all(headers);
-    return parseResponse(response, path);
-}
-
-curl_slist* HttpClient::buildCommonHeaders() const {
+std::vector<std::string> HttpClient::buildCommonHeaders() const {
     auto timestamp = std::chrono::duration_cast<std::chrono::seconds>(
     std::chrono::system_clock::now().time_since_epoch()).count();
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, ("x-version: " + m_version).c_str());
-    headers = curl_slist_append(headers, ("x-computer-name: " + m_computerName).c_str());
-    headers = curl_slist_append(headers, ("x-user-name: " + m_userName).c_str());
-    headers = curl_slist_append(headers, ("x-mac: " + m_macAddress).c_str());
-    headers = curl_slist_append(headers, ("x-company-code: " + m_companyCode).c_str());
-    headers = curl_slist_append(headers, ("x-ca-timestamp: " + std::to_string(timestamp)).c_str());
-    return headers;
+    return {
+        "x-version: " + m_version,
+        "x-computer-name: " + m_computerName,
+        "x-user-name: " + m_userName,
+        "x-mac: " + m_macAddress,
+        "x-company-code: " + m_companyCode,
+        "x-ca-timestamp: " + std::to_string(timestamp),
+    };
 }
@@ -17,6 +17,10 @@
 #ifndef HTTP_CLIENT_H
 #define HTTP_CLIENT_H
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 #include <mutex>
@@ -25,8 +29,19 @@
 #include <json/json.h>
 #include <curl/curl.h>
 
+#include "EvidenceBatch.h"
+#include "HttpTransferEngine.h"
+
+/**
+ * HttpClient - 服务端接口封装
+ * 所有请求都交给HttpTransferEngine的I/O线程执行：同步接口提交后等待结果，
+ * 激活、拉配置等控制面请求走urgent通道，不会排在慢速上传后面；上传另有异步接口，
+ * 可以同时保持多个上传在途。m_mutex只保护参数和响应结果，不跨越网络传输
+ */
 class HttpClient {
 public:
+    using UploadCallback = std::function<void(bool success, bool cancelled)>;
+
     static HttpClient* getInstance();
 
     void setHttpClientParam(const std::string& computerName, const std::string& userName,
@@ -39,6 +54,25 @@ public:
     bool requestConfig();
     bool uploadFile(const std::filesystem::path& filePath);
 
+    // 异步上传，回调在传输I/O线程调用；返回传输id，0表示未能提交(回调不会被调用)
+    uint64_t uploadPicDataAsync(std::shared_ptr<const std::vector<uint8_t>> data, UploadCallback callback);
+    // data指向owner持有的内存(如mmap的段文件)，传输结束前不拷贝也不释放
+    uint64_t uploadPicDataAsync(const uint8_t* data, size_t size, std::shared_ptr<const void> owner,
+        UploadCallback callback);
+    uint64_t uploadFileAsync(const std::filesystem::path& filePath, UploadCallback callback);
+    // 批量上传，请求体由batch流式生成；服务端不支持批量接口时isBatchUploadSupported变为false
+    uint64_t uploadBatchAsync(std::shared_ptr<EvidenceBatchWriter> batch, UploadCallback callback);
+    bool isBatchUploadSupported() const { return m_batchSupported.load(); }
+    bool cancelTransfer(uint64_t id);
+    // 同时在途的上传数量，控制面请求不受限制
+    void setMaxConcurrentUploads(int32_t maxConcurrency);
+    // 单个上传传输的发送速率上限(CURLOPT_MAX_SEND_SPEED_LARGE)，<=0不限速；不影响控制面请求
+    void setMaxUploadSpeed(int64_t bytesPerSec);
+    HttpTransferStats getTransferStats() const;
+
+    // 关闭后每个请求新建连接、不共享缓存(旧行为)，供基准对比
+    void setConnectionReuse(bool enable);
+
     std::string getLicenseKey() const;
     std::string getLicenseUnKey() const;
     std::string getConfig() const;
@@ -50,13 +84,21 @@ private:
     HttpClient(const HttpClient&) = delete;
     HttpClient& operator=(const HttpClient&) = delete;
 
-    static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* output);
-    bool performRequest(CURL* curl, const std::string& path, const char* data,
-                       size_t dataSize, const std::vector<std::string>& extraHeaders);
+    // 在调用线程生成请求，请求头和证书等参数取当前快照；HTTPS缺少证书时返回false
+    bool buildRequest(const std::string& path, const std::vector<std::string>& extraHeaders,
+        HttpTransferRequest& request) const;
+    // 提交到传输引擎并等待结果
+    bool performRequest(const HttpTransferRequest& request, const std::string& path);
+    // 检查curl/HTTP错误并解析响应
+    bool checkResult(const HttpTransferResult& result, const std::string& path);
     bool parseResponse(const std::string& response, const std::string& path);
-    bool performFileRequest(CURL* curl, const std::string& path, const std::filesystem::path& filePath,
-        const std::vector<std::string>& extraHeaders);
-    struct curl_slist* buildCommonHeaders() const;
+    std::vector<std::string> buildCommonHeaders() const;
+    uint64_t submitUpload(const std::string& path, HttpTransferRequest&& request, UploadCallback callback);
+
+    // 设置超时、SSL、HTTP/2和共享缓存等公共选项，在I/O线程调用
+    static void configureHandle(CURL* curl, const std::string& certPath, bool https, bool reuse, CURLSH* share);
+    static void shareLock(CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr);
+    static void shareUnlock(CURL* handle, curl_lock_data data, void* userptr);
 
     std::string m_computerName{ "" };
     std::string m_userName = "";
@@ -70,6 +112,14 @@ private:
     std::string m_configCfg{ "" };
     std::string m_configChecksums{ "" };
     mutable std::mutex m_mutex;
+
+    bool m_reuseConnections{ true };
+    std::atomic_bool m_batchSupported{ true };
+    std::atomic<int64_t> m_maxUploadSpeed{ 0 };
+
+    CURLSH* m_share{ nullptr };
+    std::array<std::mutex, CURL_LOCK_DATA_LAST> m_shareMtx;
+    HttpTransferEngine m_engine;
 private:
     static constexpr int MAX_RETRIES = 1;      // 最大重试次数
     static constexpr int CONNECT_TIMEOUT = 1; // 连接超时(秒)
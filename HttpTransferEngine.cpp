@@ -0,0 +1,390 @@
+#include <algorithm>
+#include <cstdio>
+
+#include "HttpTransferEngine.h"
+#include "MyLogger.hpp"
+
+namespace {
+
+FILE* openFile(const std::filesystem::path& filePath) {
+#ifdef _WIN32
+    return _wfopen(filePath.c_str(), L"rb"); // Windows 使用宽字符版本
+#else
+    return fopen(filePath.c_str(), "rb");
+#endif
+}
+
+} // namespace
+
+HttpTransferEngine::~HttpTransferEngine() {
+    stop();
+}
+
+bool HttpTransferEngine::start() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_running.load()) {
+        return true;
+    }
+    m_multi = curl_multi_init();
+    if (!m_multi) {
+        MY_SPDLOG_ERROR("Failed to initialize CURL multi handle");
+        return false;
+    }
+#if LIBCURL_VERSION_NUM >= 0x074200
+    // 服务端协商到HTTP/2时多个上传复用同一连接
+    curl_multi_setopt(m_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+#endif
+    m_running.store(true);
+    m_ioThd = std::thread(&HttpTransferEngine::ioLoop, this);
+    return true;
+}
+
+void HttpTransferEngine::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (!m_running.load()) {
+            return;
+        }
+        m_running.store(false);
+    }
+    wakeup();
+    if (m_ioThd.joinable()) {
+        m_ioThd.join();
+    }
+    for (CURL* curl : m_freeHandles) {
+        curl_easy_cleanup(curl);
+    }
+    m_freeHandles.clear();
+    std::lock_guard<std::mutex> lock(m_mtx);
+    curl_multi_cleanup(m_multi);
+    m_multi = nullptr;
+}
+
+void HttpTransferEngine::setMaxConcurrency(int32_t maxConcurrency) {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_maxConcurrency = (std::max)(1, maxConcurrency);
+    }
+    wakeup();
+}
+
+uint64_t HttpTransferEngine::submit(HttpTransferRequest request, CompletionCallback callback) {
+    auto transfer = std::make_unique<Transfer>();
+    transfer->request = std::move(request);
+    transfer->callback = std::move(callback);
+    uint64_t id = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (!m_running.load()) {
+            return 0;
+        }
+        id = m_nextId++;
+        transfer->id = id;
+        m_liveIds.insert(id);
+        ++m_stats.submitted;
+        (transfer->request.urgent ? m_urgent : m_pending).emplace_back(std::move(transfer));
+    }
+    wakeup();
+    return id;
+}
+
+std::future<HttpTransferResult> HttpTransferEngine::submit(HttpTransferRequest request) {
+    auto promise = std::make_shared<std::promise<HttpTransferResult>>();
+    std::future<HttpTransferResult> future = promise->get_future();
+    const uint64_t id = submit(std::move(request), [promise](HttpTransferResult&& result) {
+        promise->set_value(std::move(result));
+    });
+    if (0 == id) {
+        HttpTransferResult result;
+        result.code = CURLE_FAILED_INIT;
+        result.cancelled = true;
+        result.error = "transfer engine not running";
+        promise->set_value(std::move(result));
+    }
+    return future;
+}
+
+bool HttpTransferEngine::cancel(uint64_t id) {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (0 == m_liveIds.count(id)) {
+            return false;
+        }
+        m_cancelIds.push_back(id);
+    }
+    wakeup();
+    return true;
+}
+
+HttpTransferStats HttpTransferEngine::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    HttpTransferStats stats = m_stats;
+    stats.pending = m_urgent.size() + m_pending.size();
+    return stats;
+}
+
+void HttpTransferEngine::wakeup() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+#if LIBCURL_VERSION_NUM >= 0x074400
+    if (m_multi) {
+        curl_multi_wakeup(m_multi);
+    }
+#endif
+    m_cond.notify_all();
+}
+
+size_t HttpTransferEngine::writeCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
+    size_t total = size * nmemb;
+    output->append(static_cast<char*>(contents), total);
+    return total;
+}
+
+size_t HttpTransferEngine::readCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+    return static_cast<Transfer*>(userdata)->request.bodyReader(buffer, size * nitems);
+}
+
+CURL* HttpTransferEngine::acquireHandle() {
+    if (!m_freeHandles.empty()) {
+        CURL* curl = m_freeHandles.back();
+        m_freeHandles.pop_back();
+        curl_easy_reset(curl);
+        return curl;
+    }
+    return curl_easy_init();
+}
+
+void HttpTransferEngine::releaseHandle(CURL* curl) {
+    if (m_freeHandles.size() < MAX_FREE_HANDLES) {
+        m_freeHandles.push_back(curl);
+        return;
+    }
+    curl_easy_cleanup(curl);
+}
+
+bool HttpTransferEngine::startTransfer(Transfer& transfer, std::string& error) {
+    transfer.curl = acquireHandle();
+    if (!transfer.curl) {
+        error = "Failed to initialize CURL handle";
+        return false;
+    }
+    CURL* curl = transfer.curl;
+    const HttpTransferRequest& request = transfer.request;
+    for (const auto& h : request.headers) {
+        transfer.headers = curl_slist_append(transfer.headers, h.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer.headers);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer.response);
+    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, transfer.errorBuffer);
+
+    if (request.bodyReader) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, readCallback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, &transfer);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.bodyReaderSize));
+    }
+    else if (!request.filePath.empty()) {
+        transfer.file = openFile(request.filePath);
+        if (!transfer.file) {
+            error = "Failed to open file: " + request.filePath.string();
+            return false;
+        }
+        fseek(transfer.file, 0, SEEK_END);
+        const long fileSize = ftell(transfer.file);
+        fseek(transfer.file, 0, SEEK_SET);
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, fread);
+        curl_easy_setopt(curl, CURLOPT_READDATA, transfer.file);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(fileSize));
+    }
+    else if (request.body && request.bodySize > 0) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.bodySize));
+    }
+    if (request.configure) {
+        request.configure(curl);
+    }
+
+    transfer.begin = std::chrono::steady_clock::now();
+    const CURLMcode mc = curl_multi_add_handle(m_multi, curl);
+    if (CURLM_OK != mc) {
+        error = curl_multi_strerror(mc);
+        return false;
+    }
+    return true;
+}
+
+void HttpTransferEngine::finishTransfer(TransferPtr transfer, CURLcode code, bool cancelled, std::string error,
+    std::vector<std::pair<CompletionCallback, HttpTransferResult>>& done) {
+    HttpTransferResult result;
+    result.id = transfer->id;
+    result.code = code;
+    result.cancelled = cancelled;
+    if (transfer->curl) {
+        curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &result.httpCode);
+        if (error.empty() && CURLE_OK != code) {
+            error = transfer->errorBuffer[0] ? transfer->errorBuffer : curl_easy_strerror(code);
+        }
+        releaseHandle(transfer->curl);
+    }
+    if (transfer->headers) {
+        curl_slist_free_all(transfer->headers);
+    }
+    if (transfer->file) {
+        fclose(transfer->file);
+    }
+    if (transfer->begin.time_since_epoch().count() > 0) {
+        result.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - transfer->begin);
+    }
+    result.response = std::move(transfer->response);
+    result.error = std::move(error);
+    CompletionCallback callback = std::move(transfer->callback);
+    // 回调前释放请求体，调用方在回调中可以安全地收回缓冲
+    transfer.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_liveIds.erase(result.id);
+        ++m_stats.completed;
+        if (cancelled) {
+            ++m_stats.cancelled;
+        }
+        else if (CURLE_OK != code || 200 != result.httpCode) {
+            ++m_stats.failed;
+        }
+        m_stats.active = m_active.size();
+    }
+    done.emplace_back(std::move(callback), std::move(result));
+}
+
+void HttpTransferEngine::ioLoop() {
+    MY_SPDLOG_DEBUG(">>>");
+    std::vector<std::pair<CompletionCallback, HttpTransferResult>> done;
+    while (true) {
+        std::vector<TransferPtr> toStart;
+        std::vector<TransferPtr> cancelledQueued;
+        std::vector<uint64_t> cancelIds;
+        bool running = true;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            running = m_running.load();
+            cancelIds.swap(m_cancelIds);
+            // 排队中的传输被取消时不必进入multi，直接完成
+            for (auto* queue : { &m_urgent, &m_pending }) {
+                for (auto it = queue->begin(); it != queue->end();) {
+                    if (!running || cancelIds.end() != std::find(cancelIds.begin(), cancelIds.end(), (*it)->id)) {
+                        cancelledQueued.emplace_back(std::move(*it));
+                        it = queue->erase(it);
+                    }
+                    else {
+                        ++it;
+                    }
+                }
+            }
+            while (!m_urgent.empty()) {
+                toStart.emplace_back(std::move(m_urgent.front()));
+                m_urgent.pop_front();
+            }
+            size_t bulk = m_activeBulk;
+            while (!m_pending.empty() && bulk < static_cast<size_t>(m_maxConcurrency)) {
+                toStart.emplace_back(std::move(m_pending.front()));
+                m_pending.pop_front();
+                ++bulk;
+            }
+        }
+
+        for (auto& transfer : cancelledQueued) {
+            finishTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK, true, "cancelled", done);
+        }
+        // 在途的传输从multi中移除即中止，连接随之关闭
+        for (auto it = m_active.begin(); it != m_active.end();) {
+            const uint64_t id = it->second->id;
+            if (running && cancelIds.end() == std::find(cancelIds.begin(), cancelIds.end(), id)) {
+                ++it;
+                continue;
+            }
+            curl_multi_remove_handle(m_multi, it->first);
+            TransferPtr transfer = std::move(it->second);
+            m_activeBulk -= transfer->request.urgent ? 0 : 1;
+            it = m_active.erase(it);
+            finishTransfer(std::move(transfer), CURLE_ABORTED_BY_CALLBACK, true, "cancelled", done);
+        }
+        for (auto& transfer : toStart) {
+            std::string error;
+            if (!startTransfer(*transfer, error)) {
+                MY_SPDLOG_ERROR("start transfer {} failed: {}", transfer->request.url, error);
+                finishTransfer(std::move(transfer), CURLE_FAILED_INIT, false, error, done);
+                continue;
+            }
+            m_activeBulk += transfer->request.urgent ? 0 : 1;
+            CURL* curl = transfer->curl;
+            m_active.emplace(curl, std::move(transfer));
+        }
+        if (!toStart.empty()) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_stats.active = m_active.size();
+            m_stats.peakActive = (std::max)(m_stats.peakActive, m_active.size());
+        }
+
+        if (!m_active.empty()) {
+            int stillRunning = 0;
+            curl_multi_perform(m_multi, &stillRunning);
+            int queued = 0;
+            while (CURLMsg* msg = curl_multi_info_read(m_multi, &queued)) {
+                if (CURLMSG_DONE != msg->msg) {
+                    continue;
+                }
+                // remove之后msg失效，先取出结果
+                CURL* curl = msg->easy_handle;
+                const CURLcode code = msg->data.result;
+                curl_multi_remove_handle(m_multi, curl);
+                auto it = m_active.find(curl);
+                if (m_active.end() == it) {
+                    continue;
+                }
+                TransferPtr transfer = std::move(it->second);
+                m_activeBulk -= transfer->request.urgent ? 0 : 1;
+                m_active.erase(it);
+                finishTransfer(std::move(transfer), code, false, "", done);
+            }
+        }
+
+        for (auto& item : done) {
+            if (!item.first) {
+                continue;
+            }
+            try {
+                item.first(std::move(item.second));
+            }
+            catch (const std::exception& e) {
+                MY_SPDLOG_ERROR("transfer {} callback exception: {}", item.second.id, e.what());
+            }
+        }
+        const bool delivered = !done.empty();
+        done.clear();
+
+        if (!running) {
+            break;
+        }
+        if (delivered) {
+            // 回调里可能提交了新传输或释放了并发额度，先处理再等待
+            continue;
+        }
+#if LIBCURL_VERSION_NUM >= 0x074400
+        curl_multi_poll(m_multi, nullptr, 0, POLL_TIMEOUT_MS, nullptr);
+#else
+        if (m_active.empty()) {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_cond.wait_for(lock, std::chrono::milliseconds(POLL_TIMEOUT_MS), [this] {
+                return !m_running.load() || !m_cancelIds.empty() || !m_urgent.empty() || !m_pending.empty();
+            });
+        }
+        else {
+            curl_multi_wait(m_multi, nullptr, 0, 50, nullptr);
+        }
+#endif
+    }
+    MY_SPDLOG_DEBUG("<<<");
+}
@@ -0,0 +1,134 @@
+#ifndef HTTP_TRANSFER_ENGINE_H
+#define HTTP_TRANSFER_ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <curl/curl.h>
+
+struct HttpTransferRequest {
+    std::string url;
+    std::vector<std::string> headers;
+    const char* body{ nullptr };            // body和filePath都为空时发GET
+    size_t bodySize{ 0 };
+    std::shared_ptr<const void> bodyOwner;  // 异步提交时持有body所在缓冲直到传输结束
+    std::filesystem::path filePath;         // 非空时从文件读取请求体
+    std::function<size_t(char*, size_t)> bodyReader;  // 非空时流式生成请求体，返回CURL_READFUNC_ABORT中止
+    uint64_t bodyReaderSize{ 0 };
+    bool urgent{ false };                   // 控制面请求：立即发起，不占并发额度
+    std::function<void(CURL*)> configure;   // 发起前在I/O线程调用，设置SSL、超时、共享缓存等
+};
+
+struct HttpTransferResult {
+    uint64_t id{ 0 };
+    CURLcode code{ CURLE_OK };
+    long httpCode{ 0 };
+    bool cancelled{ false };
+    std::string response;
+    std::string error;
+    std::chrono::milliseconds elapsed{ 0 };
+};
+
+struct HttpTransferStats {
+    uint64_t submitted{ 0 };
+    uint64_t completed{ 0 };
+    uint64_t failed{ 0 };                   // curl错误或非200
+    uint64_t cancelled{ 0 };
+    size_t active{ 0 };
+    size_t pending{ 0 };
+    size_t peakActive{ 0 };
+};
+
+/**
+ * HttpTransferEngine - 基于curl_multi的异步传输引擎
+ * 单个I/O线程驱动所有传输；普通请求按maxConcurrency限制同时在途数量，超出的排队，
+ * urgent请求(激活、拉配置等)立即发起，不会被慢速上传阻塞。
+ * 完成回调在I/O线程调用，回调内不要做耗时操作；取消的传输也会回调，cancelled为true
+ */
+class HttpTransferEngine {
+public:
+    using CompletionCallback = std::function<void(HttpTransferResult&&)>;
+
+    HttpTransferEngine() = default;
+    ~HttpTransferEngine();
+
+    bool start();
+    // 取消全部排队和在途的传输(逐个回调)后退出I/O线程
+    void stop();
+
+    void setMaxConcurrency(int32_t maxConcurrency);
+
+    // 返回传输id，0表示引擎未运行，此时回调不会被调用
+    uint64_t submit(HttpTransferRequest request, CompletionCallback callback);
+    std::future<HttpTransferResult> submit(HttpTransferRequest request);
+    // 排队或在途时返回true，完成回调随后以cancelled=true调用
+    bool cancel(uint64_t id);
+
+    HttpTransferStats getStats() const;
+
+private:
+    HttpTransferEngine(const HttpTransferEngine&) = delete;
+    HttpTransferEngine& operator=(const HttpTransferEngine&) = delete;
+
+    struct Transfer {
+        uint64_t id{ 0 };
+        HttpTransferRequest request;
+        CompletionCallback callback;
+        CURL* curl{ nullptr };
+        struct curl_slist* headers{ nullptr };
+        FILE* file{ nullptr };
+        std::string response;
+        char errorBuffer[CURL_ERROR_SIZE] = { 0 };
+        std::chrono::steady_clock::time_point begin;
+    };
+    using TransferPtr = std::unique_ptr<Transfer>;
+
+    static size_t writeCallback(void* contents, size_t size, size_t nmemb, std::string* output);
+    static size_t readCallback(char* buffer, size_t size, size_t nitems, void* userdata);
+
+    void ioLoop();
+    void wakeup();
+    // 以下仅在I/O线程调用
+    bool startTransfer(Transfer& transfer, std::string& error);
+    void finishTransfer(TransferPtr transfer, CURLcode code, bool cancelled, std::string error,
+        std::vector<std::pair<CompletionCallback, HttpTransferResult>>& done);
+    CURL* acquireHandle();
+    void releaseHandle(CURL* curl);
+
+private:
+    mutable std::mutex m_mtx;
+    std::condition_variable m_cond;         // 旧版libcurl没有curl_multi_wakeup时用于空闲等待
+    std::thread m_ioThd;
+    std::atomic_bool m_running{ false };
+    CURLM* m_multi{ nullptr };
+
+    int32_t m_maxConcurrency{ 3 };
+    uint64_t m_nextId{ 1 };
+    std::deque<TransferPtr> m_urgent;
+    std::deque<TransferPtr> m_pending;
+    std::unordered_set<uint64_t> m_liveIds;  // 排队或在途的传输
+    std::vector<uint64_t> m_cancelIds;
+    HttpTransferStats m_stats;
+
+    // I/O线程私有
+    std::unordered_map<CURL*, TransferPtr> m_active;
+    size_t m_activeBulk{ 0 };
+    std::vector<CURL*> m_freeHandles;
+
+    static constexpr size_t MAX_FREE_HANDLES = 8;
+    static constexpr int POLL_TIMEOUT_MS = 1000;
+};
+
+#endif // HTTP_TRANSFER_ENGINE_H
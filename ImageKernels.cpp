@@ -0,0 +1,90 @@
+#include "ImageKernels.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ImageKernels {
+
+int32_t fitDownscaleFactor(int32_t width, int32_t height, int32_t maxWidth, int32_t maxHeight) {
+    int32_t factor = 1;
+    if (maxWidth > 0 && width > maxWidth) {
+        factor = (std::max)(factor, (width + maxWidth - 1) / maxWidth);
+    }
+    if (maxHeight > 0 && height > maxHeight) {
+        factor = (std::max)(factor, (height + maxHeight - 1) / maxHeight);
+    }
+    return factor;
+}
+
+void downscaleBgraToBgr(const cv::Mat& src, cv::Mat& dst, int32_t factor) {
+    CV_Assert(src.type() == CV_8UC4 && factor >= 1 && factor <= 16);
+    const int outW = src.cols / factor;
+    const int outH = src.rows / factor;
+    dst.create(outH, outW, CV_8UC3);
+    if (outW <= 0 || outH <= 0) {
+        return;
+    }
+
+    // factor<=16时块内和不超过 255*256，用uint32累加；除法换成乘以定点倒数
+    const uint32_t area = static_cast<uint32_t>(factor * factor);
+    const uint32_t invArea = (1u << 16) / area;
+    const uint32_t rounding = 1u << 15;
+
+    thread_local std::vector<uint32_t> acc;
+    acc.assign(static_cast<size_t>(outW) * 3, 0);
+
+    for (int oy = 0; oy < outH; ++oy) {
+        std::fill(acc.begin(), acc.end(), 0u);
+        uint32_t* accPtr = acc.data();
+        for (int dy = 0; dy < factor; ++dy) {
+            const uint8_t* row = src.ptr<uint8_t>(oy * factor + dy);
+            if (2 == factor) {
+                // 最常见的Retina/4K缩半，展开内层循环
+                for (int ox = 0; ox < outW; ++ox) {
+                    const uint8_t* p = row + ox * 8;
+                    accPtr[ox * 3 + 0] += static_cast<uint32_t>(p[0]) + p[4];
+                    accPtr[ox * 3 + 1] += static_cast<uint32_t>(p[1]) + p[5];
+                    accPtr[ox * 3 + 2] += static_cast<uint32_t>(p[2]) + p[6];
+                }
+            }
+            else {
+                for (int ox = 0; ox < outW; ++ox) {
+                    const uint8_t* p = row + ox * factor * 4;
+                    uint32_t b = 0, g = 0, r = 0;
+                    for (int dx = 0; dx < factor; ++dx) {
+                        b += p[dx * 4 + 0];
+                        g += p[dx * 4 + 1];
+                        r += p[dx * 4 + 2];
+                    }
+                    accPtr[ox * 3 + 0] += b;
+                    accPtr[ox * 3 + 1] += g;
+                    accPtr[ox * 3 + 2] += r;
+                }
+            }
+        }
+        uint8_t* out = dst.ptr<uint8_t>(oy);
+        const int outLen = outW * 3;
+        for (int i = 0; i < outLen; ++i) {
+            out[i] = static_cast<uint8_t>((accPtr[i] * invArea + rounding) >> 16);
+        }
+    }
+}
+
+bool fitEvidence(const cv::Mat& src, cv::Mat& dst, int32_t maxWidth, int32_t maxHeight) {
+    if (src.empty()) {
+        return false;
+    }
+    const int32_t factor = fitDownscaleFactor(src.cols, src.rows, maxWidth, maxHeight);
+    if (factor <= 1) {
+        return false;
+    }
+    if (src.type() == CV_8UC4 && factor <= 16) {
+        downscaleBgraToBgr(src, dst, factor);
+    }
+    else {
+        cv::resize(src, dst, cv::Size(src.cols / factor, src.rows / factor), 0, 0, cv::INTER_AREA);
+    }
+    return true;
+}
+
+} // namespace ImageKernels
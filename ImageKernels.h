@@ -0,0 +1,27 @@
+#ifndef IMAGE_KERNELS_H
+#define IMAGE_KERNELS_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+namespace ImageKernels {
+
+// 计算使宽高都不超过上限的最小整数缩小倍数，上限<=0表示不限制
+int32_t fitDownscaleFactor(int32_t width, int32_t height, int32_t maxWidth, int32_t maxHeight);
+
+/**
+ * BGRA(CV_8UC4)按factor x factor块求平均缩小并同时丢弃alpha输出BGR(CV_8UC3)，
+ * 一次遍历完成颜色转换和缩放。dst尺寸不变时复用其内存。
+ * 行内循环为连续内存的定长整数运算，编译器可自动向量化
+ */
+void downscaleBgraToBgr(const cv::Mat& src, cv::Mat& dst, int32_t factor);
+
+/**
+ * 将证据图片缩到maxWidth x maxHeight以内：
+ * BGRA走downscaleBgraToBgr，其余类型用INTER_AREA；无需缩小时返回false且不写dst
+ */
+bool fitEvidence(const cv::Mat& src, cv::Mat& dst, int32_t maxWidth, int32_t maxHeight);
+
+} // namespace ImageKernels
+
+#endif // IMAGE_KERNELS_H
@@ -33,7 +33,23 @@
 #include "PicFileUploader.h"
 #include "MyMeta.h"
 #include "ConfigParser.h"
+#include "LatestFrameMailbox.h"
+#include "DetectScheduler.h"
+#include "FramePool.h"
+#include "CaptureSource.h"
+#include "TemporalVoter.h"
+#include "AlertRuleEngine.h"
+#include "AlertEventQueue.h"
+#include "OcclusionAnalyzer.h"
+#include "EvidenceDeduper.h"
+#include "ReplayReport.h"
 
+// 采集线程发布给检测线程的帧
+struct CapturedFrame {
+    FrameHandle frame;
+    std::chrono::steady_clock::time_point captureTime; // grab完成时刻
+    uint64_t seq{ 0 };
+};
 
 
 class ImageProcessor : public IConfigUpdateListener {
@@ -49,9 +65,13 @@ public:
     void setAlertEnables(const bool, const bool, const bool, const bool, const bool);
     void setTestConfigs(const bool testSourcePreview, const std::string &testVideoPath);
     bool getWorkThreadStatus() const;
+    // 多路摄像头时的编号，0为主摄像头(预览、界面计数)，start之前设置
+    void setCameraIndex(int32_t cameraIndex);
+    int32_t getCameraIndex() const { return m_cameraIndex; }
     void setDetectParam(const std::shared_ptr<MyMeta>& meta);
     void setTestParam(const std::shared_ptr<MyMeta>& meta);
-    bool isCameraOccludedByTraditional(cv::InputArray frame);
+    bool isCameraOccludedByTraditional(cv::InputArray frame, double brightnessLow, double brightnessHigh);
+    bool isCameraOccluded(const cv::Mat& frame);
     
     // 获取告警开关状态的方法
     bool getAlertPhoneEnabled() const { return m_alertPhoneEnable; }
@@ -74,14 +94,36 @@ public:
     void setNoFaceLockTimeout(int32_t timeoutMs);
 private:
     void work();
+    void captureWork();
+    bool acquireLatestFrame(FrameHandle& frame, std::chrono::steady_clock::time_point& captureTime);
+    void recordCaptureLatency(const std::chrono::steady_clock::time_point& captureTime);
+    void logSchedulerStats();
+    Json::Value getVoterStats() const;
+    void postAlert(int mode, const FrameHandle& frame, uint32_t actions = 0);
     void alertWork();
     bool openCameraOnce(int32_t cameraId = 0);
     bool openVideoOnce();
     bool openCameraUntilTrue();
+    // ImageProcessor.cpp.windows的证据编码上传，.mm改用saveEvidence
     void saveMatWithEncode(cv::Mat& inMat, const std::string& inFilePath, const std::vector<int>& encParam,
         bool isSuspected);
+    // 一次告警产生的一张证据图片
+    struct EvidenceItem {
+        cv::Mat image;
+        std::string namePrefix;
+        bool isSuspected;
+        UploadPriority priority;
+    };
+    void buildEvidencePacket(const std::string& uploadName, bool isSuspected,
+        const std::vector<uint8_t>& jpegData, std::vector<uint8_t>& outData);
+    void saveEvidence(const std::vector<EvidenceItem>& items, const std::string& dirPath);
     void saveRiskEventFile(const std::string &fileName, const std::string &eventName, const std::string &eventTime);
-    void handleNoFaceLock();
+    void triggerScreenLock();
+    // 调用方持有m_paramMtx写锁
+    void rebuildAlertPolicy();
+    // 调用方持有m_paramMtx写锁；遮挡参数复制一份供检测线程使用
+    void rebuildOcclusionParams();
+    std::shared_ptr<AlertRuleTable> buildLegacyAlertRules() const;
     void processWindowsMessages();
     void writeTestDataToJson();
     void onConfigUpdated(std::shared_ptr<MyMeta>& newMeta);
@@ -95,27 +137,49 @@ private:
     std::thread m_thread;
     std::atomic_bool m_continue{ false };
     std::atomic<bool> m_workThreadStatus{ true };
+    // capture thread
+    FramePool m_framePool;   // 采集/检测/告警线程共享的帧缓冲
+    std::thread m_captureThd;
+    LatestFrameMailbox<CapturedFrame> m_frameMailbox;
+    std::atomic_bool m_frameWanted{ false };   // 检测线程请求解码下一帧
+    std::atomic_bool m_captureFailed{ false };
+    double m_capLatencySumMs{ 0.0 };
+    double m_capLatencyMaxMs{ 0.0 };
+    uint32_t m_capLatencyCnt{ 0 };
+    // 检测节拍
+    DetectScheduler m_detectScheduler;
     // show alert thread
     std::atomic_bool m_alertContinue { false };
     std::thread m_alertThd;
-    std::mutex m_alertMtx;
+    AlertEventQueue m_alertQueue;
+    void* m_hAlertEvent{ nullptr };   // ImageProcessor.cpp.windows告警线程的唤醒事件(HANDLE)，与窗口消息一起等待
     mutable std::shared_mutex m_paramMtx;
     // AlertWindowManager相关成员变量已删除，改用事件机制
-    std::vector<int> m_alertTaskVec;  // 改用int类型存储alert类型
-    int m_lastAlertMode;              // 改用int类型
+    std::atomic<int> m_lastQueuedMode{ -1 }; // 生产者侧最近入队的告警类型，仅在变化时入队
+    int m_lastAlertMode{ -1 };               // 告警线程最近处理的类型
     // other variable
-    std::unique_ptr<cv::VideoCapture> m_cap{ nullptr };
-    cv::Mat m_cameraFrame;
+    std::unique_ptr<cv::VideoCapture> m_cap{ nullptr };   // 测试视频
+    std::unique_ptr<CaptureSource> m_camera{ nullptr };   // 摄像头采集后端
     std::unique_ptr<ScreenShot> m_scrShot{ nullptr };
+    std::vector<uint8_t> m_jpegEncBuf;   // 告警线程复用的JPEG编码缓冲
 
     int32_t m_capInterval{ 300 };
     int32_t m_alertShowInterval{ 500 };
+    int32_t m_cameraRetryBaseMs{ 500 };     // 摄像头重连退避初始间隔
+    int32_t m_cameraRetryMaxMs{ 30000 };    // 摄像头重连退避上限
+    std::string m_captureBackend{ "opencv" };   // opencv / mjpeg / v4l2
+    std::string m_capturePixelFormat{ "mjpeg" };   // v4l2后端像素格式：mjpeg / yuyv / nv12
+    int32_t m_captureWidth{ 1920 };         // mjpeg/v4l2后端向摄像头请求的分辨率
+    int32_t m_captureHeight{ 1080 };
     std::string m_cameraId{ "default_camera" };
+    int32_t m_cameraIndex{ 0 };
+    std::string m_evidenceTag{ "" };   // 证据文件名前缀，区分多路摄像头
     int32_t m_cameraWidth{ 640 };
     int32_t m_cameraHeight{ 640 };
 
     std::string m_cameraName{ "" };
     std::string m_testVideoPath{ "" };
+    std::string m_testPreviewRecordPath{ "" }; // 非空时无界面录制调试画面(MJPEG AVI)
 
     bool m_testSourcePreview{ false };
 
@@ -136,12 +200,11 @@ private:
     bool m_alertNobodyWindowEnable{ false };
     bool m_alertOccludeWindowEnable{ false };
     bool m_alertNobodyLockEnable{ false };
-    bool m_isNoFaceTiming{ false };
 
     bool m_alertNoconnectEnable{ false };
     bool m_alertNoconnectWindowEnable{ false };
 
-    std::chrono::steady_clock::time_point m_noFaceStartTime;
+    std::chrono::steady_clock::time_point m_decisionTime;   // 判定时钟：实时为采集时刻，回放为视频时间轴
     int32_t m_noFaceLockTimeout{ 5000 }; // 默认5秒锁屏
 
     uint8_t m_detNobodyFrameCnt{ 0 };
@@ -149,8 +212,48 @@ private:
     uint64_t m_detNobodyCnt{ 0 };
     uint64_t m_detPeepCnt{ 0 };
     uint64_t m_detPhoneCnt{ 0 };
+    uint64_t m_detLockCnt{ 0 };
+    // 告警时间投票：规则按告警类型下标，受m_paramMtx保护；投票器只在检测线程使用
+    std::vector<TemporalVoter::Rule> m_voteRules;
+    TemporalVoter m_alertVoter;
+    // 告警规则：为空时由各告警开关生成等价规则；编译结果整体原子替换，检测线程不加锁读取
+    std::string m_alertRulesJson{ "" };
+    std::shared_ptr<const AlertRuleTable> m_alertPolicy;
+    AlertRuleEvaluator m_ruleEvaluator;
+    // 证据I/O统计(告警线程写)，用于估算投票省下的证据量
+    std::atomic<uint64_t> m_evidenceAlertCnt{ 0 };
+    std::atomic<uint64_t> m_evidenceFileCnt{ 0 };
+    std::atomic<uint64_t> m_evidenceBytes{ 0 };
+    std::atomic<uint64_t> m_evidenceDedupCnt{ 0 };
     double m_brightnessThresholdLow = 30.01;
     double m_brightnessThresholdHigh = 150.01;
+    int32_t m_occlusionDownsample{ 4 };
+    int32_t m_occlusionGradientThreshold{ 48 };
+    double m_occlusionEdgeRatio{ 0.01 };
+    // 遮挡参数在配置变化时整体原子替换，检测线程不加锁读取；分析器只在检测线程使用
+    std::shared_ptr<const OcclusionAnalyzer::Params> m_occlusionParams;
+    std::shared_ptr<const OcclusionAnalyzer::Params> m_appliedOcclusionParams;
+    OcclusionAnalyzer m_occlusionAnalyzer;
+    // 证据图片：超过上限的截图按整数倍缩小后再编码，<=0不限制
+    int32_t m_evidenceMaxWidth{ 1920 };
+    int32_t m_evidenceMaxHeight{ 1080 };
+    int32_t m_evidenceJpegQuality{ 60 };
+    // 证据近重复过滤：同一告警类型和来源在窗口内与已保留帧的dHash距离不超过阈值时不再编码上传
+    bool m_evidenceDedupEnable{ true };
+    int32_t m_evidenceDedupHamming{ 6 };
+    int32_t m_evidenceDedupWindowMs{ 60000 };
+    EvidenceDeduper m_evidenceDeduper;
+    // 测试模式：新旧遮挡判定对比
+    bool m_testOcclusionCompare{ false };
+    uint64_t m_occlusionCompareCnt{ 0 };
+    uint64_t m_occlusionOnlyNewCnt{ 0 };     // 仅新算法判定遮挡
+    uint64_t m_occlusionOnlyLegacyCnt{ 0 };  // 仅原算法判定遮挡
+    // 测试模式：离线回放基准(不按节拍等待，可选预读线程)
+    bool m_testReplayUnthrottled{ false };
+    bool m_testReplayPrefetch{ true };
+    bool m_testReplayFrameDetail{ true };     // 报告中输出逐帧检测结果
+    std::string m_testReportPath{ "test.json" };
+    ReplayReport m_replayReport;
 };
 
 #endif // IMAGEPROCESSOR_H
@@ -18,6 +18,14 @@
 #include "CommonUtils.h"
 #include "MNNDetector.h"
 #include "PADetectCore.h"
+#include "DebugVisualizer.h"
+#include "JpegEncoderPool.h"
+#include "InferenceScheduler.h"
+#include "VideoPrefetcher.h"
+#include "LatencyStats.h"
+#include "LoadGovernor.h"
+#include "CameraManager.h"
+#include "CaptureSource.h"
 #import "PADetect/PADetectBridge.h"
 
 #include <chrono>
@@ -40,6 +48,36 @@ enum ALERT_TYPE {
     COUNT,
 };
 
+// 告警类型名称，下标与ALERT_TYPE一致；同时用于规则配置和证据文件名前缀
+static const char* const ALERT_TYPE_NAMES[] = { "phone", "peep", "nobody", "occlude", "noconnect", "suspect" };
+
+// 证据上传优先级：手机 > 可疑 > 偷窥 > 无人/遮挡/断连
+static UploadPriority uploadPriorityOf(int32_t alertType) {
+    switch (alertType) {
+    case TEXT_PHONE:
+        return UPLOAD_PRIORITY_PHONE;
+    case TEXT_SUSPECT:
+        return UPLOAD_PRIORITY_SUSPECT;
+    case TEXT_PEEP:
+        return UPLOAD_PRIORITY_PEEP;
+    case TEXT_NOBODY:
+    case TEXT_OCCLUDE:
+    case TEXT_NOCONNECT:
+        return UPLOAD_PRIORITY_ENVIRONMENT;
+    default:
+        return UPLOAD_PRIORITY_BACKLOG;
+    }
+}
+
+static int32_t alertTypeFromName(const std::string& name) {
+    for (int32_t i = 0; i < ALERT_TYPE::COUNT; ++i) {
+        if (name == ALERT_TYPE_NAMES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
 #include <iomanip>
 #include <fstream>
 
@@ -132,26 +170,53 @@ void ImageProcessor::prepare() {
 
 void ImageProcessor::start() {
     m_continue.store(true);
+    m_alertQueue.reset();
+    m_lastQueuedMode.store(-1);
+    // 摄像头模式下由独立采集线程持续读取摄像头，检测线程只取最新帧
+    if (m_testVideoPath.empty()) {
+        m_frameMailbox.reset();
+        m_frameWanted.store(false);
+        m_captureFailed.store(false);
+        m_captureThd = std::thread(&ImageProcessor::captureWork, this);
+    }
+    InferenceScheduler::getInstance()->registerSource();
     m_thread = std::thread(&ImageProcessor::work, this);
 
     m_alertContinue.store(true);
     m_alertThd = std::thread(&ImageProcessor::alertWork, this);
+
+    // 调试预览/录制在独立渲染线程进行，不占用检测线程；多路摄像头时只预览主摄像头
+    if (0 == m_cameraIndex && (m_testSourcePreview || !m_testPreviewRecordPath.empty())) {
+        DebugVisualizer* visualizer = DebugVisualizer::getInstance();
+        extern MNNDetector* g_mnn_detector;
+        if (g_mnn_detector) { visualizer->setClassNames(g_mnn_detector->getClassNames()); }
+        visualizer->start(m_testPreviewRecordPath);
+    }
 }
 
 void ImageProcessor::stop() {
     m_continue.store(false);
+    m_frameMailbox.interrupt();
+    m_detectScheduler.interrupt();
+    CameraManager::getInstance()->wakeAll();
     if (m_thread.joinable()) {
         m_thread.join();
     }
+    if (m_captureThd.joinable()) {
+        m_captureThd.join();
+    }
+    InferenceScheduler::getInstance()->unregisterSource();
 
     m_alertContinue.store(false);
-#if PLATFORM_WINDOWS
-    SetEvent(m_hAlertEvent);
-#endif
+    m_alertQueue.stop();
     if (m_alertThd.joinable()) {
         m_alertThd.join();
     }
 
+    if (0 == m_cameraIndex) {
+        DebugVisualizer::getInstance()->stop();
+    }
+
     if (m_scrShot) {
         m_scrShot->deinit();
     }
@@ -161,11 +226,13 @@ void ImageProcessor::stop() {
 
 void ImageProcessor::setAlertEnables(const bool alertPhoneEnable, const bool alertPeepEnable,
     const bool alertNobodyEnable, const bool alertNobodyLockEnable, const bool alertNoconnectEnable) {
+    std::unique_lock<std::shared_mutex> writeLock(m_paramMtx);
     m_alertPhoneEnable = alertPhoneEnable;
     m_alertPeepEnable = alertPeepEnable;
     m_alertNobodyEnable = alertNobodyEnable;
     m_alertNobodyLockEnable = alertNobodyLockEnable;
     m_alertNoconnectEnable = alertNoconnectEnable;
+    rebuildAlertPolicy();
 }
 
 void ImageProcessor::setTestConfigs(const bool sourcePreview, const std::string& testVideoPath)
@@ -179,71 +246,115 @@ bool ImageProcessor::getWorkThreadStatus() const
     return m_workThreadStatus.load();
 }
 
+void ImageProcessor::setCameraIndex(int32_t cameraIndex)
+{
+    m_cameraIndex = cameraIndex;
+    // 主摄像头保持原有证据文件名，其他摄像头加上编号前缀
+    m_evidenceTag = 0 == cameraIndex ? "" : "cam" + std::to_string(cameraIndex) + "_";
+}
+
 void ImageProcessor::work() {
 
     try {
-        if (m_testVideoPath.empty()) {
-            // camera
+        const bool useCaptureThread = m_testVideoPath.empty();
+        if (useCaptureThread) {
+            // camera：由captureWork打开并持续读取
             MY_SPDLOG_INFO("camera width: {} height: {}", m_cameraWidth, m_cameraHeight);
-            /*
-            if (false == openCameraOnce(m_cameraId)) {
-                m_cap.reset();
-                cv::destroyAllWindows();
-                throw std::runtime_error("open camera once failed");
-            }
-            */
-            if (!openCameraUntilTrue()) {
-                throw std::runtime_error("open camera untile true failed");
-            }
         }
         else {
             if (false == openVideoOnce()) {
                 m_cap.reset();
-                cv::destroyAllWindows();
                 throw std::runtime_error("open video once failed");
             }
+            int32_t cam_width = static_cast<int32_t>(m_cap->get(cv::CAP_PROP_FRAME_WIDTH));
+            int32_t cam_height = static_cast<int32_t>(m_cap->get(cv::CAP_PROP_FRAME_HEIGHT));
+            MY_SPDLOG_INFO("video real resolution {} x {}", cam_width, cam_height);
         }
 
-        // 获取MNN检测器实例
-        extern MNNDetector* g_mnn_detector;
-        MNNDetector* detector = g_mnn_detector;
-        int32_t cam_width = static_cast<int32_t>(m_cap->get(cv::CAP_PROP_FRAME_WIDTH));
-        int32_t cam_height = static_cast<int32_t>(m_cap->get(cv::CAP_PROP_FRAME_HEIGHT));
-        MY_SPDLOG_INFO("camera real resolution {} x {}", cam_width, cam_height);
+        // 离线回放基准：不按节拍等待，判定用的时钟按视频帧率推进，结果可复现
+        const bool replayMode = !useCaptureThread && m_testReplayUnthrottled;
+        std::unique_ptr<VideoPrefetcher> prefetcher;
+        std::chrono::steady_clock::duration replayFrameStep = std::chrono::milliseconds(40);
+        const auto replayStartTime = std::chrono::steady_clock::now();
+        if (replayMode) {
+            double fps = m_cap->get(cv::CAP_PROP_FPS);
+            if (fps > 0.0) {
+                replayFrameStep = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(1.0 / fps));
+            }
+            if (m_testReplayPrefetch) {
+                prefetcher = std::make_unique<VideoPrefetcher>();
+                prefetcher->start(m_cap.get(), &m_framePool);
+            }
+            m_replayReport.begin(m_testVideoPath, m_testReplayPrefetch, m_testReplayFrameDetail);
+            MY_SPDLOG_INFO("replay benchmark mode, prefetch: {}, video fps: {:.2f}", m_testReplayPrefetch, fps);
+        }
+        uint64_t frameIndex = 0;
+        m_alertVoter.reset();
+        m_ruleEvaluator.reset();
+        if (!std::atomic_load(&m_alertPolicy)) {
+            std::unique_lock<std::shared_mutex> writeLock(m_paramMtx);
+            rebuildAlertPolicy();
+        }
+
+        // 多路摄像头共享同一个检测器，由推理调度器合并batch或分配会话
+        InferenceScheduler* inference = InferenceScheduler::getInstance();
+        DebugVisualizer* visualizer = 0 == m_cameraIndex ? DebugVisualizer::getInstance() : nullptr;
         uint32_t lenCnt = 0, phoneCnt = 0, faceCnt = 0, suspectedCnt = 0;
+        std::vector<Detection> detections;
+        std::chrono::steady_clock::time_point captureTime;
+        FrameHandle curFrame;
+        ReplayReport::FrameRecord replayRecord;
+        m_detectScheduler.reset();
         while (m_continue.load()) {
-            if (!m_cap) { // only camera situation could run into here
-                if (!openCameraUntilTrue()) {
-                    throw std::runtime_error("open camera untile true failed");
-                }
-            }
             // 图像捕获
-            m_cap->read(m_cameraFrame);
-            if (m_cameraFrame.empty()) {
-                if (m_testVideoPath.empty()) { // camera disconnect
-                    MY_SPDLOG_ERROR("Frame capture failed. Attempting to reconnect...");
-                    if (!openCameraUntilTrue()) {
+            if (useCaptureThread) {
+                if (!acquireLatestFrame(curFrame, captureTime)) {
+                    if (m_captureFailed.load()) {
                         throw std::runtime_error("open camera untile true failed");
                     }
-                    continue;
+                    continue; // 摄像头重连中或正在停止
                 }
-                else { // video end of stream
+            }
+            else if (prefetcher) {
+                if (!prefetcher->pop(curFrame, replayRecord.stageMs[ReplayReport::STAGE_DECODE])) {
+                    throw std::runtime_error("video end of stream");
+                }
+                LatencyStats::getInstance()->recordMs(LatencyStage::Capture, replayRecord.stageMs[ReplayReport::STAGE_DECODE]);
+                captureTime = std::chrono::steady_clock::now();
+            }
+            else {
+                curFrame = m_framePool.acquire();
+                if (!curFrame) {
+                    throw std::runtime_error("frame pool exhausted");
+                }
+                auto decodeBegin = std::chrono::steady_clock::now();
+                m_cap->read(curFrame.writable());
+                if (curFrame.empty()) { // video end of stream
                     throw std::runtime_error("video end of stream");
-                    break;
                 }
+                captureTime = std::chrono::steady_clock::now();
+                replayRecord.stageMs[ReplayReport::STAGE_DECODE] =
+                    std::chrono::duration<double, std::milli>(captureTime - decodeBegin).count();
+                LatencyStats::getInstance()->record(LatencyStage::Capture, captureTime - decodeBegin);
             }
 
+            const cv::Mat& cameraFrame = curFrame.image();
+            m_decisionTime = replayMode ? replayStartTime + replayFrameStep * static_cast<int64_t>(frameIndex) : captureTime;
+
             // MNN对象检测
             // double detectCost = 0.0; // Unused variable removed
             lenCnt = 0;
             phoneCnt = 0;
             faceCnt = 0;
             suspectedCnt = 0;
+            detections.clear();
             
-            if (detector) {
+            auto detectBegin = std::chrono::steady_clock::now();
+            if (inference->isRunning()) {
                 // MNN检测器返回检测结果
-                std::vector<Detection> detections = detector->detect(m_cameraFrame);
-                
+                detections = inference->detect(cameraFrame);
+
                 // 统计各类别数量
                 for (const auto& det : detections) {
                     if (det.class_id == 1) { // lens
@@ -255,12 +366,20 @@ void ImageProcessor::work() {
                     }
                 }
             }
+            auto decideBegin = std::chrono::steady_clock::now();
             MY_SPDLOG_TRACE("lenCnt {} phoneCnt {} faceCnt {} suspectedCnt {}",
                             lenCnt, phoneCnt, faceCnt, suspectedCnt);
 
-            // 通知检测结果到PADetectCore
+            // 调试预览：仅投递，绘制和显示在渲染线程完成
+            if (visualizer && visualizer->isRunning()) {
+                visualizer->submit(cameraFrame, detections,
+                    cv::format("Lens: %u | Phones: %u | Faces: %u | Suspected: %u",
+                        lenCnt, phoneCnt, faceCnt, suspectedCnt));
+            }
+
+            // 通知检测结果到PADetectCore(界面只展示主摄像头的计数)
             PADetectCore* core = PADetectCore::getInstance();
-            if (core) {
+            if (core && 0 == m_cameraIndex) {
                 DetectionResult result;
                 result.lenCount = lenCnt;
                 result.phoneCount = phoneCnt;
@@ -272,66 +391,97 @@ void ImageProcessor::work() {
             // 确定警报类型和睡眠间隔 - AlertWindowManager已删除，改用简单枚举
             int newMode = ALERT_TYPE::COUNT;
             long sleepInterval = m_capInterval;  // 默认采样间隔
+            const char* decision = "normal";
+
+            // 规则表整体原子替换，热路径不持有参数锁；遮挡判定较重，仅在规则需要时计算
+            std::shared_ptr<const AlertRuleTable> policy = std::atomic_load(&m_alertPolicy);
+            const std::array<uint32_t, CLASS_SLOTS> counts{ faceCnt, lenCnt, phoneCnt, suspectedCnt };
+            AlertRuleEvaluator::Result ruleResult = m_ruleEvaluator.evaluate(policy, counts, [&] {
+                return isCameraOccluded(cameraFrame);
+            }, m_decisionTime);
+
+            // 单帧判定
+            const int rawType = ruleResult.alertType >= 0 ? ruleResult.alertType : ALERT_TYPE::COUNT;
+            switch (rawType) {
+            case TEXT_PHONE: ++m_detPhoneCnt; break;
+            case TEXT_PEEP: ++m_detPeepCnt; break;
+            case TEXT_OCCLUDE: ++m_detOcclude; break;
+            case TEXT_NOBODY: ++m_detNobodyCnt; break;
+            default: break;
+            }
+            if (ruleResult.ruleIndex >= 0) {
+                decision = policy->getRules()[ruleResult.ruleIndex].name.c_str();
+                sleepInterval = policy->alertIntervalMs;
+            }
+            else if (policy) {
+                sleepInterval = policy->idleIntervalMs;
+            }
+            // 负载/电源调节只放慢空闲采样，告警状态下保持原间隔跟踪
+            if (ruleResult.ruleIndex < 0) {
+                sleepInterval = static_cast<long>(sleepInterval * LoadGovernor::getInstance()->getIntervalScale());
+            }
+            if (ruleResult.lock) {
+                triggerScreenLock();
+            }
 
-            {                
-                std::shared_lock<std::shared_mutex> readLock(m_paramMtx);
-                if (0 != lenCnt || 0 != phoneCnt) {
-                    ++m_detPhoneCnt;
-                    newMode = m_alertPhoneEnable ? ALERT_TYPE::TEXT_PHONE : newMode;
-                    sleepInterval = m_alertShowInterval;
-                    m_isNoFaceTiming = false;
-                }
-                else if (1 < faceCnt) {
-                    ++m_detPeepCnt;
-                    newMode = m_alertPeepEnable ? ALERT_TYPE::TEXT_PEEP : newMode;
-                    sleepInterval = m_alertShowInterval;
-                    m_isNoFaceTiming = false;
-                }
-                else if (0 == faceCnt) {
-                    if (isCameraOccludedByTraditional(m_cameraFrame)) {
-                        ++m_detOcclude;
-                        newMode = m_alertOcculeEnable ? ALERT_TYPE::TEXT_OCCLUDE : newMode;
-                        sleepInterval = m_alertShowInterval;
-                        handleNoFaceLock();
+            // N-of-M投票：每帧所有类型都要更新，按规则优先级取第一个触发的类型
+            uint32_t alertActions = 0;
+            if (policy) {
+                m_alertVoter.configure(policy->voteRules);
+                int votedType = ALERT_TYPE::COUNT;
+                for (int32_t type : policy->getTypeOrder()) {
+                    if (m_alertVoter.update(type, type == rawType) && ALERT_TYPE::COUNT == votedType) {
+                        votedType = type;
                     }
-                    else {
-                        ++m_detNobodyCnt;
-                        newMode = m_alertNobodyEnable ? ALERT_TYPE::TEXT_NOBODY : newMode;
-                        sleepInterval = m_alertShowInterval;
-                        handleNoFaceLock();
-                    }
-                }
-                else if (0 != suspectedCnt) {
-                    newMode = m_alertSuspectEnable ? ALERT_TYPE::TEXT_SUSPECT : newMode;
-                    sleepInterval = m_alertShowInterval;
-                    m_isNoFaceTiming = false;
                 }
-                else {  // 单张人脸情况
-                    sleepInterval = m_capInterval;
-                    m_isNoFaceTiming = false;
+                alertActions = policy->getTypeActions(votedType);
+                if (alertActions & ACTION_ALERT) {
+                    newMode = votedType;
                 }
             }
 
-            // 添加警报任务（如果模式改变）
-            if (newMode != m_lastAlertMode) {
-                {
-                    std::unique_lock<std::mutex> lock(m_alertMtx);
-                    m_alertTaskVec.emplace_back(newMode);
+            recordCaptureLatency(captureTime);
+
+            // 添加警报事件（如果模式改变）
+            postAlert(newMode, curFrame, alertActions);
+            LatencyStats::getInstance()->record(LatencyStage::Decision, std::chrono::steady_clock::now() - decideBegin);
+
+            if (replayMode) {
+                auto decideEnd = std::chrono::steady_clock::now();
+                replayRecord.index = frameIndex;
+                replayRecord.stageMs[ReplayReport::STAGE_DETECT] =
+                    std::chrono::duration<double, std::milli>(decideBegin - detectBegin).count();
+                replayRecord.stageMs[ReplayReport::STAGE_DECIDE] =
+                    std::chrono::duration<double, std::milli>(decideEnd - decideBegin).count();
+                replayRecord.stageMs[ReplayReport::STAGE_TOTAL] = replayRecord.stageMs[ReplayReport::STAGE_DECODE] +
+                    std::chrono::duration<double, std::milli>(decideEnd - captureTime).count();
+                replayRecord.decision = decision;
+                if (m_testReplayFrameDetail) {
+                    replayRecord.detections = detections;
                 }
-#if PLATFORM_WINDOWS
- SetEvent(m_hAlertEvent);
-#endif
+                m_replayReport.addFrame(std::move(replayRecord));
+                replayRecord = ReplayReport::FrameRecord();
             }
+            ++frameIndex;
 
-            // 睡眠控制
-            std::this_thread::sleep_for(std::chrono::milliseconds(sleepInterval));
+            // 节拍控制：按绝对截止时间等待，处理耗时不累加到周期上；回放基准不等待
+            if (!replayMode) {
+                if (!m_detectScheduler.waitNext(std::chrono::milliseconds(sleepInterval))) {
+                    break;
+                }
+                logSchedulerStats();
+            }
 
             // 调试模式退出检查
-            if (m_testSourcePreview && cv::waitKey(1) >= 0)
+            if (visualizer && visualizer->isQuitRequested())
                 break;
         }
-        m_cap.reset();
-        cv::destroyAllWindows();
+        if (!useCaptureThread) {
+            m_cap.reset();
+        }
+        Json::StreamWriterBuilder voteWriter;
+        voteWriter["indentation"] = "";
+        MY_SPDLOG_INFO("alert voting stats: {}", Json::writeString(voteWriter, getVoterStats()));
     }
     catch (const std::exception& e) {
         m_workThreadStatus.store(false);
@@ -340,6 +490,128 @@ void ImageProcessor::work() {
     }
 }
 
+void ImageProcessor::captureWork() {
+    MY_SPDLOG_INFO(">>>");
+    try {
+        if (!openCameraUntilTrue()) {
+            throw std::runtime_error("open camera untile true failed");
+        }
+        cv::Size camSize = m_camera->getFrameSize();
+        MY_SPDLOG_INFO("camera real resolution {} x {}", camSize.width, camSize.height);
+
+        uint64_t frameSeq = 0;
+        while (m_continue.load()) {
+            // grab只取出驱动缓冲，不解码，保证驱动队列中不会积压旧帧
+            if (!m_camera || !m_camera->grab()) {
+                MY_SPDLOG_ERROR("Frame capture failed. Attempting to reconnect...");
+                if (!openCameraUntilTrue()) {
+                    throw std::runtime_error("open camera untile true failed");
+                }
+                continue;
+            }
+            auto grabTime = std::chrono::steady_clock::now();
+            // 后端能给出驱动采集时间时(v4l2)以其为准，延迟统计包含驱动队列中的等待
+            m_camera->getCaptureTime(grabTime);
+
+            // 检测线程没有请求新帧时，这一帧会被丢弃，无需解码
+            if (!m_frameWanted.exchange(false)) {
+                continue;
+            }
+
+            FrameHandle frame = m_framePool.acquire();
+            if (!frame) {
+                // 帧缓冲全部被告警线程等占用，丢弃本帧
+                MY_SPDLOG_WARN("frame pool exhausted, drop frame");
+                m_frameWanted.store(true);
+                continue;
+            }
+            if (!m_camera->retrieve(frame)) {
+                m_frameWanted.store(true); // 下一帧重试
+                continue;
+            }
+            LatencyStats::getInstance()->record(LatencyStage::Capture, std::chrono::steady_clock::now() - grabTime);
+            CapturedFrame& slot = m_frameMailbox.writeSlot();
+            slot.frame = std::move(frame);
+            slot.captureTime = grabTime;
+            slot.seq = ++frameSeq;
+            m_frameMailbox.publish();
+        }
+    }
+    catch (const std::exception& e) {
+        if (m_continue.load()) {
+            m_captureFailed.store(true);
+            MY_SPDLOG_ERROR("capture thread exit since: {}", e.what());
+        }
+    }
+    m_frameMailbox.interrupt();
+    m_camera.reset();
+    MY_SPDLOG_INFO("<<<");
+}
+
+bool ImageProcessor::acquireLatestFrame(FrameHandle& frameOut, std::chrono::steady_clock::time_point& captureTime) {
+    const auto requestTime = std::chrono::steady_clock::now();
+    m_frameWanted.store(true);
+    while (m_continue.load()) {
+        CapturedFrame* frame = m_frameMailbox.waitTake(std::chrono::milliseconds(m_alertShowInterval));
+        if (nullptr == frame) {
+            return false;
+        }
+        // 上一次请求超时后才到达的帧已过期，重新请求
+        if (frame->captureTime < requestTime) {
+            m_frameWanted.store(true);
+            continue;
+        }
+        // 读槽位在下一次take之前归消费者所有，直接移走句柄
+        frameOut = std::move(frame->frame);
+        captureTime = frame->captureTime;
+        return true;
+    }
+    return false;
+}
+
+void ImageProcessor::recordCaptureLatency(const std::chrono::steady_clock::time_point& captureTime) {
+    constexpr uint32_t LATENCY_LOG_FRAMES = 100;
+    double latencyMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - captureTime).count();
+    LatencyStats::getInstance()->recordMs(LatencyStage::FrameLatency, latencyMs);
+    m_capLatencySumMs += latencyMs;
+    m_capLatencyMaxMs = (std::max)(m_capLatencyMaxMs, latencyMs);
+    if (++m_capLatencyCnt >= LATENCY_LOG_FRAMES) {
+        MY_SPDLOG_DEBUG("capture->decision latency avg: {:.2f} ms, max: {:.2f} ms over {} frames",
+            m_capLatencySumMs / m_capLatencyCnt, m_capLatencyMaxMs, m_capLatencyCnt);
+        m_capLatencySumMs = 0.0;
+        m_capLatencyMaxMs = 0.0;
+        m_capLatencyCnt = 0;
+    }
+}
+
+void ImageProcessor::logSchedulerStats() {
+    constexpr uint64_t SCHED_LOG_TICKS = 100;
+    DetectScheduler::Stats stats = m_detectScheduler.getStats();
+    if (0 == stats.ticks || 0 != stats.ticks % SCHED_LOG_TICKS) {
+        return;
+    }
+    stats = m_detectScheduler.takeStats();
+    MY_SPDLOG_DEBUG("detect cadence ticks: {}, overruns: {}, skipped ticks: {}, jitter avg: {:.1f} us, max: {:.1f} us",
+        stats.ticks, stats.overruns, stats.skippedTicks, stats.jitterAvgUs, stats.jitterMaxUs);
+}
+
+void ImageProcessor::postAlert(int mode, const FrameHandle& frame, uint32_t actions) {
+    // 检测线程与采集线程(摄像头断开)都会投递，仅在类型变化时入队
+    if (m_lastQueuedMode.exchange(mode) == mode) {
+        return;
+    }
+    AlertEvent event;
+    event.type = mode;
+    event.actions = actions;
+    event.timestamp = std::chrono::steady_clock::now();
+    // 只有需要摄像头证据时才占用帧缓冲，避免排队的事件占满帧池
+    if (actions & ACTION_CAMERA) {
+        event.frame = frame;
+    }
+    m_alertQueue.push(std::move(event));
+}
+
 #define USE_DATA_DIR 0
 
 void ImageProcessor::alertWork() {
@@ -358,6 +630,7 @@ void ImageProcessor::alertWork() {
     // pic file upload
     PicFileUploader* picUploader = PicFileUploader::getInstance();
     picUploader->start();
+    JpegEncoderPool::getInstance()->start();
 
     //std::string prefixCapPathStr = imgCapDir.string();
     // 使用用户主目录下的数据目录，避免只读文件系统问题
@@ -395,159 +668,63 @@ void ImageProcessor::alertWork() {
         system(mkdirCmd.c_str());
     }
     // work thread loop
-    // 设置 JPEG 图像质量
-    std::vector<int> params;
-    params.push_back(cv::IMWRITE_JPEG_QUALITY);
-    params.push_back(60); // 设置质量为 60
-
+    uint64_t lastLoggedHandled = 0;
     while (m_alertContinue.load()) {
-        // macOS等待机制
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-
-        std::unique_lock<std::mutex> lock(m_alertMtx);
-        if (!m_alertContinue.load()) break;
-        
-        if (m_alertTaskVec.empty()) continue;
-        m_lastAlertMode = m_alertTaskVec.back();
-        m_alertTaskVec.clear();
-        lock.unlock();
-
-        // 处理不同的告警类型
-        switch (m_lastAlertMode) {
-            case TEXT_PHONE: {
-                MY_SPDLOG_INFO("Processing TEXT_PHONE alert");
-                if (m_alertPhoneScreenEnable && m_scrShot) {
-                    m_scrShot->capture(screenBuf.get());
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string screenPath = prefixPathStr + "/screen_phone_" + imgStr + ".jpg";
-                    if (cv::imwrite(screenPath, screenFrame, params)) {
-                        MY_SPDLOG_INFO("Screen capture saved: {}", screenPath);
-                        std::ifstream file(screenPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(screenPath, fileData);
-                        }
-                    }
-                }
-                if (m_alertPhoneCameraEnable && !m_cameraFrame.empty()) {
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string cameraPath = prefixPathStr + "/camera_phone_" + imgStr + ".jpg";
-                    if (cv::imwrite(cameraPath, m_cameraFrame, params)) {
-                        MY_SPDLOG_INFO("Camera capture saved: {}", cameraPath);
-                        std::ifstream file(cameraPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(cameraPath, fileData);
-                        }
-                    }
-                }
-                break;
-            }
-            case TEXT_SUSPECT: {
-                MY_SPDLOG_INFO("Processing TEXT_SUSPECT alert");
-                if (m_alertSuspectScreenEnable && m_scrShot) {
-                    m_scrShot->capture(screenBuf.get());
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string screenPath = prefixPathStr + "/screen_suspect_" + imgStr + ".jpg";
-                    if (cv::imwrite(screenPath, screenFrame, params)) {
-                        MY_SPDLOG_INFO("Screen capture saved: {}", screenPath);
-                        std::ifstream file(screenPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(screenPath, fileData);
-                        }
-                    }
-                }
-                if (m_alertSuspectCameraEnable && !m_cameraFrame.empty()) {
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string cameraPath = prefixPathStr + "/camera_suspect_" + imgStr + ".jpg";
-                    if (cv::imwrite(cameraPath, m_cameraFrame, params)) {
-                        MY_SPDLOG_INFO("Camera capture saved: {}", cameraPath);
-                        std::ifstream file(cameraPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(cameraPath, fileData);
-                        }
-                    }
-                }
-                break;
+        // 阻塞等待告警事件，入队即唤醒
+        AlertEvent event;
+        if (!m_alertQueue.waitPop(event, std::chrono::milliseconds(1000))) {
+            continue;
+        }
+        m_lastAlertMode = event.type;
+        // MJPEG采集时检测用的是缩小解码的图像，证据从原始JPEG全分辨率解码
+        cv::Mat cameraFrame = event.frame.image();
+        const bool cameraEvidence = 0 != (event.actions & ACTION_CAMERA);
+        if (cameraEvidence && !event.frame.encoded().empty()) {
+            cv::Mat fullFrame;
+            if (MjpegCaptureSource::decodeFull(event.frame.encoded(), fullFrame)) {
+                cameraFrame = fullFrame;
             }
-            case TEXT_PEEP: {
-                MY_SPDLOG_INFO("Processing TEXT_PEEP alert");
-                if (!m_cameraFrame.empty()) {
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string cameraPath = prefixPathStr + "/camera_peep_" + imgStr + ".jpg";
-                    if (cv::imwrite(cameraPath, m_cameraFrame, params)) {
-                        MY_SPDLOG_INFO("Camera capture saved: {}", cameraPath);
-                        std::ifstream file(cameraPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(cameraPath, fileData);
-                        }
-                    }
-                }
-                break;
+        }
+        std::vector<EvidenceItem> evidence;
+
+        // 证据类型由告警规则的动作决定
+        if (TEXT_NOCONNECT == m_lastAlertMode) {
+            MY_SPDLOG_INFO("Processing TEXT_NOCONNECT alert");
+            if (m_scrShot) {
+                m_scrShot->capture(screenBuf.get());
+                evidence.push_back({ screenFrame, "screen_noconnect_", false, uploadPriorityOf(TEXT_NOCONNECT) });
             }
-            case TEXT_NOBODY: {
-                MY_SPDLOG_INFO("Processing TEXT_NOBODY alert");
-                if (!m_cameraFrame.empty()) {
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string cameraPath = prefixPathStr + "/camera_nobody_" + imgStr + ".jpg";
-                    if (cv::imwrite(cameraPath, m_cameraFrame, params)) {
-                        MY_SPDLOG_INFO("Camera capture saved: {}", cameraPath);
-                        std::ifstream file(cameraPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(cameraPath, fileData);
-                        }
-                    }
-                }
-                break;
+        }
+        else if (m_lastAlertMode >= 0 && m_lastAlertMode < ALERT_TYPE::COUNT) {
+            const std::string typeName = ALERT_TYPE_NAMES[m_lastAlertMode];
+            const bool isSuspected = TEXT_SUSPECT == m_lastAlertMode;
+            const UploadPriority priority = uploadPriorityOf(m_lastAlertMode);
+            MY_SPDLOG_INFO("Processing {} alert, actions: {}", typeName, event.actions);
+            if ((event.actions & ACTION_SCREENSHOT) && m_scrShot) {
+                m_scrShot->capture(screenBuf.get());
+                evidence.push_back({ screenFrame, "screen_" + typeName + "_", isSuspected, priority });
             }
-            case TEXT_OCCLUDE: {
-                MY_SPDLOG_INFO("Processing TEXT_OCCLUDE alert");
-                if (!m_cameraFrame.empty()) {
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string cameraPath = prefixPathStr + "/camera_occlude_" + imgStr + ".jpg";
-                    if (cv::imwrite(cameraPath, m_cameraFrame, params)) {
-                        MY_SPDLOG_INFO("Camera capture saved: {}", cameraPath);
-                        std::ifstream file(cameraPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(cameraPath, fileData);
-                        }
-                    }
-                }
-                break;
+            if (cameraEvidence && !cameraFrame.empty()) {
+                evidence.push_back({ cameraFrame, "camera_" + typeName + "_", isSuspected, priority });
             }
-            case TEXT_NOCONNECT: {
-                MY_SPDLOG_INFO("Processing TEXT_NOCONNECT alert");
-                if (m_scrShot) {
-                    m_scrShot->capture(screenBuf.get());
-                    std::string dateStr, imgStr;
-                    getDateAndImgStr(dateStr, imgStr);
-                    std::string screenPath = prefixPathStr + "/screen_noconnect_" + imgStr + ".jpg";
-                    if (cv::imwrite(screenPath, screenFrame, params)) {
-                        MY_SPDLOG_INFO("Screen capture saved: {}", screenPath);
-                        std::ifstream file(screenPath, std::ios::binary);
-                        if (file) {
-                            std::vector<uint8_t> fileData((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                            picUploader->writePic2Disk(screenPath, fileData);
-                        }
-                    }
-                }
-                break;
-            }
-            default:
-                MY_SPDLOG_WARN("Unknown alert mode: {}", m_lastAlertMode);
-                break;
+        }
+        else if (ALERT_TYPE::COUNT == m_lastAlertMode) {
+            MY_SPDLOG_DEBUG("Alert cleared");
+        }
+        else {
+            MY_SPDLOG_WARN("Unknown alert mode: {}", m_lastAlertMode);
+        }
+        // 同一告警的多张证据并行编码
+        saveEvidence(evidence, prefixPathStr);
+        m_alertQueue.markHandled(event);
+
+        AlertEventQueue::Stats alertStats = m_alertQueue.getStats();
+        if (alertStats.handled - lastLoggedHandled >= 20) {
+            lastLoggedHandled = alertStats.handled;
+            MY_SPDLOG_DEBUG("alert events pushed: {}, coalesced: {}, dropped: {}, queue wait avg/max: {:.1f}/{:.1f} ms, end-to-end avg/max: {:.1f}/{:.1f} ms",
+                alertStats.pushed, alertStats.coalesced, alertStats.dropped,
+                alertStats.queueWaitAvgMs, alertStats.queueWaitMaxMs,
+                alertStats.endToEndAvgMs, alertStats.endToEndMaxMs);
         }
         
         // 通知SwiftUI显示告警窗口
@@ -555,6 +732,7 @@ void ImageProcessor::alertWork() {
     }
     
     // 清理资源
+    JpegEncoderPool::getInstance()->stop();
     picUploader->stop();
     MY_SPDLOG_INFO("<<<");
 }
@@ -585,159 +763,239 @@ bool ImageProcessor::openVideoOnce()
     return false;
 }
 
-bool ImageProcessor::openCameraUntilTrue() {
 #ifdef __APPLE__
-    MY_SPDLOG_INFO("Starting camera initialization on macOS");
-    
-    // 检查摄像头权限
+// 摄像头权限只需确认一次，授权后不再重复查询
+static bool ensureCameraPermission() {
+    static std::atomic_bool authorized{ false };
+    if (authorized.load()) {
+        return true;
+    }
+
     AVAuthorizationStatus status = [AVCaptureDevice authorizationStatusForMediaType:AVMediaTypeVideo];
     MY_SPDLOG_INFO("Camera permission status: {}", (int)status);
-    
-    if (status != AVAuthorizationStatusAuthorized) {
-        MY_SPDLOG_ERROR("Camera permission not granted. Status: {}", (int)status);
-        if (status == AVAuthorizationStatusNotDetermined) {
-            MY_SPDLOG_INFO("Requesting camera permission...");
-            // 同步等待权限请求结果
-            dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
-            __block BOOL permissionGranted = NO;
-            [AVCaptureDevice requestAccessForMediaType:AVMediaTypeVideo completionHandler:^(BOOL granted) {
-                permissionGranted = granted;
-                if (granted) {
-                    MY_SPDLOG_INFO("Camera permission granted");
-                } else {
-                    MY_SPDLOG_ERROR("Camera permission denied by user");
-                }
-                dispatch_semaphore_signal(semaphore);
-            }];
-            dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
-            dispatch_release(semaphore);
-            
-            if (!permissionGranted) {
-                return false;
-            }
-        } else {
-            MY_SPDLOG_ERROR("Camera permission denied or restricted");
-            return false;
-        }
-    } else {
-        MY_SPDLOG_INFO("Camera permission already granted");
-    }
-    
-    // 枚举可用的摄像头设备
-    MY_SPDLOG_INFO("Enumerating available camera devices...");
-    std::vector<std::string> deviceUniqueIDs;
-    std::vector<std::string> deviceNames = getCameraDeviceNames(deviceUniqueIDs);
-    
-    MY_SPDLOG_INFO("System detected {} camera devices:", deviceNames.size());
-    for (size_t i = 0; i < deviceNames.size(); i++) {
-        MY_SPDLOG_INFO("  Device {}: {} (uniqueID: {})", i, deviceNames[i], deviceUniqueIDs[i]);
+    if (status == AVAuthorizationStatusAuthorized) {
+        authorized.store(true);
+        return true;
     }
-    
-    MY_SPDLOG_INFO("Total available camera devices: {}", deviceNames.size());
-    
-    if (deviceUniqueIDs.empty()) {
-        MY_SPDLOG_ERROR("No camera devices found! This may indicate a permission or hardware issue.");
+    if (status != AVAuthorizationStatusNotDetermined) {
+        MY_SPDLOG_ERROR("Camera permission denied or restricted");
         return false;
     }
-    
-    // 查找指定的摄像头uniqueID
-    int32_t deviceIndex = 0; // 默认使用第一个设备
-    bool foundDevice = false;
-    
-    for (size_t i = 0; i < deviceUniqueIDs.size(); i++) {
-        if (deviceUniqueIDs[i] == m_cameraId) {
-            deviceIndex = static_cast<int32_t>(i);
-            foundDevice = true;
-            MY_SPDLOG_INFO("Found camera with uniqueID: {} at index: {}", m_cameraId, deviceIndex);
-            break;
-        }
-    }
-    
-    if (!foundDevice) {
-        MY_SPDLOG_WARN("Requested camera uniqueID {} not found, using default device index: {}", m_cameraId, deviceIndex);
+
+    MY_SPDLOG_INFO("Requesting camera permission...");
+    // 同步等待权限请求结果
+    dispatch_semaphore_t semaphore = dispatch_semaphore_create(0);
+    __block BOOL permissionGranted = NO;
+    [AVCaptureDevice requestAccessForMediaType:AVMediaTypeVideo completionHandler:^(BOOL granted) {
+        permissionGranted = granted;
+        dispatch_semaphore_signal(semaphore);
+    }];
+    dispatch_semaphore_wait(semaphore, DISPATCH_TIME_FOREVER);
+    dispatch_release(semaphore);
+    if (!permissionGranted) {
+        MY_SPDLOG_ERROR("Camera permission denied by user");
+        return false;
     }
-    
-    MY_SPDLOG_INFO("Using camera device index: {} for uniqueID: {}", deviceIndex, m_cameraId);
+    MY_SPDLOG_INFO("Camera permission granted");
+    authorized.store(true);
+    return true;
+}
+
+// 向CameraManager注册AVFoundation枚举，并监听设备插拔通知使枚举缓存失效
+static void registerCameraDeviceProvider() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        CameraManager* manager = CameraManager::getInstance();
+        manager->setEnumerator([] {
+            std::vector<std::string> deviceUniqueIDs;
+            std::vector<std::string> deviceNames = getCameraDeviceNames(deviceUniqueIDs);
+            std::vector<CameraDeviceInfo> devices;
+            for (size_t i = 0; i < deviceUniqueIDs.size() && i < deviceNames.size(); i++) {
+                devices.push_back({ deviceUniqueIDs[i], deviceNames[i], static_cast<int32_t>(i) });
+            }
+            return devices;
+        });
+        NSNotificationCenter* center = [NSNotificationCenter defaultCenter];
+        void (^onChange)(NSNotification*) = ^(NSNotification* /* note */) {
+            CameraManager::getInstance()->notifyDeviceChange();
+        };
+        [center addObserverForName:AVCaptureDeviceWasConnectedNotification object:nil queue:nil usingBlock:onChange];
+        [center addObserverForName:AVCaptureDeviceWasDisconnectedNotification object:nil queue:nil usingBlock:onChange];
+    });
+}
 #endif
 
-    while (true) {
-        if (m_cap) { m_cap.reset(); }
-        auto beforeTime = std::chrono::steady_clock::now();
-        MY_SPDLOG_ERROR("device index: {} (uniqueID: {}) try open camera", deviceIndex, m_cameraId);
-        m_cap.reset(new cv::VideoCapture(deviceIndex, cv::CAP_AVFOUNDATION));
-        if (m_cap->isOpened()) {
-            m_cap->set(cv::CAP_PROP_FRAME_WIDTH, m_cameraWidth);
-            m_cap->set(cv::CAP_PROP_FRAME_HEIGHT, m_cameraHeight);
-            auto afterTime = std::chrono::steady_clock::now();
-            double duration_millsecond = std::chrono::duration<double, std::milli>(afterTime - beforeTime).count();
-            MY_SPDLOG_ERROR("device index: {} (uniqueID: {}) open success, spend: {} ms", deviceIndex, m_cameraId, duration_millsecond);
-            return true;
-        }
-
-        // 摄像头打开失败，记录详细错误信息
-        MY_SPDLOG_ERROR("Failed to open camera device index: {} (uniqueID: {}) after permission check and device enumeration", deviceIndex, m_cameraId);
-        MY_SPDLOG_ERROR("This may indicate a hardware issue or the camera is being used by another application");
-        
-        // open camera failed - AlertWindowManager已删除，改用简单常量
-        const int TEXT_NOCONNECT = 6;
-        const int COUNT = 0;
-        if (m_alertNoconnectEnable) {
-            if (m_lastAlertMode != TEXT_NOCONNECT) {
-                {
-                    std::unique_lock<std::mutex> lock(m_alertMtx);
-                    m_alertTaskVec.emplace_back(TEXT_NOCONNECT);
-                }
+bool ImageProcessor::openCameraUntilTrue() {
+#ifdef __APPLE__
+    if (!ensureCameraPermission()) {
+        return false;
+    }
+    registerCameraDeviceProvider();
+#endif
+    CameraManager* manager = CameraManager::getInstance();
+    manager->startHotplugMonitor();
+
+    int32_t retryBaseMs = 0;
+    int32_t retryMaxMs = 0;
+    std::string captureBackend;
+    std::string capturePixelFormat;
+    int32_t captureWidth = 0;
+    int32_t captureHeight = 0;
+    {
+        std::shared_lock<std::shared_mutex> readLock(m_paramMtx);
+        retryBaseMs = m_cameraRetryBaseMs;
+        retryMaxMs = m_cameraRetryMaxMs;
+        captureBackend = m_captureBackend;
+        capturePixelFormat = m_capturePixelFormat;
+        captureWidth = m_captureWidth;
+        captureHeight = m_captureHeight;
+    }
+    ReconnectBackoff backoff(retryBaseMs, retryMaxMs);
+
+    while (m_continue.load()) {
+        // 先取代数再枚举，枚举之后发生的插拔一定能唤醒下面的等待
+        const uint64_t generation = manager->getDeviceGeneration();
+        std::vector<CameraDeviceInfo> devices = manager->getDevices();
+        int32_t deviceIndex = manager->findDeviceIndex(m_cameraId);
+        if (deviceIndex < 0 && !devices.empty()) {
+            deviceIndex = devices.front().index; // 默认使用第一个设备
+            if (0 == backoff.attempts()) {
+                MY_SPDLOG_WARN("Requested camera uniqueID {} not found, using default device index: {}", m_cameraId, deviceIndex);
             }
         }
-        else {
-            if (m_lastAlertMode != COUNT) {
-                {
-                    std::unique_lock<std::mutex> lock(m_alertMtx);
-                    m_alertTaskVec.emplace_back(COUNT);
-                }
+
+        if (deviceIndex >= 0) {
+            m_camera.reset();
+            auto beforeTime = std::chrono::steady_clock::now();
+            m_camera = CaptureSource::create(captureBackend, captureWidth, captureHeight, capturePixelFormat);
+            if (m_camera->open(deviceIndex, m_cameraWidth, m_cameraHeight)) {
+                auto afterTime = std::chrono::steady_clock::now();
+                double duration_millsecond = std::chrono::duration<double, std::milli>(afterTime - beforeTime).count();
+                MY_SPDLOG_INFO("device index: {} (uniqueID: {}) open success by {} backend after {} retries, spend: {} ms",
+                    deviceIndex, m_cameraId, m_camera->getName(), backoff.attempts(), duration_millsecond);
+                return true;
             }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(m_alertShowInterval));
+
+        // 首次失败记ERROR，之后只在退避达到上限时周期性提示，其余降为DEBUG，避免拔掉摄像头时刷屏
+        std::chrono::milliseconds delay = backoff.nextDelay();
+        if (1 == backoff.attempts()) {
+            MY_SPDLOG_ERROR("Failed to open camera device index: {} (uniqueID: {}), devices: {}, retry in {} ms",
+                deviceIndex, m_cameraId, devices.size(), delay.count());
+        } else if (backoff.atMax()) {
+            MY_SPDLOG_WARN("camera (uniqueID: {}) still unavailable after {} retries, retry in {} ms",
+                m_cameraId, backoff.attempts(), delay.count());
+        } else {
+            MY_SPDLOG_DEBUG("camera (uniqueID: {}) open retry {}, next in {} ms", m_cameraId, backoff.attempts(), delay.count());
+        }
+
+        // open camera failed
+        postAlert(m_alertNoconnectEnable ? TEXT_NOCONNECT : COUNT, FrameHandle());
+        // 设备插拔时立即重试并重新开始退避
+        if (manager->waitForDeviceChange(generation, delay, m_continue)) {
+            MY_SPDLOG_INFO("camera device change detected, retry open camera now");
+            backoff.reset();
+        }
     }
     return false;
 }
 
-void ImageProcessor::saveMatWithEncode(cv::Mat& inMat, const std::string& inFilePath, const std::vector<int>& encParam, bool isSuspected)
+void ImageProcessor::buildEvidencePacket(const std::string& uploadName, bool isSuspected,
+    const std::vector<uint8_t>& jpegData, std::vector<uint8_t>& outData)
 {
+    std::string filePathBase64Enc = CommonUtils::Base64::encode(uploadName);
+    const uint32_t headerLen = htonl(filePathBase64Enc.size());
 
-    std::vector<uint8_t> jpg_buffer;
-    if (!cv::imencode(".jpg", inMat, jpg_buffer, encParam)) {
-        MY_SPDLOG_ERROR("encode {} jpg failed", inFilePath.c_str());
-        return;
-    }
+    // 添加疑似标志(1字节)
+    uint8_t suspectedFlag = isSuspected ? 1 : 0;
 
-    size_t pos = inFilePath.find("/");
-    if (pos != std::string::npos) {
-        std::string result = inFilePath.substr(pos + 1);
-        std::string filePathBase64Enc = CommonUtils::Base64::encode(result);
-        const uint32_t headerLen = htonl(filePathBase64Enc.size());
+    outData.clear();
+    outData.reserve(sizeof(headerLen) + filePathBase64Enc.size() + sizeof(suspectedFlag) + jpegData.size());
 
-        // 添加疑似标志(1字节)
-        uint8_t suspectedFlag = isSuspected ? 1 : 0;
+    // 添加头部长度
+    const uchar* len_ptr = reinterpret_cast<const uchar*>(&headerLen);
+    outData.insert(outData.end(), len_ptr, len_ptr + sizeof(uint32_t));
 
-        std::vector<uint8_t> final_data;
-        final_data.reserve(sizeof(headerLen) + filePathBase64Enc.size() + sizeof(suspectedFlag) + jpg_buffer.size());
+    // 添加Base64编码的文件路径
+    outData.insert(outData.end(), filePathBase64Enc.begin(), filePathBase64Enc.end());
 
-        // 添加头部长度
-        const uchar* len_ptr = reinterpret_cast<const uchar*>(&headerLen);
-        final_data.insert(final_data.end(), len_ptr, len_ptr + sizeof(uint32_t));
+    // 添加疑似标志
+    outData.push_back(suspectedFlag);
 
-        // 添加Base64编码的文件路径
-        final_data.insert(final_data.end(), filePathBase64Enc.begin(), filePathBase64Enc.end());
+    // 添加JPEG原始数据
+    outData.insert(outData.end(), jpegData.begin(), jpegData.end());
+}
 
-        // 添加疑似标志
-        final_data.push_back(suspectedFlag);
+void ImageProcessor::saveEvidence(const std::vector<EvidenceItem>& items, const std::string& dirPath)
+{
+    if (items.empty()) {
+        return;
+    }
+    ++m_evidenceAlertCnt;
+    int32_t quality = 60, maxWidth = 0, maxHeight = 0;
+    EvidenceDeduper::Params dedupParams;
+    {
+        std::shared_lock<std::shared_mutex> readLock(m_paramMtx);
+        quality = m_evidenceJpegQuality;
+        maxWidth = m_evidenceMaxWidth;
+        maxHeight = m_evidenceMaxHeight;
+        dedupParams.enable = m_evidenceDedupEnable;
+        dedupParams.hammingThreshold = m_evidenceDedupHamming;
+        dedupParams.windowMs = m_evidenceDedupWindowMs;
+    }
+    m_evidenceDeduper.setParams(dedupParams);
+
+    // 编码前按告警类型+来源过滤近重复帧，重复画面不再编码、落盘和上传
+    const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    std::vector<const EvidenceItem*> kept;
+    kept.reserve(items.size());
+    for (const auto& item : items) {
+        if (m_evidenceDeduper.shouldKeep(item.namePrefix, item.image, nowMs)) {
+            kept.push_back(&item);
+        }
+        else {
+            ++m_evidenceDedupCnt;
+            MY_SPDLOG_DEBUG("Evidence {} dropped as near-duplicate", item.namePrefix);
+        }
+    }
+    if (kept.empty()) {
+        return;
+    }
 
-        // 添加JPEG原始数据
-        final_data.insert(final_data.end(), jpg_buffer.begin(), jpg_buffer.end());
+    // 全部提交后再等待，屏幕与摄像头证据在编码线程池中并行编码
+    JpegEncoderPool* encoder = JpegEncoderPool::getInstance();
+    std::vector<std::future<JpegEncodeResult>> futures;
+    futures.reserve(kept.size());
+    for (const EvidenceItem* item : kept) {
+        futures.emplace_back(encoder->submit(item->image, quality, std::move(m_jpegEncBuf), maxWidth, maxHeight));
+        m_jpegEncBuf = std::vector<uint8_t>();
+    }
 
-        PicFileUploader* picUploader = PicFileUploader::getInstance();
-        picUploader->writePic2Disk(inFilePath, final_data);
+    // 内存中编码一次并加上文件头，缓冲所有权直接交给上传器，只落盘一次
+    PicFileUploader* picUploader = PicFileUploader::getInstance();
+    for (size_t i = 0; i < kept.size(); ++i) {
+        JpegEncodeResult result = futures[i].get();
+        LatencyStats::getInstance()->recordMs(LatencyStage::EvidenceEncode, result.costMs);
+        std::string dateStr, imgStr;
+        getDateAndImgStr(dateStr, imgStr);
+        const std::string fileName = m_evidenceTag + kept[i]->namePrefix + imgStr + ".jpg";
+        if (!result.ok) {
+            MY_SPDLOG_ERROR("encode {} jpg failed", fileName);
+            continue;
+        }
+        const std::string filePath = dirPath + "/" + fileName;
+        std::vector<uint8_t> finalData = picUploader->acquireBuffer();
+        buildEvidencePacket(fileName, kept[i]->isSuspected, result.data, finalData);
+        const size_t packetSize = finalData.size();
+        // 积压时按告警类型的优先级上传，手机告警最先
+        picUploader->submitPic(filePath, std::move(finalData), kept[i]->priority);
+        ++m_evidenceFileCnt;
+        m_evidenceBytes += packetSize;
+        MY_SPDLOG_INFO("Evidence saved: {} ({}x{} -> {}x{}, {} bytes, encode {:.1f} ms)", filePath,
+            kept[i]->image.cols, kept[i]->image.rows, result.width, result.height, packetSize, result.costMs);
+        // 编码缓冲留作下次复用
+        m_jpegEncBuf = std::move(result.data);
     }
 }
 
@@ -754,29 +1012,48 @@ void ImageProcessor::saveRiskEventFile(const std::string& fileName,
     }
 }
 
-void ImageProcessor::handleNoFaceLock() {
-    if (!m_alertNobodyEnable && !m_alertOcculeEnable) return;
+void ImageProcessor::triggerScreenLock() {
+    MY_SPDLOG_INFO("No face timeout reached, triggering screen lock");
+    ++m_detLockCnt;
+    // macOS锁屏功能；测试视频只计数，不真正锁屏
+    if (m_testVideoPath.empty()) {
+        system("pmset displaysleepnow");
+    }
+}
 
-    // 锁屏处理
-    if (m_alertNobodyLockEnable) {
-        if (!m_isNoFaceTiming) {
-            m_noFaceStartTime = std::chrono::steady_clock::now();
-            MY_SPDLOG_DEBUG("No face lock time begin");
-            m_isNoFaceTiming = true;
-        }
-        else {
-            auto duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - m_noFaceStartTime);
-            MY_SPDLOG_DEBUG("No face duration: {} ms", duration_ms.count());
-
-            if (duration_ms.count() >= m_noFaceLockTimeout) {
-                MY_SPDLOG_INFO("No face timeout reached, triggering screen lock");
-                // macOS锁屏功能
-                system("pmset displaysleepnow");
-                m_isNoFaceTiming = false; // 重置计时状态
-            }
+std::shared_ptr<AlertRuleTable> ImageProcessor::buildLegacyAlertRules() const {
+    AlertRuleTable::Switches switches;
+    switches.phoneAlert = m_alertPhoneEnable;
+    switches.phoneScreen = m_alertPhoneScreenEnable;
+    switches.phoneCamera = m_alertPhoneCameraEnable;
+    switches.peepAlert = m_alertPeepEnable;
+    switches.occludeAlert = m_alertOcculeEnable;
+    switches.nobodyAlert = m_alertNobodyEnable;
+    switches.nobodyLock = m_alertNobodyLockEnable;
+    switches.suspectAlert = m_alertSuspectEnable;
+    switches.suspectScreen = m_alertSuspectScreenEnable;
+    switches.suspectCamera = m_alertSuspectCameraEnable;
+    switches.lockTimeoutMs = m_noFaceLockTimeout;
+    return AlertRuleTable::fromSwitches(switches, alertTypeFromName);
+}
+
+void ImageProcessor::rebuildAlertPolicy() {
+    std::shared_ptr<AlertRuleTable> table;
+    if (!m_alertRulesJson.empty()) {
+        std::string error;
+        table = AlertRuleTable::compile(m_alertRulesJson, alertTypeFromName, error);
+        if (!table) {
+            MY_SPDLOG_ERROR("invalid alert_rules, fallback to alert switches: {}", error);
         }
     }
+    if (!table) {
+        table = buildLegacyAlertRules();
+    }
+    table->alertIntervalMs = m_alertShowInterval;
+    table->idleIntervalMs = m_capInterval;
+    table->voteRules = m_voteRules;
+    MY_SPDLOG_INFO("alert policy rebuilt, rules: {}, from config: {}", table->getRules().size(), !m_alertRulesJson.empty());
+    std::atomic_store(&m_alertPolicy, std::shared_ptr<const AlertRuleTable>(std::move(table)));
 }
 
 void ImageProcessor::processWindowsMessages() {
@@ -789,21 +1066,78 @@ void ImageProcessor::processWindowsMessages() {
 #endif
 }
 
+Json::Value ImageProcessor::getVoterStats() const {
+    Json::Value root;
+    uint64_t rawRises = 0;
+    uint64_t votedRises = 0;
+    for (size_t type = 0; type < m_alertVoter.getChannelCount() && type < ALERT_TYPE::COUNT; ++type) {
+        TemporalVoter::ChannelStats stats = m_alertVoter.getStats(type);
+        if (0 == stats.frames) {
+            continue;
+        }
+        Json::Value item;
+        item["rawRises"] = Json::Value::UInt64(stats.rawRises);
+        item["votedRises"] = Json::Value::UInt64(stats.votedRises);
+        root["types"][ALERT_TYPE_NAMES[type]] = item;
+        rawRises += stats.rawRises;
+        votedRises += stats.votedRises;
+    }
+    // 每次触发对应一次告警任务(截图+编码+落盘+上传)，按实际平均证据量估算省下的I/O
+    const uint64_t suppressed = rawRises > votedRises ? rawRises - votedRises : 0;
+    const uint64_t alertCnt = m_evidenceAlertCnt.load();
+    const double bytesPerAlert = alertCnt > 0 ? static_cast<double>(m_evidenceBytes.load()) / alertCnt : 0.0;
+    const double filesPerAlert = alertCnt > 0 ? static_cast<double>(m_evidenceFileCnt.load()) / alertCnt : 0.0;
+    root["rawRises"] = Json::Value::UInt64(rawRises);
+    root["votedRises"] = Json::Value::UInt64(votedRises);
+    root["suppressedAlerts"] = Json::Value::UInt64(suppressed);
+    root["evidenceAlerts"] = Json::Value::UInt64(alertCnt);
+    root["evidenceBytes"] = Json::Value::UInt64(m_evidenceBytes.load());
+    root["evidenceDeduped"] = Json::Value::UInt64(m_evidenceDedupCnt.load());
+    root["estimatedSavedFiles"] = filesPerAlert * suppressed;
+    root["estimatedSavedBytes"] = bytesPerAlert * suppressed;
+    return root;
+}
+
 void ImageProcessor::writeTestDataToJson() {
     Json::Value root;
 
     root["detNobodyCnt"] = Json::Value::UInt64(m_detNobodyCnt);
     root["detPeepCnt"] = Json::Value::UInt64(m_detPeepCnt);
     root["detPhoneCnt"] = Json::Value::UInt64(m_detPhoneCnt);
+    root["detOccludeCnt"] = Json::Value::UInt64(m_detOcclude);
+    root["detLockCnt"] = Json::Value::UInt64(m_detLockCnt);
+    root["voting"] = getVoterStats();
+    // 上传队列按优先级的积压深度
+    const UploadStats uploadStats = PicFileUploader::getInstance()->getStats();
+    Json::Value upload;
+    upload["uploaded"] = Json::Value::UInt64(uploadStats.uploaded);
+    upload["pending"] = Json::Value::UInt64(uploadStats.pending);
+    upload["throttledMs"] = Json::Value::UInt64(uploadStats.throttledMs);
+    for (int32_t priority = 0; priority < UPLOAD_PRIORITY_COUNT; ++priority) {
+        Json::Value item;
+        item["pending"] = Json::Value::UInt64(uploadStats.pendingByPriority[priority]);
+        item["bytes"] = Json::Value::UInt64(uploadStats.pendingBytesByPriority[priority]);
+        upload["queues"][PicFileUploader::priorityName(static_cast<UploadPriority>(priority))] = item;
+    }
+    root["upload"] = upload;
+    if (m_testOcclusionCompare) {
+        root["occlusionCompareCnt"] = Json::Value::UInt64(m_occlusionCompareCnt);
+        root["occlusionOnlyNewCnt"] = Json::Value::UInt64(m_occlusionOnlyNewCnt);
+        root["occlusionOnlyLegacyCnt"] = Json::Value::UInt64(m_occlusionOnlyLegacyCnt);
+    }
+    if (m_replayReport.isActive()) {
+        m_replayReport.end();
+        root["replay"] = m_replayReport.toJson();
+    }
 
     Json::StreamWriterBuilder writer;
     writer["indentation"] = "  ";
 
     try {
-        CommonUtils::FileHelper::writeStrToFile("test.json", Json::writeString(writer, root));
+        CommonUtils::FileHelper::writeStrToFile(m_testReportPath, Json::writeString(writer, root));
     }
     catch (const std::exception &e) {
-        MY_SPDLOG_WARN("write test json to test.json exception: {}", e.what());
+        MY_SPDLOG_WARN("write test json to {} exception: {}", m_testReportPath, e.what());
     }
 }
 
@@ -823,6 +1157,25 @@ void ImageProcessor::setDetectParam(const std::shared_ptr<MyMeta>& meta) {
 
         m_capInterval = meta->getInt32OrDefault("detect_interval", m_capInterval);
         m_alertShowInterval = meta->getInt32OrDefault("alert_show_interval", m_alertShowInterval);
+        m_cameraRetryBaseMs = meta->getInt32OrDefault("camera_retry_base_ms", m_cameraRetryBaseMs);
+        m_cameraRetryMaxMs = meta->getInt32OrDefault("camera_retry_max_ms", m_cameraRetryMaxMs);
+        m_captureBackend = meta->getStringOrDefault("capture_backend", m_captureBackend);
+        m_capturePixelFormat = meta->getStringOrDefault("capture_pixel_format", m_capturePixelFormat);
+        m_captureWidth = meta->getInt32OrDefault("capture_width", m_captureWidth);
+        m_captureHeight = meta->getInt32OrDefault("capture_height", m_captureHeight);
+
+        // 告警时间投票"N/M/C"：最近M帧中N帧阳性触发，降到C帧以下解除；"1/1/0"即单帧判定
+        m_voteRules.resize(ALERT_TYPE::COUNT);
+        const std::pair<int, const char*> voteKeys[] = {
+            { TEXT_PHONE, "vote_phone" }, { TEXT_PEEP, "vote_peep" }, { TEXT_NOBODY, "vote_nobody" },
+            { TEXT_OCCLUDE, "vote_occlude" }, { TEXT_SUSPECT, "vote_suspect" },
+        };
+        for (const auto& item : voteKeys) {
+            const std::string spec = meta->getStringOrDefault(item.second, "");
+            if (!spec.empty() && !TemporalVoter::parseRule(spec, m_voteRules[item.first])) {
+                MY_SPDLOG_WARN("invalid {}: {}, expect N/M/C", item.second, spec);
+            }
+        }
 
         // 手机检测开关
         m_alertPhoneEnable = meta->getBoolOrDefault("alert_phone_enable", m_alertPhoneEnable);
@@ -848,9 +1201,23 @@ void ImageProcessor::setDetectParam(const std::shared_ptr<MyMeta>& meta) {
         m_alertOccludeWindowEnable = meta->getBoolOrDefault("alert_occlude_window_enable", m_alertOccludeWindowEnable);
         m_brightnessThresholdLow = meta->getDoubleOrDefault("brightness_threshold_low", m_brightnessThresholdLow);
         m_brightnessThresholdHigh = meta->getDoubleOrDefault("brightness_threshold_high", m_brightnessThresholdHigh);
+        m_occlusionDownsample = meta->getInt32OrDefault("occlusion_downsample", m_occlusionDownsample);
+        m_occlusionGradientThreshold = meta->getInt32OrDefault("occlusion_gradient_threshold", m_occlusionGradientThreshold);
+        m_occlusionEdgeRatio = meta->getDoubleOrDefault("occlusion_edge_ratio", m_occlusionEdgeRatio);
+        rebuildOcclusionParams();
+        // 证据图片尺寸上限和JPEG质量
+        m_evidenceMaxWidth = meta->getInt32OrDefault("evidence_max_width", m_evidenceMaxWidth);
+        m_evidenceMaxHeight = meta->getInt32OrDefault("evidence_max_height", m_evidenceMaxHeight);
+        m_evidenceJpegQuality = meta->getInt32OrDefault("evidence_jpeg_quality", m_evidenceJpegQuality);
+        m_evidenceDedupEnable = meta->getBoolOrDefault("evidence_dedup_enable", m_evidenceDedupEnable);
+        m_evidenceDedupHamming = meta->getInt32OrDefault("evidence_dedup_hamming", m_evidenceDedupHamming);
+        m_evidenceDedupWindowMs = meta->getInt32OrDefault("evidence_dedup_window_ms", m_evidenceDedupWindowMs);
         // 断连检测开关
         m_alertNoconnectEnable = meta->getBoolOrDefault("alert_noconnect_enable", m_alertNoconnectEnable);
         m_alertNoconnectWindowEnable = meta->getBoolOrDefault("alert_noconnect_window_enable", m_alertNoconnectWindowEnable);
+        // 告警规则(JSON数组)，未配置时由上面的开关生成
+        m_alertRulesJson = meta->getStringOrDefault("alert_rules", m_alertRulesJson);
+        rebuildAlertPolicy();
     }
     // 日志输出保持不变
     MY_SPDLOG_DEBUG("配置更新: \n"
@@ -861,6 +1228,9 @@ void ImageProcessor::setDetectParam(const std::shared_ptr<MyMeta>& meta) {
               "nobody_en={}, nobody_win={}, nobody_lock={}, \n"
               "occlude_en={}, occlude_win={}, \n"
               "bri_low={}, bri_hight={}, \n"
+              "occ_downsample={}, occ_grad={}, occ_edge_ratio={}, \n"
+              "evidence_max={}x{}, evidence_quality={}, \n"
+              "dedup_en={}, dedup_hamming={}, dedup_window={}, \n"
               "noconnect_en={}, noconnect_win={}",
 
               // 第一行：基础参数 (2个)
@@ -885,6 +1255,9 @@ void ImageProcessor::setDetectParam(const std::shared_ptr<MyMeta>& meta) {
               m_alertOcculeEnable, m_alertOccludeWindowEnable,
               // occlude threadhold of brightness
               m_brightnessThresholdLow, m_brightnessThresholdHigh,
+              m_occlusionDownsample, m_occlusionGradientThreshold, m_occlusionEdgeRatio,
+              m_evidenceMaxWidth, m_evidenceMaxHeight, m_evidenceJpegQuality,
+              m_evidenceDedupEnable, m_evidenceDedupHamming, m_evidenceDedupWindowMs,
 
               // 断连检测开关 (2个)
               m_alertNoconnectEnable, m_alertNoconnectWindowEnable);
@@ -894,25 +1267,79 @@ void ImageProcessor::setTestParam(const std::shared_ptr<MyMeta>& meta) {
     // 使用类型安全的默认值获取方法
     m_testSourcePreview = meta->getBoolOrDefault("test_source_preview", m_testSourcePreview);
     m_testVideoPath = meta->getStringOrDefault("test_video_path", m_testVideoPath);
+    m_testPreviewRecordPath = meta->getStringOrDefault("test_preview_record_path", m_testPreviewRecordPath);
+    m_testOcclusionCompare = meta->getBoolOrDefault("test_occlusion_compare", m_testOcclusionCompare);
+    m_testReplayUnthrottled = meta->getBoolOrDefault("test_replay_unthrottled", m_testReplayUnthrottled);
+    m_testReplayPrefetch = meta->getBoolOrDefault("test_replay_prefetch", m_testReplayPrefetch);
+    m_testReplayFrameDetail = meta->getBoolOrDefault("test_replay_frame_detail", m_testReplayFrameDetail);
+    m_testReportPath = meta->getStringOrDefault("test_report_path", m_testReportPath);
 
     // 日志输出保持不变
-    MY_SPDLOG_DEBUG("测试参数更新: m_testSourcePreview={}, m_testVideoPath='{}'",
-                   m_testSourcePreview, m_testVideoPath);
+    MY_SPDLOG_DEBUG("测试参数更新: m_testSourcePreview={}, m_testVideoPath='{}', m_testPreviewRecordPath='{}', m_testOcclusionCompare={}",
+                   m_testSourcePreview, m_testVideoPath, m_testPreviewRecordPath, m_testOcclusionCompare);
+    MY_SPDLOG_DEBUG("回放参数更新: unthrottled={}, prefetch={}, frameDetail={}, report='{}'",
+                   m_testReplayUnthrottled, m_testReplayPrefetch, m_testReplayFrameDetail, m_testReportPath);
 }
 
 void ImageProcessor::setNoFaceLockEnabled(bool enabled) {
     std::unique_lock<std::shared_mutex> writeLock(m_paramMtx);
     m_alertNobodyLockEnable = enabled;
+    rebuildAlertPolicy();
     MY_SPDLOG_DEBUG("No face lock enabled: {}", enabled);
 }
 
 void ImageProcessor::setNoFaceLockTimeout(int32_t timeoutMs) {
     std::unique_lock<std::shared_mutex> writeLock(m_paramMtx);
     m_noFaceLockTimeout = timeoutMs;
+    rebuildAlertPolicy();
     MY_SPDLOG_DEBUG("No face lock timeout set to: {} ms", timeoutMs);
 }
 
-bool ImageProcessor::isCameraOccludedByTraditional(cv::InputArray frame) {
+// 调用方持有m_paramMtx写锁
+void ImageProcessor::rebuildOcclusionParams() {
+    auto params = std::make_shared<OcclusionAnalyzer::Params>();
+    params->downsample = m_occlusionDownsample;
+    params->brightnessLow = m_brightnessThresholdLow;
+    params->brightnessHigh = m_brightnessThresholdHigh;
+    params->gradientThreshold = m_occlusionGradientThreshold;
+    params->edgeRatioThreshold = m_occlusionEdgeRatio;
+    std::atomic_store(&m_occlusionParams, std::shared_ptr<const OcclusionAnalyzer::Params>(std::move(params)));
+}
+
+// 仅检测线程调用，参数变化后才同步到分析器
+bool ImageProcessor::isCameraOccluded(const cv::Mat& frame) {
+    ScopedStageTimer timer(LatencyStage::Occlusion);
+    std::shared_ptr<const OcclusionAnalyzer::Params> params = std::atomic_load(&m_occlusionParams);
+    if (params && params != m_appliedOcclusionParams) {
+        m_occlusionAnalyzer.setParams(*params);
+        m_appliedOcclusionParams = params;
+    }
+    const OcclusionAnalyzer::Params& applied = m_occlusionAnalyzer.getParams();
+
+    OcclusionAnalyzer::Result result = m_occlusionAnalyzer.analyze(frame);
+    if (result.occluded) {
+        MY_SPDLOG_DEBUG("Occluded: center {:.1f}, edge ratio {:.4f}", result.centerBrightness, result.edgeRatio);
+    }
+
+    // 测试视频上与原全分辨率算法对比，结果写入test.json
+    if (m_testOcclusionCompare) {
+        bool legacy = isCameraOccludedByTraditional(frame, applied.brightnessLow, applied.brightnessHigh);
+        ++m_occlusionCompareCnt;
+        if (result.occluded && !legacy) {
+            ++m_occlusionOnlyNewCnt;
+        }
+        else if (!result.occluded && legacy) {
+            ++m_occlusionOnlyLegacyCnt;
+        }
+        if (result.occluded != legacy) {
+            MY_SPDLOG_DEBUG("occlusion mismatch new={} legacy={} center {:.1f} edge ratio {:.4f}",
+                result.occluded, legacy, result.centerBrightness, result.edgeRatio);
+        }
+    }
+    return result.occluded;
+}
+
+bool ImageProcessor::isCameraOccludedByTraditional(cv::InputArray frame, double brightnessLow, double brightnessHigh) {
     cv::Mat gray;
     cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
 
@@ -930,8 +1357,8 @@ bool ImageProcessor::isCameraOccludedByTraditional(cv::InputArray frame) {
         cv::mean(gray(cv::Rect(x2, y2, grid_w, grid_h)))[0];
     center_brightness /= 4.0;
 
-    if (center_brightness < m_brightnessThresholdLow) {
-        MY_SPDLOG_DEBUG("Occluded: center too dark {:.1f} < {}", center_brightness, m_brightnessThresholdLow);
+    if (center_brightness < brightnessLow) {
+        MY_SPDLOG_DEBUG("Occluded: center too dark {:.1f} < {}", center_brightness, brightnessLow);
         return true;  // 3μs内完成判定
     }
 
@@ -947,7 +1374,7 @@ bool ImageProcessor::isCameraOccludedByTraditional(cv::InputArray frame) {
     }
 
     // 检测3：边缘少但中心明亮 → 不是遮挡
-    if (center_brightness > m_brightnessThresholdHigh) {
+    if (center_brightness > brightnessHigh) {
         // MY_SPDLOG_DEBUG("Not occluded: center bright {:.1f} > {}",center_brightness, BRIGHT_THRESH);
         return false;
     }
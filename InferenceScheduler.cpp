@@ -0,0 +1,143 @@
+#include "InferenceScheduler.h"
+#include "MNNDetector.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+InferenceScheduler::~InferenceScheduler() {
+    stop();
+}
+
+void InferenceScheduler::start(MNNDetector* detector, int32_t batchWaitMs) {
+    stop();
+    if (nullptr == detector) {
+        return;
+    }
+    m_detector = detector;
+    m_maxBatch = (std::max)(1, detector->getMaxBatch());
+    m_batchWaitMs = (std::max)(0, batchWaitMs);
+    m_requestCnt.store(0);
+    m_batchCnt.store(0);
+    m_running.store(true);
+    if (m_maxBatch > 1) {
+        m_batchThd = std::thread(&InferenceScheduler::batchLoop, this);
+    }
+    MY_SPDLOG_INFO("inference scheduler started, max batch: {}, batch wait: {} ms", m_maxBatch, m_batchWaitMs);
+}
+
+void InferenceScheduler::stop() {
+    {
+        // 与detect入队互斥：停止前已入队的请求都会被处理完，之后的请求直接返回空结果
+        std::lock_guard<std::mutex> lock(m_reqMtx);
+        if (!m_running.exchange(false)) {
+            return;
+        }
+    }
+    m_reqCond.notify_all();
+    if (m_batchThd.joinable()) {
+        m_batchThd.join();
+    }
+    Stats stats = getStats();
+    MY_SPDLOG_INFO("inference scheduler stopped, requests: {}, batches: {}, avg batch size: {:.2f}",
+        stats.requests, stats.batches, stats.avgBatchSize);
+    m_detector = nullptr;
+}
+
+void InferenceScheduler::registerSource() {
+    m_sourceCount.fetch_add(1);
+}
+
+void InferenceScheduler::unregisterSource() {
+    if (m_sourceCount.fetch_sub(1) <= 1) {
+        m_sourceCount.store(0);
+    }
+    // 凑batch的目标数量变小，唤醒可能在等待的工作线程
+    m_reqCond.notify_all();
+}
+
+std::vector<Detection> InferenceScheduler::detect(const cv::Mat& frame) {
+    if (!m_running.load() || nullptr == m_detector) {
+        return {};
+    }
+    m_requestCnt.fetch_add(1, std::memory_order_relaxed);
+
+    // 不支持batch：各线程直接使用会话池，互不等待
+    if (m_maxBatch <= 1) {
+        m_batchCnt.fetch_add(1, std::memory_order_relaxed);
+        return m_detector->detect(frame);
+    }
+
+    std::future<std::vector<Detection>> future;
+    {
+        std::lock_guard<std::mutex> lock(m_reqMtx);
+        if (!m_running.load()) {
+            return {};
+        }
+        Request req;
+        req.frame = &frame;
+        future = req.promise.get_future();
+        m_requests.emplace_back(std::move(req));
+    }
+    m_reqCond.notify_all();
+    return future.get();
+}
+
+InferenceScheduler::Stats InferenceScheduler::getStats() const {
+    Stats stats;
+    stats.requests = m_requestCnt.load();
+    stats.batches = m_batchCnt.load();
+    stats.avgBatchSize = stats.batches > 0 ? static_cast<double>(stats.requests) / stats.batches : 0.0;
+    return stats;
+}
+
+void InferenceScheduler::batchLoop() {
+    MY_SPDLOG_INFO(">>>");
+    std::vector<Request> batch;
+    while (true) {
+        batch.clear();
+        {
+            std::unique_lock<std::mutex> lock(m_reqMtx);
+            m_reqCond.wait(lock, [this] { return !m_requests.empty() || !m_running.load(); });
+            if (m_requests.empty()) {
+                break; // 已停止且没有待处理请求
+            }
+
+            // 第一帧到达后最多等待batchWaitMs，让其他摄像头的帧赶上同一批
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(m_batchWaitMs);
+            m_reqCond.wait_until(lock, deadline, [this] {
+                const size_t target = static_cast<size_t>((std::min)((std::max)(m_sourceCount.load(), 1), m_maxBatch));
+                return m_requests.size() >= target || !m_running.load();
+            });
+
+            const size_t count = (std::min)(m_requests.size(), static_cast<size_t>(m_maxBatch));
+            for (size_t i = 0; i < count; ++i) {
+                batch.emplace_back(std::move(m_requests.front()));
+                m_requests.pop_front();
+            }
+        }
+        runBatch(batch);
+    }
+    MY_SPDLOG_INFO("<<<");
+}
+
+void InferenceScheduler::runBatch(std::vector<Request>& batch) {
+    size_t fulfilled = 0;  // 已设置结果的请求数，异常只交给剩下的请求
+    try {
+        std::vector<cv::Mat> frames;
+        frames.reserve(batch.size());
+        for (const auto& req : batch) {
+            frames.emplace_back(*req.frame);
+        }
+        std::vector<std::vector<Detection>> results = m_detector->detectBatch(frames);
+        for (; fulfilled < batch.size(); ++fulfilled) {
+            batch[fulfilled].promise.set_value(fulfilled < results.size() ? std::move(results[fulfilled]) : std::vector<Detection>());
+        }
+    }
+    catch (...) {
+        for (size_t i = fulfilled; i < batch.size(); ++i) {
+            batch[i].promise.set_exception(std::current_exception());
+        }
+    }
+    m_batchCnt.fetch_add(1, std::memory_order_relaxed);
+}
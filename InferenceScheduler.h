@@ -0,0 +1,80 @@
+#ifndef INFERENCE_SCHEDULER_H
+#define INFERENCE_SCHEDULER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Detection.h"
+
+class MNNDetector;
+
+/**
+ * InferenceScheduler - 多路摄像头共享的推理调度器
+ * 模型支持batch(>1)时，工作线程收集各路检测线程提交的帧，等到所有已注册输入源都提交
+ * 或等待超过batchWaitMs后合并成一次推理；否则直接在调用线程走检测器的会话池并发推理。
+ * detect阻塞到结果返回，帧只借用不拷贝
+ */
+class InferenceScheduler {
+public:
+    static InferenceScheduler* getInstance() {
+        static InferenceScheduler instance;
+        return &instance;
+    }
+
+    struct Stats {
+        uint64_t requests{ 0 };
+        uint64_t batches{ 0 };
+        double avgBatchSize{ 0.0 };
+    };
+
+    void start(MNNDetector* detector, int32_t batchWaitMs);
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    // 每路输入源启动时注册，停止时注销；batch凑齐的目标数量即已注册的输入源数
+    void registerSource();
+    void unregisterSource();
+
+    // 检测一帧；未启动时返回空结果
+    std::vector<Detection> detect(const cv::Mat& frame);
+
+    Stats getStats() const;
+
+private:
+    InferenceScheduler() = default;
+    ~InferenceScheduler();
+    InferenceScheduler(const InferenceScheduler&) = delete;
+    InferenceScheduler& operator=(const InferenceScheduler&) = delete;
+
+    struct Request {
+        const cv::Mat* frame{ nullptr };
+        std::promise<std::vector<Detection>> promise;
+    };
+
+    void batchLoop();
+    void runBatch(std::vector<Request>& batch);
+
+private:
+    MNNDetector* m_detector{ nullptr };
+    int32_t m_maxBatch{ 1 };
+    int32_t m_batchWaitMs{ 5 };
+    std::atomic_bool m_running{ false };
+    std::atomic<int32_t> m_sourceCount{ 0 };
+
+    std::thread m_batchThd;
+    std::mutex m_reqMtx;
+    std::condition_variable m_reqCond;
+    std::deque<Request> m_requests;
+
+    std::atomic<uint64_t> m_requestCnt{ 0 };
+    std::atomic<uint64_t> m_batchCnt{ 0 };
+};
+
+#endif // INFERENCE_SCHEDULER_H
@@ -0,0 +1,172 @@
+#include "JpegEncoderPool.h"
+#include "ImageKernels.h"
+#include "MyLogger.hpp"
+
+#include <chrono>
+#include <memory>
+#include <utility>
+
+#ifndef HAS_TURBOJPEG
+#define HAS_TURBOJPEG 0
+#endif
+
+#if HAS_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+namespace {
+
+// 每个线程一份编码器状态，首次使用时创建，线程退出时释放
+struct EncoderState {
+    std::vector<int> params{ cv::IMWRITE_JPEG_QUALITY, 60 };
+    cv::Mat scaled;   // 复用的缩小缓冲
+#if HAS_TURBOJPEG
+    tjhandle tj{ nullptr };
+    EncoderState() { tj = tjInitCompress(); }
+    ~EncoderState() { if (tj) { tjDestroy(tj); } }
+#endif
+};
+
+EncoderState& threadEncoderState() {
+    static thread_local EncoderState state;
+    return state;
+}
+
+} // namespace
+
+JpegEncoderPool::~JpegEncoderPool() {
+    shutdown();
+}
+
+void JpegEncoderPool::start(size_t workerCount) {
+    // 多路摄像头的告警线程共用一个线程池，按引用计数启停
+    std::lock_guard<std::mutex> lock(m_lifeMtx);
+    if (m_startCount++ > 0 || m_running.exchange(true)) {
+        return;
+    }
+    if (0 == workerCount) {
+        workerCount = 1;
+    }
+    for (size_t i = 0; i < workerCount; ++i) {
+        m_workers.emplace_back(&JpegEncoderPool::workerLoop, this);
+    }
+    MY_SPDLOG_INFO("jpeg encoder pool started, workers: {}, turbojpeg: {}", workerCount, HAS_TURBOJPEG ? 1 : 0);
+}
+
+void JpegEncoderPool::stop() {
+    std::lock_guard<std::mutex> lock(m_lifeMtx);
+    if (m_startCount > 0 && --m_startCount > 0) {
+        return;
+    }
+    shutdown();
+}
+
+void JpegEncoderPool::shutdown() {
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_taskCond.notify_all();
+    for (auto& worker : m_workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    m_workers.clear();
+}
+
+std::future<JpegEncodeResult> JpegEncoderPool::submit(const cv::Mat& image, int quality,
+    std::vector<uint8_t>&& outBuf, int32_t maxWidth, int32_t maxHeight) {
+    auto task = std::make_shared<std::packaged_task<JpegEncodeResult()>>(
+        [image, quality, buf = std::move(outBuf), maxWidth, maxHeight]() mutable {
+            return encodeFitted(image, quality, std::move(buf), maxWidth, maxHeight);
+        });
+    std::future<JpegEncodeResult> future = task->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(m_taskMtx);
+        if (m_running.load()) {
+            m_tasks.emplace_back([task]() { (*task)(); });
+            task.reset();
+        }
+    }
+    if (task) {
+        (*task)();
+    }
+    else {
+        m_taskCond.notify_one();
+    }
+    return future;
+}
+
+void JpegEncoderPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_taskMtx);
+            m_taskCond.wait(lock, [this] { return !m_tasks.empty() || !m_running.load(); });
+            // 停止时先把已提交的任务做完，保证future都能就绪
+            if (m_tasks.empty()) {
+                break;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+JpegEncodeResult JpegEncoderPool::encodeFitted(const cv::Mat& image, int quality, std::vector<uint8_t>&& outBuf,
+    int32_t maxWidth, int32_t maxHeight) {
+    JpegEncodeResult result;
+    auto begin = std::chrono::steady_clock::now();
+    result.data = std::move(outBuf);
+
+    // 超过证据尺寸上限时先缩小(BGRA同时转BGR)，再编码
+    EncoderState& state = threadEncoderState();
+    const cv::Mat* src = &image;
+    if (ImageKernels::fitEvidence(image, state.scaled, maxWidth, maxHeight)) {
+        src = &state.scaled;
+    }
+    result.width = src->cols;
+    result.height = src->rows;
+    result.ok = encode(*src, quality, result.data);
+    result.costMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - begin).count();
+    return result;
+}
+
+bool JpegEncoderPool::encode(const cv::Mat& image, int quality, std::vector<uint8_t>& out) {
+    if (image.empty()) {
+        return false;
+    }
+    EncoderState& state = threadEncoderState();
+
+#if HAS_TURBOJPEG
+    int pixelFormat = -1;
+    if (image.type() == CV_8UC4) {
+        pixelFormat = TJPF_BGRA;
+    }
+    else if (image.type() == CV_8UC3) {
+        pixelFormat = TJPF_BGR;
+    }
+    else if (image.type() == CV_8UC1) {
+        pixelFormat = TJPF_GRAY;
+    }
+    if (state.tj && pixelFormat >= 0) {
+        const int subsamp = (TJPF_GRAY == pixelFormat) ? TJSAMP_GRAY : TJSAMP_420;
+        // 预分配最坏情况大小，压缩直接写入out，不再由TurboJPEG分配
+        out.resize(tjBufSize(image.cols, image.rows, subsamp));
+        unsigned char* dst = out.data();
+        unsigned long jpegSize = static_cast<unsigned long>(out.size());
+        if (0 == tjCompress2(state.tj, image.data, image.cols, static_cast<int>(image.step), image.rows,
+            pixelFormat, &dst, &jpegSize, subsamp, quality, TJFLAG_NOREALLOC | TJFLAG_FASTDCT)) {
+            out.resize(jpegSize);
+            return true;
+        }
+        MY_SPDLOG_WARN("tjCompress2 failed: {}, fallback to imencode", tjGetErrorStr2(state.tj));
+    }
+#endif
+
+    state.params[1] = quality;
+    return cv::imencode(".jpg", image, out, state.params);
+}
@@ -0,0 +1,73 @@
+#ifndef JPEG_ENCODER_POOL_H
+#define JPEG_ENCODER_POOL_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct JpegEncodeResult {
+    bool ok{ false };
+    std::vector<uint8_t> data;
+    double costMs{ 0.0 };
+    int32_t width{ 0 };    // 实际编码尺寸(缩小后)
+    int32_t height{ 0 };
+};
+
+/**
+ * JpegEncoderPool - 证据图片JPEG编码线程池
+ * 同一告警的屏幕截图和摄像头帧并行编码；每个线程持有可复用的编码器状态
+ * (HAS_TURBOJPEG时为TurboJPEG句柄，直接接受BGRA输入，省去颜色转换；否则回退cv::imencode)。
+ * submit时image为浅拷贝，调用方需保证像素在future就绪前不被改写
+ */
+class JpegEncoderPool {
+public:
+    static JpegEncoderPool* getInstance() {
+        static JpegEncoderPool instance;
+        return &instance;
+    }
+
+    // 引用计数：每次start对应一次stop，最后一个stop才真正停止
+    void start(size_t workerCount = DEFAULT_WORKERS);
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    // 异步编码；maxWidth/maxHeight>0时先在工作线程缩小到该尺寸以内；
+    // 线程池未启动时在调用线程同步完成
+    std::future<JpegEncodeResult> submit(const cv::Mat& image, int quality,
+        std::vector<uint8_t>&& outBuf = std::vector<uint8_t>(),
+        int32_t maxWidth = 0, int32_t maxHeight = 0);
+
+    // 在调用线程编码，使用该线程的编码器状态
+    static bool encode(const cv::Mat& image, int quality, std::vector<uint8_t>& out);
+    static JpegEncodeResult encodeFitted(const cv::Mat& image, int quality, std::vector<uint8_t>&& outBuf,
+        int32_t maxWidth, int32_t maxHeight);
+
+    static constexpr size_t DEFAULT_WORKERS = 2;
+
+private:
+    JpegEncoderPool() = default;
+    ~JpegEncoderPool();
+    JpegEncoderPool(const JpegEncoderPool&) = delete;
+    JpegEncoderPool& operator=(const JpegEncoderPool&) = delete;
+
+    void workerLoop();
+    void shutdown();
+
+private:
+    std::atomic_bool m_running{ false };
+    std::mutex m_lifeMtx;
+    int32_t m_startCount{ 0 };
+    std::vector<std::thread> m_workers;
+    std::mutex m_taskMtx;
+    std::condition_variable m_taskCond;
+    std::deque<std::function<void()>> m_tasks;
+};
+
+#endif // JPEG_ENCODER_POOL_H
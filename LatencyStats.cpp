@@ -0,0 +1,210 @@
+#include "LatencyStats.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+
+uint32_t LatencyHistogram::bucketIndex(uint64_t us) {
+    if (us < SUB_COUNT) {
+        return static_cast<uint32_t>(us);
+    }
+    uint32_t msb = 63;
+    while (0 == (us >> msb)) {
+        --msb;
+    }
+    if (msb > MAX_MSB) {
+        return BUCKET_COUNT - 1;
+    }
+    // 最高位以下SUB_BITS位作为子桶下标
+    const uint32_t shift = msb - SUB_BITS;
+    const uint32_t sub = static_cast<uint32_t>(us >> shift) - SUB_COUNT;
+    return (shift + 1) * SUB_COUNT + sub;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(uint32_t index) {
+    const uint32_t group = index / SUB_COUNT;
+    const uint64_t sub = index % SUB_COUNT;
+    if (0 == group) {
+        return sub;
+    }
+    const uint32_t shift = group - 1;
+    return (((SUB_COUNT + sub) << shift) + (1ull << shift)) - 1;
+}
+
+void LatencyHistogram::record(uint64_t us) {
+    m_buckets[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sumUs.fetch_add(us, std::memory_order_relaxed);
+    uint64_t prevMax = m_maxUs.load(std::memory_order_relaxed);
+    while (us > prevMax && !m_maxUs.compare_exchange_weak(prevMax, us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::load(Counts& out) const {
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+        out.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+    }
+    out.sumUs = m_sumUs.load();
+    out.maxUs = m_maxUs.load();
+}
+
+LatencySnapshot LatencyHistogram::snapshot(bool reset) {
+    Counts counts;
+    if (!reset) {
+        load(counts);
+        return summarize(counts);
+    }
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts.buckets[i] = m_buckets[i].exchange(0, std::memory_order_relaxed);
+    }
+    counts.sumUs = m_sumUs.exchange(0);
+    counts.maxUs = m_maxUs.exchange(0);
+    m_count.store(0);
+    return summarize(counts);
+}
+
+void LatencyHistogram::subtract(const Counts& current, const Counts& previous, Counts& out) {
+    int32_t highest = -1;
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+        if (current.buckets[i] < previous.buckets[i]) {
+            out = current;   // 期间被reset过
+            return;
+        }
+        out.buckets[i] = current.buckets[i] - previous.buckets[i];
+        if (0 != out.buckets[i]) {
+            highest = static_cast<int32_t>(i);
+        }
+    }
+    out.sumUs = current.sumUs >= previous.sumUs ? current.sumUs - previous.sumUs : 0;
+    out.maxUs = highest < 0 ? 0 : (std::min)(bucketUpperBound(static_cast<uint32_t>(highest)), current.maxUs);
+}
+
+LatencySnapshot LatencyHistogram::summarize(const Counts& counts) {
+    uint64_t total = 0;
+    for (uint64_t count : counts.buckets) {
+        total += count;
+    }
+    const uint64_t maxUs = counts.maxUs;
+
+    LatencySnapshot snap;
+    snap.count = total;
+    snap.maxUs = maxUs;
+    if (0 == total) {
+        return snap;
+    }
+    snap.avgUs = static_cast<double>(counts.sumUs) / total;
+
+    // 按累计计数找到各分位所在的桶，取桶上界(不超过最大值)
+    const uint64_t rank50 = (total * 50 + 99) / 100;
+    const uint64_t rank95 = (total * 95 + 99) / 100;
+    const uint64_t rank99 = (total * 99 + 99) / 100;
+    uint64_t cumulative = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; ++i) {
+        if (0 == counts.buckets[i]) {
+            continue;
+        }
+        const uint64_t prev = cumulative;
+        cumulative += counts.buckets[i];
+        const uint64_t bound = (std::min)(bucketUpperBound(i), maxUs);
+        if (prev < rank50 && cumulative >= rank50) { snap.p50Us = bound; }
+        if (prev < rank95 && cumulative >= rank95) { snap.p95Us = bound; }
+        if (prev < rank99 && cumulative >= rank99) { snap.p99Us = bound; break; }
+    }
+    return snap;
+}
+
+LatencyStats::~LatencyStats() {
+    stopPeriodicDump();
+}
+
+const char* LatencyStats::stageName(LatencyStage stage) {
+    switch (stage) {
+    case LatencyStage::Capture: return "capture";
+    case LatencyStage::FrameLatency: return "frame_latency";
+    case LatencyStage::Preprocess: return "preprocess";
+    case LatencyStage::Inference: return "inference";
+    case LatencyStage::Postprocess: return "postprocess";
+    case LatencyStage::Occlusion: return "occlusion";
+    case LatencyStage::Decision: return "decision";
+    case LatencyStage::EvidenceEncode: return "evidence_encode";
+    case LatencyStage::DiskWrite: return "disk_write";
+    case LatencyStage::Upload: return "upload";
+    default: return "unknown";
+    }
+}
+
+std::vector<LatencySnapshot> LatencyStats::snapshot(bool reset) {
+    std::vector<LatencySnapshot> result;
+    for (size_t i = 0; i < m_histograms.size(); ++i) {
+        LatencySnapshot snap = m_histograms[i].snapshot(reset);
+        if (0 == snap.count) {
+            continue;
+        }
+        snap.stage = stageName(static_cast<LatencyStage>(i));
+        result.emplace_back(std::move(snap));
+    }
+    return result;
+}
+
+void LatencyStats::logSnapshot(const LatencySnapshot& snap, const char* scope) {
+    MY_SPDLOG_INFO("latency {} {}: n={} avg={:.0f}us p50={}us p95={}us p99={}us max={}us",
+        scope, snap.stage, snap.count, snap.avgUs, snap.p50Us, snap.p95Us, snap.p99Us, snap.maxUs);
+}
+
+void LatencyStats::dumpToLog(bool reset) {
+    std::vector<LatencySnapshot> snaps = snapshot(reset);
+    for (const auto& snap : snaps) {
+        logSnapshot(snap, "total");
+    }
+}
+
+void LatencyStats::startPeriodicDump(int32_t intervalSec) {
+    stopPeriodicDump();
+    if (intervalSec <= 0) {
+        return;
+    }
+    // 第一个周期从此刻开始计算
+    m_dumpPrevious.resize(m_histograms.size());
+    for (size_t i = 0; i < m_histograms.size(); ++i) {
+        m_histograms[i].load(m_dumpPrevious[i]);
+    }
+    m_dumpContinue.store(true);
+    m_dumpThd = std::thread(&LatencyStats::dumpLoop, this, intervalSec);
+}
+
+void LatencyStats::stopPeriodicDump() {
+    {
+        std::lock_guard<std::mutex> lock(m_dumpMtx);
+        m_dumpContinue.store(false);
+    }
+    m_dumpCond.notify_all();
+    if (m_dumpThd.joinable()) {
+        m_dumpThd.join();
+    }
+}
+
+void LatencyStats::dumpLoop(int32_t intervalSec) {
+    // 与上一周期的累计计数相减得到最近一个周期的分布，直方图本身保持累计供快照接口使用
+    std::vector<LatencyHistogram::Counts>& previous = m_dumpPrevious;
+    LatencyHistogram::Counts current;
+    LatencyHistogram::Counts interval;
+    std::unique_lock<std::mutex> lock(m_dumpMtx);
+    while (m_dumpContinue.load()) {
+        if (m_dumpCond.wait_for(lock, std::chrono::seconds(intervalSec),
+            [this] { return !m_dumpContinue.load(); })) {
+            break;
+        }
+        lock.unlock();
+        for (size_t i = 0; i < m_histograms.size(); ++i) {
+            m_histograms[i].load(current);
+            LatencyHistogram::subtract(current, previous[i], interval);
+            previous[i] = current;
+            LatencySnapshot snap = LatencyHistogram::summarize(interval);
+            if (0 == snap.count) {
+                continue;
+            }
+            snap.stage = stageName(static_cast<LatencyStage>(i));
+            logSnapshot(snap, "interval");
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,145 @@
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 采集->告警链路上的各个阶段
+enum class LatencyStage {
+    Capture = 0,      // 摄像头解码/视频读取
+    FrameLatency,     // 采集完成到判定完成
+    Preprocess,       // 推理前处理(letterbox+归一化)
+    Inference,        // runSession及输出拷贝
+    Postprocess,      // 解码框+NMS
+    Occlusion,        // 遮挡判定
+    Decision,         // 判定逻辑+告警入队
+    EvidenceEncode,   // 证据JPEG编码(含缩小)
+    DiskWrite,        // 证据落盘
+    Upload,           // 单个文件上传
+    Count
+};
+
+struct LatencySnapshot {
+    std::string stage;
+    uint64_t count{ 0 };
+    double avgUs{ 0.0 };
+    uint64_t p50Us{ 0 };
+    uint64_t p95Us{ 0 };
+    uint64_t p99Us{ 0 };
+    uint64_t maxUs{ 0 };
+};
+
+/**
+ * LatencyHistogram - 无锁的对数-线性分桶直方图(HDR风格)
+ * 以微秒记录，每个2的幂区间再线性分16个子桶，相对误差约6%；
+ * record只做几次relaxed原子加，可在任意线程常开
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t SUB_BITS = 4;
+    static constexpr uint32_t SUB_COUNT = 1u << SUB_BITS;
+    static constexpr uint32_t MAX_MSB = 36;   // 约19小时，超出的样本计入最后一个桶
+    static constexpr uint32_t BUCKET_COUNT = (MAX_MSB - SUB_BITS + 2) * SUB_COUNT;
+
+    // 某一时刻的累计计数，前后两次相减得到区间分布
+    struct Counts {
+        std::array<uint64_t, BUCKET_COUNT> buckets{};
+        uint64_t sumUs{ 0 };
+        uint64_t maxUs{ 0 };
+    };
+
+    void record(uint64_t us);
+    // reset为true时读取后清零(与并发record之间不保证原子，最多差几个样本)
+    LatencySnapshot snapshot(bool reset);
+    void load(Counts& out) const;
+
+    static LatencySnapshot summarize(const Counts& counts);
+    // current - previous，区间最大值取最高非空桶上界；期间被清零过(某个桶变小)时直接返回current
+    static void subtract(const Counts& current, const Counts& previous, Counts& out);
+
+private:
+    static uint32_t bucketIndex(uint64_t us);
+    static uint64_t bucketUpperBound(uint32_t index);
+
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> m_buckets{};
+    std::atomic<uint64_t> m_count{ 0 };
+    std::atomic<uint64_t> m_sumUs{ 0 };
+    std::atomic<uint64_t> m_maxUs{ 0 };
+};
+
+/**
+ * LatencyStats - 各阶段耗时直方图的全局入口
+ * 各模块通过record或ScopedStageTimer记录，PADetectCore提供累计快照接口；
+ * 周期日志与上一周期的累计计数相减输出区间分布，不清零直方图
+ */
+class LatencyStats {
+public:
+    static LatencyStats* getInstance() {
+        static LatencyStats instance;
+        return &instance;
+    }
+
+    void record(LatencyStage stage, uint64_t us) {
+        m_histograms[static_cast<size_t>(stage)].record(us);
+    }
+    void record(LatencyStage stage, std::chrono::steady_clock::duration elapsed) {
+        record(stage, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+    }
+    void recordMs(LatencyStage stage, double ms) {
+        record(stage, static_cast<uint64_t>(ms > 0.0 ? ms * 1000.0 : 0.0));
+    }
+
+    // 所有阶段自启动(或上次reset)以来的累计快照，只返回有样本的阶段
+    std::vector<LatencySnapshot> snapshot(bool reset = false);
+    void dumpToLog(bool reset);
+
+    // 周期输出到日志，intervalSec<=0不启动
+    void startPeriodicDump(int32_t intervalSec);
+    void stopPeriodicDump();
+
+    static const char* stageName(LatencyStage stage);
+
+private:
+    LatencyStats() = default;
+    ~LatencyStats();
+    LatencyStats(const LatencyStats&) = delete;
+    LatencyStats& operator=(const LatencyStats&) = delete;
+
+    void dumpLoop(int32_t intervalSec);
+    static void logSnapshot(const LatencySnapshot& snap, const char* scope);
+
+private:
+    std::array<LatencyHistogram, static_cast<size_t>(LatencyStage::Count)> m_histograms;
+
+    std::thread m_dumpThd;
+    std::atomic_bool m_dumpContinue{ false };
+    std::mutex m_dumpMtx;
+    std::condition_variable m_dumpCond;
+    std::vector<LatencyHistogram::Counts> m_dumpPrevious;   // 仅周期输出线程使用
+};
+
+// 作用域计时：析构时记录到对应阶段
+class ScopedStageTimer {
+public:
+    explicit ScopedStageTimer(LatencyStage stage)
+        : m_stage(stage), m_begin(std::chrono::steady_clock::now()) {}
+    ~ScopedStageTimer() {
+        LatencyStats::getInstance()->record(m_stage, std::chrono::steady_clock::now() - m_begin);
+    }
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    LatencyStage m_stage;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+#endif // LATENCY_STATS_H
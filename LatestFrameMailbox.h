@@ -0,0 +1,104 @@
+#ifndef LATEST_FRAME_MAILBOX_H
+#define LATEST_FRAME_MAILBOX_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * LatestFrameMailbox - 单生产者/单消费者的最新帧信箱
+ * 三缓冲实现：生产者写后台槽位后与中间槽位原子交换，消费者取走时再与中间槽位交换，
+ * 数据通路无锁且不拷贝；未被取走的旧帧直接被新帧覆盖，消费者拿到的总是最新一帧。
+ * 互斥锁仅用于消费者阻塞等待时的唤醒。
+ */
+template <typename T>
+class LatestFrameMailbox {
+public:
+    // 生产者：获取可写槽位(在publish之前一直归生产者所有)
+    T& writeSlot() { return m_slots[m_writeIdx]; }
+
+    // 生产者：发布写好的槽位
+    void publish() {
+        uint8_t prev = m_middle.exchange(static_cast<uint8_t>(m_writeIdx | FRESH_BIT),
+            std::memory_order_acq_rel);
+        m_writeIdx = prev & INDEX_MASK;
+        if (prev & FRESH_BIT) {
+            m_overwrittenCnt.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (m_waiting.load()) {
+            { std::lock_guard<std::mutex> lock(m_waitMtx); }
+            m_waitCond.notify_one();
+        }
+    }
+
+    // 消费者：非阻塞获取最新帧，无新帧返回nullptr。
+    // 返回的指针在下一次take之前有效
+    T* tryTake() {
+        if (!(m_middle.load(std::memory_order_acquire) & FRESH_BIT)) {
+            return nullptr;
+        }
+        uint8_t prev = m_middle.exchange(m_readIdx, std::memory_order_acq_rel);
+        m_readIdx = prev & INDEX_MASK;
+        return &m_slots[m_readIdx];
+    }
+
+    // 消费者：阻塞等待新帧，超时或被中断返回nullptr
+    template <typename Rep, typename Period>
+    T* waitTake(const std::chrono::duration<Rep, Period>& timeout) {
+        if (T* frame = tryTake()) {
+            return frame;
+        }
+        {
+            std::unique_lock<std::mutex> lock(m_waitMtx);
+            m_waiting.store(true);
+            m_waitCond.wait_for(lock, timeout, [this] {
+                return hasFresh() || m_interrupted.load();
+            });
+            m_waiting.store(false);
+        }
+        if (m_interrupted.load()) {
+            return nullptr;
+        }
+        return tryTake();
+    }
+
+    bool hasFresh() const {
+        return (m_middle.load(std::memory_order_acquire) & FRESH_BIT) != 0;
+    }
+
+    // 唤醒阻塞中的消费者(停止或采集失败时)
+    void interrupt() {
+        m_interrupted.store(true);
+        { std::lock_guard<std::mutex> lock(m_waitMtx); }
+        m_waitCond.notify_all();
+    }
+
+    void reset() {
+        m_interrupted.store(false);
+        m_middle.store(1);
+        m_writeIdx = 0;
+        m_readIdx = 2;
+    }
+
+    // 生产者发布后未被消费就被覆盖的帧数
+    uint64_t getOverwrittenCount() const { return m_overwrittenCnt.load(); }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH_BIT = 0x04;
+
+    T m_slots[3];
+    uint8_t m_writeIdx{ 0 };            // 仅生产者访问
+    uint8_t m_readIdx{ 2 };             // 仅消费者访问
+    std::atomic<uint8_t> m_middle{ 1 }; // 中间槽位索引 | 新帧标记
+
+    std::atomic_bool m_waiting{ false };
+    std::atomic_bool m_interrupted{ false };
+    std::atomic<uint64_t> m_overwrittenCnt{ 0 };
+    std::mutex m_waitMtx;
+    std::condition_variable m_waitCond;
+};
+
+#endif // LATEST_FRAME_MAILBOX_H
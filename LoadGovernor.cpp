@@ -0,0 +1,348 @@
+#include "LoadGovernor.h"
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <time.h>
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace {
+
+std::string readFirstLine(const std::filesystem::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+}
+
+#ifdef _WIN32
+// FILETIME以100ns为单位
+uint64_t fileTimeToU64(const FILETIME& ft) {
+    return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+#endif
+
+} // namespace
+
+std::vector<int32_t> LoadGovernorConfig::parseInputSizes(const std::string& text) {
+    std::vector<int32_t> sizes;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        try {
+            // 模型下采样32倍，尺寸需对齐到32
+            const int32_t size = std::stoi(item) / 32 * 32;
+            if (size > 0) {
+                sizes.push_back(size);
+            }
+        }
+        catch (const std::exception&) {
+            MY_SPDLOG_WARN("invalid governor input size: {}", item);
+        }
+    }
+    std::sort(sizes.begin(), sizes.end(), std::greater<int32_t>());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    return sizes;
+}
+
+LoadGovernor::~LoadGovernor() {
+    stop();
+}
+
+void LoadGovernor::start(const LoadGovernorConfig& config, InputSizeSink inputSizeSink) {
+    stop();
+    m_config = config;
+    m_config.maxIntervalScale = (std::max)(1.0, m_config.maxIntervalScale);
+    m_config.cpuBudget = (std::max)(0.01, m_config.cpuBudget);
+    m_inputSizeSink = std::move(inputSizeSink);
+    m_intervalScale.store(1.0);
+    m_inputLevel = 0;
+    m_systemValid = false;
+    m_processValid = false;
+    {
+        std::lock_guard<std::mutex> lock(m_statsMtx);
+        m_stats = LoadGovernorStats();
+    }
+    if (!m_config.enable || m_config.sampleIntervalMs <= 0) {
+        return;
+    }
+    MY_SPDLOG_INFO("load governor start, cpu budget: {}, busy load: {}, max interval scale: {}, input sizes: {}",
+        m_config.cpuBudget, m_config.busyLoad, m_config.maxIntervalScale, m_config.inputSizes.size());
+    m_continue.store(true);
+    m_sampleThd = std::thread(&LoadGovernor::sampleLoop, this);
+}
+
+void LoadGovernor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(m_sampleMtx);
+        m_continue.store(false);
+    }
+    m_sampleCond.notify_all();
+    if (m_sampleThd.joinable()) {
+        m_sampleThd.join();
+    }
+    // 停止后恢复正常检测强度
+    m_intervalScale.store(1.0);
+    if (m_inputLevel > 0 && m_inputSizeSink) {
+        m_inputSizeSink(0);
+    }
+    m_inputLevel = 0;
+    m_inputSizeSink = nullptr;
+}
+
+LoadGovernorStats LoadGovernor::getStats() const {
+    std::lock_guard<std::mutex> lock(m_statsMtx);
+    return m_stats;
+}
+
+bool LoadGovernor::readSystemCpu(CpuTimes& times) {
+#if defined(__linux__)
+    // cpu  user nice system idle iowait irq softirq steal ...
+    std::ifstream in("/proc/stat");
+    std::string label;
+    in >> label;
+    if ("cpu" != label) {
+        return false;
+    }
+    uint64_t value = 0;
+    uint64_t idle = 0;
+    uint64_t total = 0;
+    for (int i = 0; i < 8 && (in >> value); ++i) {
+        total += value;
+        if (3 == i || 4 == i) {
+            idle += value;
+        }
+    }
+    times.busy = total - idle;
+    times.total = total;
+    return total > 0;
+#elif defined(__APPLE__)
+    host_cpu_load_info_data_t info;
+    mach_msg_type_number_t count = HOST_CPU_LOAD_INFO_COUNT;
+    if (KERN_SUCCESS != host_statistics(mach_host_self(), HOST_CPU_LOAD_INFO,
+        reinterpret_cast<host_info_t>(&info), &count)) {
+        return false;
+    }
+    const uint64_t idle = info.cpu_ticks[CPU_STATE_IDLE];
+    times.busy = static_cast<uint64_t>(info.cpu_ticks[CPU_STATE_USER]) + info.cpu_ticks[CPU_STATE_SYSTEM] +
+        info.cpu_ticks[CPU_STATE_NICE];
+    times.total = times.busy + idle;
+    return times.total > 0;
+#elif defined(_WIN32)
+    // 内核时间包含空闲时间
+    FILETIME idleTime, kernelTime, userTime;
+    if (!GetSystemTimes(&idleTime, &kernelTime, &userTime)) {
+        return false;
+    }
+    const uint64_t idle = fileTimeToU64(idleTime);
+    times.total = fileTimeToU64(kernelTime) + fileTimeToU64(userTime);
+    times.busy = times.total > idle ? times.total - idle : 0;
+    return times.total > 0;
+#else
+    (void)times;
+    return false;
+#endif
+}
+
+bool LoadGovernor::readProcessCpu(std::chrono::nanoseconds& cpu) {
+#if defined(__linux__) || defined(__APPLE__)
+    timespec ts{};
+    if (0 != clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts)) {
+        return false;
+    }
+    cpu = std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    return true;
+#elif defined(_WIN32)
+    FILETIME createTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &createTime, &exitTime, &kernelTime, &userTime)) {
+        return false;
+    }
+    cpu = std::chrono::nanoseconds((fileTimeToU64(kernelTime) + fileTimeToU64(userTime)) * 100);
+    return true;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+void LoadGovernor::readBattery(int32_t& onBattery, int32_t& percent) {
+    onBattery = -1;
+    percent = -1;
+#if defined(__linux__)
+    std::error_code ec;
+    const std::filesystem::path root("/sys/class/power_supply");
+    bool hasBattery = false;
+    bool discharging = false;
+    bool mainsOnline = false;
+    for (const auto& entry : std::filesystem::directory_iterator(root, ec)) {
+        const std::string type = readFirstLine(entry.path() / "type");
+        if ("Battery" == type) {
+            hasBattery = true;
+            if ("Discharging" == readFirstLine(entry.path() / "status")) {
+                discharging = true;
+            }
+            const std::string capacity = readFirstLine(entry.path() / "capacity");
+            if (!capacity.empty() && std::all_of(capacity.begin(), capacity.end(), ::isdigit)) {
+                // 多块电池取最低
+                const int32_t value = std::stoi(capacity);
+                percent = percent < 0 ? value : (std::min)(percent, value);
+            }
+        }
+        else if ("Mains" == type || "USB" == type) {
+            mainsOnline |= "1" == readFirstLine(entry.path() / "online");
+        }
+    }
+    if (hasBattery) {
+        onBattery = (discharging && !mainsOnline) ? 1 : 0;
+    }
+    else if (mainsOnline) {
+        onBattery = 0;
+    }
+#elif defined(_WIN32)
+    SYSTEM_POWER_STATUS status;
+    if (!GetSystemPowerStatus(&status)) {
+        return;
+    }
+    // 128表示没有电池，255表示未知
+    const bool hasBattery = 255 != status.BatteryFlag && 0 == (status.BatteryFlag & 128);
+    if (255 != status.ACLineStatus) {
+        onBattery = (hasBattery && 0 == status.ACLineStatus) ? 1 : 0;
+    }
+    if (hasBattery && 255 != status.BatteryLifePercent) {
+        percent = status.BatteryLifePercent;
+    }
+#endif
+}
+
+void LoadGovernor::sampleLoop() {
+    auto last = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(m_sampleMtx);
+    while (m_continue.load()) {
+        if (m_sampleCond.wait_for(lock, std::chrono::milliseconds(m_config.sampleIntervalMs),
+            [this] { return !m_continue.load(); })) {
+            break;
+        }
+        lock.unlock();
+        const auto now = std::chrono::steady_clock::now();
+        sampleOnce(now - last);
+        last = now;
+        lock.lock();
+    }
+}
+
+void LoadGovernor::sampleOnce(std::chrono::steady_clock::duration wall) {
+    const double wallSec = std::chrono::duration<double>(wall).count();
+
+    double systemLoad = -1.0;
+    CpuTimes system;
+    if (readSystemCpu(system)) {
+        if (m_systemValid && system.total > m_lastSystem.total) {
+            systemLoad = static_cast<double>(system.busy - m_lastSystem.busy) / (system.total - m_lastSystem.total);
+        }
+        m_lastSystem = system;
+        m_systemValid = true;
+    }
+
+    double processCpu = -1.0;
+    std::chrono::nanoseconds cpu{ 0 };
+    if (readProcessCpu(cpu)) {
+        if (m_processValid && wallSec > 0.0) {
+            processCpu = std::chrono::duration<double>(cpu - m_lastProcess).count() / wallSec;
+        }
+        m_lastProcess = cpu;
+        m_processValid = true;
+    }
+
+    int32_t onBattery = -1;
+    int32_t batteryPercent = -1;
+    readBattery(onBattery, batteryPercent);
+
+    // 环境决定的最低倍数：繁忙、电池、低电量
+    double envScale = 1.0;
+    std::string reason;
+    if (systemLoad >= m_config.busyLoad) {
+        envScale *= m_config.busyScale;
+        reason += "busy ";
+    }
+    if (1 == onBattery) {
+        const bool low = batteryPercent >= 0 && batteryPercent < m_config.lowBatteryPercent;
+        envScale *= low ? m_config.lowBatteryScale : m_config.batteryScale;
+        reason += low ? "low_battery " : "battery ";
+    }
+
+    // 按本进程CPU反馈：当前倍数下占用为u，则倍数乘以u/预算后占用约等于预算
+    const double current = m_intervalScale.load();
+    double target = envScale;
+    if (processCpu >= 0.0) {
+        const double cpuTarget = current * processCpu / m_config.cpuBudget;
+        if (cpuTarget > target) {
+            target = cpuTarget;
+            reason += "cpu ";
+        }
+    }
+    target = (std::min)((std::max)(target, 1.0), m_config.maxIntervalScale);
+    // 升高立即生效；回落每次走一半，避免负载抖动时来回切换
+    double next = target >= current ? target : current + (target - current) * 0.5;
+    if (next - 1.0 < 0.05) {
+        next = 1.0;
+    }
+
+    // 间隔已到上限仍超预算才降输入尺寸；占用明显低于预算时逐级恢复
+    const int32_t levels = static_cast<int32_t>(m_config.inputSizes.size());
+    int32_t level = m_inputLevel;
+    if (levels > 1 && processCpu >= 0.0) {
+        const bool saturated = next >= m_config.maxIntervalScale - 1e-6;
+        if (saturated && processCpu > m_config.cpuBudget && level + 1 < levels) {
+            ++level;
+        }
+        else if (processCpu < m_config.cpuBudget * 0.5 && level > 0) {
+            --level;
+        }
+    }
+
+    const bool intervalChanged = std::abs(next - current) >= 0.05;
+    if (intervalChanged) {
+        m_intervalScale.store(next);
+    }
+    const bool inputChanged = level != m_inputLevel;
+    if (inputChanged) {
+        m_inputLevel = level;
+        if (m_inputSizeSink) {
+            m_inputSizeSink(0 == level ? 0 : m_config.inputSizes[level]);
+        }
+    }
+    if (reason.empty()) {
+        reason = "normal";
+    }
+    else {
+        reason.pop_back();
+    }
+
+    if (intervalChanged || inputChanged) {
+        MY_SPDLOG_INFO("load governor: system load {:.2f}, process cpu {:.2f}, battery {} ({}%), interval scale {:.2f} -> {:.2f}, input size {}, reason: {}",
+            systemLoad, processCpu, onBattery, batteryPercent, current, next,
+            0 == m_inputLevel ? 0 : m_config.inputSizes[m_inputLevel], reason);
+    }
+
+    std::lock_guard<std::mutex> lock(m_statsMtx);
+    ++m_stats.samples;
+    m_stats.systemLoad = systemLoad;
+    m_stats.processCpu = processCpu;
+    m_stats.onBattery = onBattery;
+    m_stats.batteryPercent = batteryPercent;
+    m_stats.intervalScale = m_intervalScale.load();
+    m_stats.inputSize = 0 == m_inputLevel ? 0 : m_config.inputSizes[m_inputLevel];
+    m_stats.intervalChanges += intervalChanged ? 1 : 0;
+    m_stats.inputChanges += inputChanged ? 1 : 0;
+    m_stats.reason = reason;
+}
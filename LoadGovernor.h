@@ -0,0 +1,106 @@
+#ifndef LOAD_GOVERNOR_H
+#define LOAD_GOVERNOR_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct LoadGovernorConfig {
+    bool enable{ true };
+    int32_t sampleIntervalMs{ 2000 };
+    double cpuBudget{ 0.25 };           // 本进程CPU占用上限，按单核比例
+    double busyLoad{ 0.85 };            // 系统整体CPU占用超过此值视为繁忙
+    double busyScale{ 2.0 };            // 繁忙时检测间隔倍数
+    double batteryScale{ 2.0 };         // 电池供电时检测间隔倍数
+    int32_t lowBatteryPercent{ 20 };
+    double lowBatteryScale{ 4.0 };      // 低电量时检测间隔倍数
+    double maxIntervalScale{ 4.0 };     // 检测间隔倍数上限
+    std::vector<int32_t> inputSizes;    // 模型输入边长阶梯，由大到小；为空不调整输入尺寸
+
+    // "640,512,416,320"
+    static std::vector<int32_t> parseInputSizes(const std::string& text);
+};
+
+struct LoadGovernorStats {
+    uint64_t samples{ 0 };
+    double systemLoad{ 0.0 };           // 最近一个采样周期的系统CPU占用(0~1)
+    double processCpu{ 0.0 };           // 最近一个采样周期本进程CPU占用(单核比例)
+    int32_t onBattery{ -1 };            // -1未知，0外接电源，1电池供电
+    int32_t batteryPercent{ -1 };
+    double intervalScale{ 1.0 };
+    int32_t inputSize{ 0 };             // 0表示使用模型原始尺寸
+    uint64_t intervalChanges{ 0 };
+    uint64_t inputChanges{ 0 };
+    std::string reason;                 // 最近一次调整的原因
+};
+
+/**
+ * LoadGovernor - 按系统负载、本进程CPU和电源状态调整检测强度
+ * 后台线程周期采样/proc/stat(macOS为host_statistics，Windows为GetSystemTimes)、进程CPU时间和
+ * /sys/class/power_supply(Windows为GetSystemPowerStatus)，
+ * 给出检测间隔倍数：至少满足繁忙/电池带来的倍数，同时按本进程CPU与预算之比反馈调节，
+ * 升高立即生效、回落逐步进行；间隔已到上限仍超预算时逐级降低模型输入尺寸，明显低于预算时逐级恢复
+ */
+class LoadGovernor {
+public:
+    using InputSizeSink = std::function<void(int32_t)>;
+
+    static LoadGovernor* getInstance() {
+        static LoadGovernor instance;
+        return &instance;
+    }
+
+    // inputSizeSink在输入尺寸变化时由采样线程调用，0表示恢复模型原始尺寸
+    void start(const LoadGovernorConfig& config, InputSizeSink inputSizeSink);
+    void stop();
+
+    // 检测线程每个节拍读取，无锁
+    double getIntervalScale() const { return m_intervalScale.load(std::memory_order_relaxed); }
+
+    LoadGovernorStats getStats() const;
+
+private:
+    LoadGovernor() = default;
+    ~LoadGovernor();
+    LoadGovernor(const LoadGovernor&) = delete;
+    LoadGovernor& operator=(const LoadGovernor&) = delete;
+
+    struct CpuTimes {
+        uint64_t busy{ 0 };
+        uint64_t total{ 0 };
+    };
+
+    static bool readSystemCpu(CpuTimes& times);
+    static bool readProcessCpu(std::chrono::nanoseconds& cpu);
+    static void readBattery(int32_t& onBattery, int32_t& percent);
+
+    void sampleLoop();
+    void sampleOnce(std::chrono::steady_clock::duration wall);
+
+private:
+    LoadGovernorConfig m_config;
+    InputSizeSink m_inputSizeSink;
+    std::atomic<double> m_intervalScale{ 1.0 };
+    int32_t m_inputLevel{ 0 };          // inputSizes下标，0为最大
+
+    CpuTimes m_lastSystem;
+    bool m_systemValid{ false };
+    std::chrono::nanoseconds m_lastProcess{ 0 };
+    bool m_processValid{ false };
+
+    std::thread m_sampleThd;
+    std::atomic_bool m_continue{ false };
+    std::mutex m_sampleMtx;
+    std::condition_variable m_sampleCond;
+
+    mutable std::mutex m_statsMtx;
+    LoadGovernorStats m_stats;
+};
+
+#endif // LOAD_GOVERNOR_H
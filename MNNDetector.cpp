@@ -3,10 +3,15 @@
 #include <iostream>
 #include <filesystem>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
 #include "MNNDetector.h"
 #include "MyLogger.hpp"
+#include "LatencyStats.h"
 
-MNNDetector::MNNDetector(const std::string& model_path, const std::vector<std::string>& classes)
+MNNDetector::MNNDetector(const std::string& model_path, const std::vector<std::string>& classes,
+    int32_t sessionCount, int32_t maxBatch)
     : class_names(classes) {
 
     MY_SPDLOG_DEBUG("MNNDetector constructor called");
@@ -52,38 +57,78 @@ MNNDetector::MNNDetector(const std::string& model_path, const std::vector<std::s
         // 继续执行，不使用缓存
     }
 
-    // 2. 配置会话，使用OpenCL加速
-    MY_SPDLOG_DEBUG("Configuring OpenCL session...");
+    // 2. 创建单帧会话池
+    if (sessionCount < 1) { sessionCount = 1; }
+    for (int32_t i = 0; i < sessionCount; ++i) {
+        m_sessions.emplace_back(createSessionContext(1));
+        m_freeSessions.push_back(m_sessions.back().get());
+    }
+
+    // 3. 验证模型输入尺寸
+    std::vector<int> input_shape = m_sessions.front()->input_tensor->shape();
+    if (input_shape.size() != 4 || input_shape[0] != 1 || input_shape[1] != 3) {
+        throw std::runtime_error("Invalid input dimensions");
+    }
+    model_input_size = cv::Size(input_shape[3], input_shape[2]); // 宽x高
+
+    // 4. batch会话：把输入resize成[N,3,H,W]，输出首维跟随变化才认为模型支持batch
+    if (maxBatch > 1) {
+        try {
+            std::unique_ptr<SessionContext> batchCtx = createSessionContext(maxBatch);
+            std::vector<int> output_shape = batchCtx->output_tensor->shape();
+            if (!output_shape.empty() && output_shape[0] == maxBatch) {
+                m_batchSession = std::move(batchCtx);
+                m_maxBatch = maxBatch;
+            }
+            else {
+                interpreter->releaseSession(batchCtx->session);
+                MY_SPDLOG_WARN("model does not support batch {}, fallback to session pool", maxBatch);
+            }
+        }
+        catch (const std::exception& e) {
+            MY_SPDLOG_WARN("create batch session failed: {}, fallback to session pool", e.what());
+        }
+    }
+
+    MY_SPDLOG_INFO("Detector initialized - Input: {}x{}, sessions: {}, max batch: {}",
+        model_input_size.width, model_input_size.height, sessionCount, m_maxBatch);
+}
+
+std::unique_ptr<MNNDetector::SessionContext> MNNDetector::createSessionContext(int32_t batch) {
+    // 配置会话，使用OpenCL加速
+    MY_SPDLOG_DEBUG("Configuring OpenCL session, batch {}...", batch);
     MNN::ScheduleConfig config;
     config.type = MNN_FORWARD_OPENCL;
     MNN::BackendConfig backend_config;
     backend_config.precision = MNN::BackendConfig::Precision_High;
     config.backendConfig = &backend_config;
 
-    // 3. 创建会话
-    MY_SPDLOG_DEBUG("Creating MNN session...");
-    session = interpreter->createSession(config);
-    
-    if (!session) {
+    std::unique_ptr<SessionContext> ctx = std::make_unique<SessionContext>();
+    ctx->session = interpreter->createSession(config);
+    if (!ctx->session) {
         MY_SPDLOG_ERROR("Failed to create MNN session");
         throw std::runtime_error("Failed to create MNN session");
     }
-    MY_SPDLOG_DEBUG("MNN session created successfully");
 
-    // 4. 获取输入输出张量
-    input_tensor = interpreter->getSessionInput(session, "images");
-    output_tensor = interpreter->getSessionOutput(session, "output0");
-
-    // 5. 验证模型输入尺寸
-    std::vector<int> input_shape = input_tensor->shape();
-    if (input_shape.size() != 4 || input_shape[0] != 1 || input_shape[1] != 3) {
-        throw std::runtime_error("Invalid input dimensions");
+    // 获取输入输出张量
+    ctx->input_tensor = interpreter->getSessionInput(ctx->session, "images");
+    if (batch > 1) {
+        std::vector<int> shape = ctx->input_tensor->shape();
+        if (shape.size() != 4) {
+            throw std::runtime_error("Invalid input dimensions");
+        }
+        interpreter->resizeTensor(ctx->input_tensor, { batch, shape[1], shape[2], shape[3] });
+        interpreter->resizeSession(ctx->session);
+        ctx->batchHost.reset(new MNN::Tensor(ctx->input_tensor, MNN::Tensor::CAFFE));
+        ctx->slotHost.reset(MNN::Tensor::create<float>({ 1, shape[1], shape[2], shape[3] }, nullptr, MNN::Tensor::CAFFE));
     }
-    model_input_size = cv::Size(input_shape[3], input_shape[2]); // 宽x高
-    m_targetSize = model_input_size;
+    ctx->output_tensor = interpreter->getSessionOutput(ctx->session, "output0");
+    ctx->batch = batch;
+    ctx->inputSize = cv::Size(ctx->input_tensor->width(), ctx->input_tensor->height());
+    ctx->letterboxes.resize(batch);
 
-    // 6. 初始化预处理
-    m_pretreat = std::shared_ptr<MNN::CV::ImageProcess>(
+    // 初始化预处理
+    ctx->pretreat = std::shared_ptr<MNN::CV::ImageProcess>(
         MNN::CV::ImageProcess::create(
             MNN::CV::BGR,
             MNN::CV::RGB,
@@ -92,83 +137,150 @@ MNNDetector::MNNDetector(const std::string& model_path, const std::vector<std::s
         ),
         MNN::CV::ImageProcess::destroy
         );
+    MY_SPDLOG_DEBUG("MNN session created successfully");
+    return ctx;
+}
 
-    MY_SPDLOG_INFO("Detector initialized - Input: {}x{}", model_input_size.width, model_input_size.height);
+MNNDetector::SessionContext* MNNDetector::acquireSession() {
+    std::unique_lock<std::mutex> lock(m_sessionMtx);
+    m_sessionCond.wait(lock, [this] { return !m_freeSessions.empty(); });
+    SessionContext* ctx = m_freeSessions.back();
+    m_freeSessions.pop_back();
+    return ctx;
 }
 
-MNNDetector::~MNNDetector() {
-    
-    interpreter->updateCacheFile(session);
-    MY_SPDLOG_DEBUG("update cache file");
+void MNNDetector::releaseSession(SessionContext* ctx) {
+    {
+        std::lock_guard<std::mutex> lock(m_sessionMtx);
+        m_freeSessions.push_back(ctx);
+    }
+    m_sessionCond.notify_one();
 }
 
-void MNNDetector::PreprocessImage(const cv::Mat& src) {
-    // 仅在初始化时计算一次缩放参数和内存分配
-    if (!m_preprocessInitialized) {
-        // 计算缩放比例
-        m_scaleFactor = std::min(
-            static_cast<float>(m_targetSize.width) / src.cols,
-            static_cast<float>(m_targetSize.height) / src.rows
-        );
+void MNNDetector::setInputSize(int32_t side) {
+    m_requestedSide.store(side > 0 ? side / 32 * 32 : 0);
+}
 
-        // 计算缩放后的尺寸
-        m_newSize = cv::Size(
-            static_cast<int>(src.cols * m_scaleFactor),
-            static_cast<int>(src.rows * m_scaleFactor)
-        );
+cv::Size MNNDetector::getInputSize() const {
+    const int32_t side = m_requestedSide.load();
+    const int32_t modelSide = (std::max)(model_input_size.width, model_input_size.height);
+    if (side <= 0 || side >= modelSide) {
+        return model_input_size;
+    }
+    // 长边取side，短边按模型宽高比缩放并对齐到32
+    auto scaled = [&](int32_t length) {
+        return (std::max)(32, (length * side / modelSide + 16) / 32 * 32);
+    };
+    return cv::Size(scaled(model_input_size.width), scaled(model_input_size.height));
+}
 
-        // 计算填充
-        m_padTop = (m_targetSize.height - m_newSize.height) / 2;
-        m_padLeft = (m_targetSize.width - m_newSize.width) / 2;
-        m_padBottom = m_targetSize.height - m_newSize.height - m_padTop;
-        m_padRight = m_targetSize.width - m_newSize.width - m_padLeft;
+void MNNDetector::ensureInputSize(SessionContext& ctx) {
+    const cv::Size target = getInputSize();
+    if (target == ctx.inputSize) {
+        return;
+    }
+    auto begin = std::chrono::steady_clock::now();
+    interpreter->resizeTensor(ctx.input_tensor, { ctx.batch, 3, target.height, target.width });
+    interpreter->resizeSession(ctx.session);
+    ctx.output_tensor = interpreter->getSessionOutput(ctx.session, "output0");
+    if (ctx.batch > 1) {
+        ctx.batchHost.reset(new MNN::Tensor(ctx.input_tensor, MNN::Tensor::CAFFE));
+        ctx.slotHost.reset(MNN::Tensor::create<float>({ 1, 3, target.height, target.width }, nullptr, MNN::Tensor::CAFFE));
+    }
+    // letterbox和预处理缓存按新尺寸重新计算
+    ctx.letterboxes.assign(ctx.batch, Letterbox());
+    ctx.processed.release();
+    MY_SPDLOG_INFO("detector session (batch {}) input {}x{} -> {}x{}, resize spend: {} ms", ctx.batch,
+        ctx.inputSize.width, ctx.inputSize.height, target.width, target.height,
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count());
+    ctx.inputSize = target;
+}
 
-        // 预分配处理后的图像缓存区 - 确保连续内存
-        m_processed = cv::Mat(m_targetSize.height, m_targetSize.width, src.type(), cv::Scalar(144, 144, 144));
+MNNDetector::~MNNDetector() {
+    if (!m_sessions.empty()) {
+        interpreter->updateCacheFile(m_sessions.front()->session);
+        MY_SPDLOG_DEBUG("update cache file");
+    }
+}
 
-        // 验证内存连续性
-        CV_Assert(m_processed.isContinuous() && "m_processed must be continuous memory");
+void MNNDetector::updateLetterbox(Letterbox& lb, const cv::Mat& src, const cv::Size& targetSize) {
+    // 仅在输入尺寸变化时重新计算缩放参数(多路摄像头分辨率可能不同)
+    if (lb.srcSize == src.size()) {
+        return;
+    }
+    lb.srcSize = src.size();
+
+    // 计算缩放比例
+    lb.scaleFactor = std::min(
+        static_cast<float>(targetSize.width) / src.cols,
+        static_cast<float>(targetSize.height) / src.rows
+    );
+
+    // 计算缩放后的尺寸
+    lb.newSize = cv::Size(
+        static_cast<int>(src.cols * lb.scaleFactor),
+        static_cast<int>(src.rows * lb.scaleFactor)
+    );
+
+    // 计算填充
+    lb.padTop = (targetSize.height - lb.newSize.height) / 2;
+    lb.padLeft = (targetSize.width - lb.newSize.width) / 2;
+
+    // 预计算目标ROI区域
+    lb.targetROI = cv::Rect(lb.padLeft, lb.padTop, lb.newSize.width, lb.newSize.height);
+}
 
-        // 预计算目标ROI区域
-        m_targetROI = cv::Rect(m_padLeft, m_padTop, m_newSize.width, m_newSize.height);
+void MNNDetector::PreprocessImage(SessionContext& ctx, const cv::Mat& src, int32_t slot, MNN::Tensor* dst) {
+    Letterbox& lb = ctx.letterboxes[slot];
+    updateLetterbox(lb, src, ctx.inputSize);
 
-        m_preprocessInitialized = true;
+    // 预分配处理后的图像缓存区 - 确保连续内存
+    if (ctx.processed.empty() || ctx.processed.type() != src.type()) {
+        ctx.processed = cv::Mat(ctx.inputSize.height, ctx.inputSize.width, src.type(), cv::Scalar(144, 144, 144));
+        CV_Assert(ctx.processed.isContinuous() && "processed must be continuous memory");
+    }
+    else {
+        // 缓存区由批内各路共用，上一路的ROI可能覆盖了本路的边框，每次重新填充ROI以外的部分
+        const cv::Scalar padColor(144, 144, 144);
+        const cv::Rect& r = lb.targetROI;
+        const int width = ctx.inputSize.width;
+        const int height = ctx.inputSize.height;
+        if (r.y > 0) {
+            ctx.processed(cv::Rect(0, 0, width, r.y)).setTo(padColor);
+        }
+        if (r.y + r.height < height) {
+            ctx.processed(cv::Rect(0, r.y + r.height, width, height - r.y - r.height)).setTo(padColor);
+        }
+        if (r.x > 0) {
+            ctx.processed(cv::Rect(0, r.y, r.x, r.height)).setTo(padColor);
+        }
+        if (r.x + r.width < width) {
+            ctx.processed(cv::Rect(r.x + r.width, r.y, width - r.x - r.width, r.height)).setTo(padColor);
+        }
     }
-
-    // 获取目标ROI区域引用
-    cv::Mat roi = m_processed(m_targetROI);
 
     // 直接将源图像缩放到ROI区域
-    cv::resize(src, roi, m_newSize, 0, 0, cv::INTER_LINEAR);
-
-    m_pretreat->convert(m_processed.data, m_targetSize.width, m_targetSize.height, 0, input_tensor);
-}
+    cv::Mat roi = ctx.processed(lb.targetROI);
+    cv::resize(src, roi, lb.newSize, 0, 0, cv::INTER_LINEAR);
 
-void MNNDetector::infer() {
-    interpreter->runSession(session);
+    ctx.pretreat->convert(ctx.processed.data, ctx.inputSize.width, ctx.inputSize.height, 0, dst);
 }
 
-std::vector<Detection> MNNDetector::postprocess(const cv::Mat& src) {
-    // 1. 获取输出数据
-    MNN::Tensor output_host(output_tensor, output_tensor->getDimensionType());
-    output_tensor->copyToHostTensor(&output_host);
-    float* output_data = output_host.host<float>();
+std::vector<Detection> MNNDetector::postprocess(const float* output_data, int num_boxes, int num_attrs,
+    const Letterbox& lb) {
+    const int num_classes = num_attrs - 5; // 85 - 5 = 80
+    const cv::Size& srcSize = lb.srcSize;
 
-    // 2. 解析输出形状 [1, num_boxes, 85]
-    auto output_shape = output_tensor->shape();
-    const int num_boxes = output_shape[1];
-    const int num_classes = output_shape[2] - 5; // 85 - 5 = 80
-
-    // 3. 存储检测结果
+    // 存储检测结果
     std::vector<Detection> detections;
 
     for (int i = 0; i < num_boxes; i++) {
-        float* box_data = output_data + i * (num_classes + 5);
+        const float* box_data = output_data + i * num_attrs;
         float conf = box_data[4];
         if (conf < m_score_threshold) continue;
 
         // 获取类别
-        float* class_probs = box_data + 5;
+        const float* class_probs = box_data + 5;
         int class_id = std::max_element(class_probs, class_probs + num_classes) - class_probs;
         float class_conf = class_probs[class_id];
         float confidence = conf * class_conf;
@@ -180,21 +292,14 @@ std::vector<Detection> MNNDetector::postprocess(const cv::Mat& src) {
         float cy = box_data[1];
         float w = box_data[2];
         float h = box_data[3];
-#if 0
-        float x1 = ((cx - w / 2.0f) - (float)(m_padRight - m_padLeft)) / m_scaleFactor;
-        float y1 = ((cy - h / 2.0f) - (float)(m_padBottom - m_padTop)) / m_scaleFactor;
-        float x2 = ((cx + w / 2.0f) - (float)(m_padRight - m_padLeft)) / m_scaleFactor;
-        float y2 = ((cy + h / 2.0f) - (float)(m_padBottom - m_padTop)) / m_scaleFactor;
-#else
-        float x1 = (cx - w / 2.0f - m_padLeft) / m_scaleFactor;
-        float y1 = (cy - h / 2.0f - m_padTop) / m_scaleFactor;
-        float x2 = (cx + w / 2.0f - m_padLeft) / m_scaleFactor;
-        float y2 = (cy + h / 2.0f - m_padTop) / m_scaleFactor;
-#endif
+        float x1 = (cx - w / 2.0f - lb.padLeft) / lb.scaleFactor;
+        float y1 = (cy - h / 2.0f - lb.padTop) / lb.scaleFactor;
+        float x2 = (cx + w / 2.0f - lb.padLeft) / lb.scaleFactor;
+        float y2 = (cy + h / 2.0f - lb.padTop) / lb.scaleFactor;
         x1 = (std::max)(0.0f, x1);
         y1 = (std::max)(0.0f, y1);
-        x2 = (std::min)(x2, (float)(src.cols) - 1.f);
-        y2 = (std::min)(y2, (float)(src.rows) - 1.f);
+        x2 = (std::min)(x2, (float)(srcSize.width) - 1.f);
+        y2 = (std::min)(y2, (float)(srcSize.height) - 1.f);
 
         detections.push_back({
             cv::Rect(x1, y1, x2 - x1, y2 - y1),
@@ -204,7 +309,7 @@ std::vector<Detection> MNNDetector::postprocess(const cv::Mat& src) {
         );
     }
 
-    // 4. NMS处理
+    // NMS处理
     std::vector<Detection> results;
     std::vector<cv::Rect> boxes;
     std::vector<float> scores;
@@ -212,16 +317,7 @@ std::vector<Detection> MNNDetector::postprocess(const cv::Mat& src) {
 
     for (const auto& det : detections) {
         // 准备数据用于NMS
-#if 0
-        boxes.push_back(cv::Rect(
-            static_cast<int>(det.box.x - det.box.width / 2),
-            static_cast<int>(det.box.y - det.box.height / 2),
-            static_cast<int>(det.box.width),
-            static_cast<int>(det.box.height)
-        ));
-#else
         boxes.emplace_back(det.box);
-#endif
         scores.emplace_back(det.conf);
     }
 
@@ -234,57 +330,83 @@ std::vector<Detection> MNNDetector::postprocess(const cv::Mat& src) {
     return results;
 }
 
-void MNNDetector::visualize_results(cv::Mat& frame, const std::vector<Detection>& detections) {
-    const std::vector<cv::Scalar> colors = {
-        {0, 0, 255}, {0, 255, 0}, {255, 0, 0},
-        {0, 255, 255}, {255, 0, 255}
-    };
-
-    for (const auto& det : detections) {
-        if (det.box.area() <= 0) continue;  // 脤酶鹿媒脦脼脨搂戮脴脨脦
-
-        cv::Scalar color = colors[det.class_id % colors.size()];
-        cv::rectangle(frame, det.box, color, 2);
-
-        // 麓麓陆篓卤锚脟漏
-        std::string label = class_names.empty() ?
-            "Class " + std::to_string(det.class_id) :
-            class_names[det.class_id];
-        label += cv::format(" %.2f", det.conf);
-
-        // 录脝脣茫脦脛卤戮脦禄脰脙
-        int baseline = 0;
-        cv::Size text_size = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 0.6, 1, &baseline);
-        cv::Point text_origin(det.box.x, det.box.y - 5);
-
-        // 脠路卤拢脦脛卤戮脦禄脰脙脭脷脥录脧帽脛脷
-        if (text_origin.y < 10) text_origin.y = det.box.y + 20;
-
-        // 禄忙脰脝脦脛卤戮卤鲁戮掳
-        cv::rectangle(frame,
-            cv::Rect(text_origin.x, text_origin.y - text_size.height,
-                text_size.width, text_size.height + 5),
-            color, cv::FILLED);
-
-        // 禄忙脰脝脦脛卤戮
-        cv::putText(frame, label,
-            cv::Point(text_origin.x, text_origin.y),
-            cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 255), 1);
+std::vector<Detection> MNNDetector::detect(const cv::Mat& frame) {
+    SessionContext* ctx = acquireSession();
+    std::vector<Detection> results;
+    try {
+        ensureInputSize(*ctx);
+        // 处理流程
+        LatencyStats* latency = LatencyStats::getInstance();
+        auto t0 = std::chrono::steady_clock::now();
+        PreprocessImage(*ctx, frame, 0, ctx->input_tensor);
+        auto t1 = std::chrono::steady_clock::now();
+        interpreter->runSession(ctx->session);
+
+        // 输出形状 [1, num_boxes, 85]
+        MNN::Tensor output_host(ctx->output_tensor, ctx->output_tensor->getDimensionType());
+        ctx->output_tensor->copyToHostTensor(&output_host);
+        auto output_shape = ctx->output_tensor->shape();
+        auto t2 = std::chrono::steady_clock::now();
+        results = postprocess(output_host.host<float>(), output_shape[1], output_shape[2], ctx->letterboxes[0]);
+        latency->record(LatencyStage::Preprocess, t1 - t0);
+        latency->record(LatencyStage::Inference, t2 - t1);
+        latency->record(LatencyStage::Postprocess, std::chrono::steady_clock::now() - t2);
     }
+    catch (...) {
+        releaseSession(ctx);
+        throw;
+    }
+    releaseSession(ctx);
+    return results;
 }
 
-std::vector<Detection> MNNDetector::detect(cv::Mat& frame, bool visualize) {
-
-    // 麓娄脌铆脕梅鲁脤
-    PreprocessImage(frame);
-    infer();
-    auto detections = postprocess(frame);
-
-    // 驴脡脩隆碌脛驴脡脢脫禄炉
-    if (visualize) {
-        visualize_results(frame, detections);
+std::vector<std::vector<Detection>> MNNDetector::detectBatch(const std::vector<cv::Mat>& frames) {
+    std::vector<std::vector<Detection>> results;
+    results.reserve(frames.size());
+    if (!m_batchSession || frames.size() <= 1) {
+        for (const auto& frame : frames) {
+            results.emplace_back(detect(frame));
+        }
+        return results;
     }
 
-    return detections;
+    std::lock_guard<std::mutex> lock(m_batchMtx);
+    SessionContext& ctx = *m_batchSession;
+    ensureInputSize(ctx);
+    size_t offset = 0;
+    while (offset < frames.size()) {
+        const int32_t count = static_cast<int32_t>((std::min)(frames.size() - offset, static_cast<size_t>(ctx.batch)));
+
+        // 每帧预处理到单槽位host张量，再拷到batch host张量对应位置；未用满的槽位保留旧数据，输出忽略
+        // batch阶段耗时按整批记录一次
+        LatencyStats* latency = LatencyStats::getInstance();
+        auto t0 = std::chrono::steady_clock::now();
+        const size_t slotElems = static_cast<size_t>(ctx.slotHost->elementSize());
+        float* batchData = ctx.batchHost->host<float>();
+        for (int32_t i = 0; i < count; ++i) {
+            PreprocessImage(ctx, frames[offset + i], i, ctx.slotHost.get());
+            std::memcpy(batchData + i * slotElems, ctx.slotHost->host<float>(), slotElems * sizeof(float));
+        }
+        ctx.input_tensor->copyFromHostTensor(ctx.batchHost.get());
+        auto t1 = std::chrono::steady_clock::now();
+        interpreter->runSession(ctx.session);
+
+        // 输出形状 [N, num_boxes, 85]
+        MNN::Tensor output_host(ctx.output_tensor, ctx.output_tensor->getDimensionType());
+        ctx.output_tensor->copyToHostTensor(&output_host);
+        auto output_shape = ctx.output_tensor->shape();
+        const int num_boxes = output_shape[1];
+        const int num_attrs = output_shape[2];
+        const float* outData = output_host.host<float>();
+        auto t2 = std::chrono::steady_clock::now();
+        for (int32_t i = 0; i < count; ++i) {
+            results.emplace_back(postprocess(outData + static_cast<size_t>(i) * num_boxes * num_attrs,
+                num_boxes, num_attrs, ctx.letterboxes[i]));
+        }
+        latency->record(LatencyStage::Preprocess, t1 - t0);
+        latency->record(LatencyStage::Inference, t2 - t1);
+        latency->record(LatencyStage::Postprocess, std::chrono::steady_clock::now() - t2);
+        offset += count;
+    }
+    return results;
 }
-
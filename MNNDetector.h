@@ -6,62 +6,97 @@
 #include <MNN/Tensor.hpp>
 #include <MNN/ImageProcess.hpp>
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <filesystem>
 
-
-// 检测结果结构体
-struct Detection {
-    cv::Rect box;       // 边界框
-    float conf;         // 置信度
-    int class_id;       // 类别ID
-};
+#include "Detection.h"
 
 class MNNDetector {
 public:
     // 构造函数
+    // sessionCount: 单帧推理会话数，多路摄像头可并发推理
+    // maxBatch: >1时额外创建batch会话，模型不支持动态batch时自动退回1
     MNNDetector(const std::string& model_path,
-        const std::vector<std::string>& classes = {});
+        const std::vector<std::string>& classes = {},
+        int32_t sessionCount = 1, int32_t maxBatch = 1);
 
     // 析构函数
     ~MNNDetector();
 
-    // 执行检测（预处理->推理->后处理->坐标转换）
-    std::vector<Detection> detect(cv::Mat& frame, bool visualize = false);
+    // 执行检测（预处理->推理->后处理->坐标转换），线程安全，从会话池取空闲会话
+    // 可视化已移至DebugVisualizer渲染线程，检测线程不再绘制
+    std::vector<Detection> detect(const cv::Mat& frame);
+
+    // 多帧一次推理；不支持batch时逐帧走会话池
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& frames);
+
+    // 调整模型输入边长(按模型宽高比，对齐到32)，<=0或不小于模型尺寸时恢复原始尺寸；
+    // 各会话在下一次推理前各自resize，不阻塞正在进行的推理
+    void setInputSize(int32_t side);
+    cv::Size getInputSize() const;
+
+    const std::vector<std::string>& getClassNames() const { return class_names; }
+    int32_t getMaxBatch() const { return m_maxBatch; }
 
 private:
-    void PreprocessImage(const cv::Mat& src);
-    void infer();
-    std::vector<Detection> postprocess(const cv::Mat& src);
-    void visualize_results(cv::Mat& frame, const std::vector<Detection>& detections);
+    // letterbox参数，随输入帧尺寸变化重新计算
+    struct Letterbox {
+        cv::Size srcSize;
+        float scaleFactor{ 1.0f };   // 缩放比例
+        int padTop{ 0 };             // 上边填充
+        int padLeft{ 0 };            // 左边填充
+        cv::Size newSize;            // 缩放后尺寸
+        cv::Rect targetROI;
+    };
+
+    // 每个会话独立的张量、预处理器和缓存，不同会话可在不同线程并发推理
+    struct SessionContext {
+        MNN::Session* session{ nullptr };
+        MNN::Tensor* input_tensor{ nullptr };
+        MNN::Tensor* output_tensor{ nullptr };
+        std::shared_ptr<MNN::CV::ImageProcess> pretreat;
+        cv::Mat processed;                       // 预处理后的图像缓存
+        std::vector<Letterbox> letterboxes;      // 每个batch槽位一个
+        std::unique_ptr<MNN::Tensor> batchHost;  // batch会话的host输入
+        std::unique_ptr<MNN::Tensor> slotHost;   // 单个槽位的host输入
+        int32_t batch{ 1 };
+        cv::Size inputSize;                      // 当前输入张量的宽x高
+    };
+
+    std::unique_ptr<SessionContext> createSessionContext(int32_t batch);
+    SessionContext* acquireSession();
+    void releaseSession(SessionContext* ctx);
+    void ensureInputSize(SessionContext& ctx);
+
+    void updateLetterbox(Letterbox& lb, const cv::Mat& src, const cv::Size& targetSize);
+    void PreprocessImage(SessionContext& ctx, const cv::Mat& src, int32_t slot, MNN::Tensor* dst);
+    std::vector<Detection> postprocess(const float* output_data, int num_boxes, int num_attrs,
+        const Letterbox& lb);
 
 private:
     // MNN相关组件
     std::shared_ptr<MNN::Interpreter> interpreter;
-    std::shared_ptr<MNN::CV::ImageProcess> m_pretreat;
-    MNN::Session* session;
-    MNN::Tensor* input_tensor;
-    MNN::Tensor* output_tensor;
 
+    std::vector<std::unique_ptr<SessionContext>> m_sessions;
+    std::vector<SessionContext*> m_freeSessions;
+    std::mutex m_sessionMtx;
+    std::condition_variable m_sessionCond;
+
+    std::unique_ptr<SessionContext> m_batchSession;
+    std::mutex m_batchMtx;
+    int32_t m_maxBatch{ 1 };
 
     // 模型参数
     cv::Size model_input_size;
 
-    cv::Mat m_processed;   // 预处理后的预处理图像缓存
-    cv::Mat m_resized;     // 预处理后的缩放图像缓存
-    cv::Rect m_targetROI;
-    float m_scaleFactor;   // 缩放比例
-    int m_padTop;          // 上边填充
-    int m_padLeft;         // 左边填充
-    int m_padBottom;       // 下边填充
-    int m_padRight;        // 右边填充
-    cv::Size m_newSize;          // 缩放后模型输入尺寸
-    bool m_preprocessInitialized = false; // 标记是否已初始化预处理参数
     const float m_mean[3] = { 0.0f, 0.0f, 0.0f }; // RGB
     const float m_std[3] = { 1.0 / 255.0f, 1.0 / 255.0f, 1.0 / 255.0f };
-    cv::Size m_targetSize = cv::Size(640, 640);
+    std::atomic<int32_t> m_requestedSide{ 0 };   // 0为模型原始尺寸
 
     // 后处理参数
     std::vector<std::string> class_names;
@@ -70,4 +105,3 @@ private:
 };
 
 #endif // MNN_DETECTOR_H
-
@@ -0,0 +1,77 @@
+#include "OcclusionAnalyzer.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+OcclusionAnalyzer::Result OcclusionAnalyzer::analyze(const cv::Mat& bgrFrame) {
+    Result result;
+    if (bgrFrame.empty()) {
+        return result;
+    }
+
+    const int32_t factor = (m_params.downsample >= 8) ? 8 : 4;
+    const cv::Size smallSize((std::max)(bgrFrame.cols / factor, 8), (std::max)(bgrFrame.rows / factor, 8));
+    // 尺寸不变时resize/cvtColor复用已有缓冲
+    cv::resize(bgrFrame, m_small, smallSize, 0, 0, cv::INTER_AREA);
+    if (m_small.channels() == 1) {
+        m_small.copyTo(m_gray);
+    }
+    else {
+        cv::cvtColor(m_small, m_gray, m_small.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    }
+
+    const int rows = m_gray.rows;
+    const int cols = m_gray.cols;
+    // 与原算法一致：4x4网格的中心2x2块
+    const int gridW = cols / 4, gridH = rows / 4;
+    const int cx1 = gridW, cx2 = gridW * 3;
+    const int cy1 = gridH, cy2 = gridH * 3;
+    const int gradThresh = m_params.gradientThreshold;
+
+    uint64_t centerSum = 0;
+    uint64_t edgeCnt = 0;
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t* cur = m_gray.ptr<uint8_t>(y);
+        const bool inCenterRow = (y >= cy1 && y < cy2);
+
+        // 中心块亮度求和：连续uint8累加，编译器可自动向量化
+        if (inCenterRow) {
+            uint32_t rowSum = 0;
+            for (int x = cx1; x < cx2; ++x) {
+                rowSum += cur[x];
+            }
+            centerSum += rowSum;
+        }
+
+        // 梯度能量：中心差分|dx|+|dy|，边界行列跳过
+        if (y == 0 || y == rows - 1) {
+            continue;
+        }
+        const uint8_t* prev = m_gray.ptr<uint8_t>(y - 1);
+        const uint8_t* next = m_gray.ptr<uint8_t>(y + 1);
+        uint32_t rowEdges = 0;
+        for (int x = 1; x < cols - 1; ++x) {
+            int dx = std::abs(static_cast<int>(cur[x + 1]) - static_cast<int>(cur[x - 1]));
+            int dy = std::abs(static_cast<int>(next[x]) - static_cast<int>(prev[x]));
+            rowEdges += static_cast<uint32_t>(dx + dy > gradThresh);
+        }
+        edgeCnt += rowEdges;
+    }
+
+    const uint64_t centerPixels = static_cast<uint64_t>(cx2 - cx1) * static_cast<uint64_t>(cy2 - cy1);
+    result.centerBrightness = centerPixels ? static_cast<double>(centerSum) / centerPixels : 0.0;
+    const uint64_t innerPixels = static_cast<uint64_t>(cols - 2) * static_cast<uint64_t>(rows - 2);
+    result.edgeRatio = innerPixels ? static_cast<double>(edgeCnt) / innerPixels : 0.0;
+
+    // 判定逻辑与原isCameraOccludedByTraditional保持一致
+    if (result.centerBrightness < m_params.brightnessLow) {
+        result.occluded = true;
+    }
+    else if (result.edgeRatio >= m_params.edgeRatioThreshold) {
+        result.occluded = false;
+    }
+    else {
+        result.occluded = result.centerBrightness <= m_params.brightnessHigh;
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+#ifndef OCCLUSION_ANALYZER_H
+#define OCCLUSION_ANALYZER_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+
+/**
+ * OcclusionAnalyzer - 低分辨率摄像头遮挡/亮度分析
+ * 先用INTER_AREA缩小到1/4或1/8再转灰度，然后在小图上单次遍历同时统计
+ * 中心2x2块的平均亮度和梯度能量(|dx|+|dy|超过阈值的像素比例)，代替全分辨率Canny。
+ * 缓冲区在多次调用间复用，非线程安全，每个检测线程持有一个实例
+ */
+class OcclusionAnalyzer {
+public:
+    struct Params {
+        int32_t downsample{ 4 };          // 缩小倍数，4或8
+        double brightnessLow{ 30.01 };    // 中心亮度低于此值直接判定遮挡
+        double brightnessHigh{ 150.01 };  // 边缘少但中心亮度高于此值不判定遮挡
+        int32_t gradientThreshold{ 48 };  // |dx|+|dy|超过此值计为边缘像素
+        double edgeRatioThreshold{ 0.01 };// 边缘像素比例不低于此值判定正常
+    };
+
+    struct Result {
+        bool occluded{ false };
+        double centerBrightness{ 0.0 };
+        double edgeRatio{ 0.0 };
+    };
+
+    void setParams(const Params& params) { m_params = params; }
+    const Params& getParams() const { return m_params; }
+
+    Result analyze(const cv::Mat& bgrFrame);
+
+private:
+    Params m_params;
+    cv::Mat m_small;   // 复用：缩小后的BGR
+    cv::Mat m_gray;    // 复用：缩小后的灰度
+};
+
+#endif // OCCLUSION_ANALYZER_H
@@ -0,0 +1,666 @@
+// PADetect 性能基准程序，与核心库分开构建: make bench
+// 用法: ./padetect_bench [iterations] [width] [height] [evidence_max_width] [evidence_max_height]
+//       ./padetect_bench --replay <video> <model.mnn> [report.json] [--no-prefetch] [--rules <alert_rules.json>]
+//       ./padetect_bench --http [requests] [payload_bytes] [base_url] [ca_cert]
+//       ./padetect_bench --dedup <video> [alert_interval_ms] [hamming] [window_ms]
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <opencv2/opencv.hpp>
+
+#include "AlertRuleEngine.h"
+#include "ImageKernels.h"
+#include "JpegEncoderPool.h"
+#include "FramePool.h"
+#include "EvidenceBatch.h"
+#include "EvidenceDeduper.h"
+#include "HttpClient.h"
+#include "MNNDetector.h"
+#include "OcclusionAnalyzer.h"
+#include "ReplayReport.h"
+#include "VideoPrefetcher.h"
+
+namespace {
+
+constexpr int BENCH_JPEG_QUALITY = 60;
+
+struct BenchStats {
+    double avgMs{ 0.0 };
+    double minMs{ 0.0 };
+    double maxMs{ 0.0 };
+};
+
+BenchStats runBench(int iterations, const std::function<void()>& fn) {
+    std::vector<double> costs;
+    costs.reserve(iterations);
+    fn(); // 预热
+    for (int i = 0; i < iterations; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        fn();
+        costs.push_back(std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - begin).count());
+    }
+    BenchStats stats;
+    if (!costs.empty()) {
+        double sum = 0.0;
+        for (double c : costs) { sum += c; }
+        stats.avgMs = sum / costs.size();
+        stats.minMs = *std::min_element(costs.begin(), costs.end());
+        stats.maxMs = *std::max_element(costs.begin(), costs.end());
+    }
+    return stats;
+}
+
+void printStats(const char* name, const BenchStats& stats) {
+    std::printf("%-40s avg %8.2f ms  min %8.2f ms  max %8.2f ms\n", name, stats.avgMs, stats.minMs, stats.maxMs);
+}
+
+// 带渐变和噪声的合成画面，压缩率接近真实截图
+cv::Mat makeSyntheticFrame(int width, int height, int type) {
+    cv::Mat frame(height, width, type);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::Mat gradient(height, width, type);
+    for (int y = 0; y < height; ++y) {
+        gradient.row(y).setTo(cv::Scalar::all((y * 255) / std::max(1, height - 1)));
+    }
+    cv::addWeighted(frame, 0.3, gradient, 0.7, 0.0, frame);
+    return frame;
+}
+
+void benchJpeg(int iterations, int width, int height) {
+    std::printf("== JPEG encode %dx%d, quality %d, %d iterations\n", width, height, BENCH_JPEG_QUALITY, iterations);
+    cv::Mat screen = makeSyntheticFrame(width, height, CV_8UC4);
+    cv::Mat camera = makeSyntheticFrame(640, 480, CV_8UC3);
+    const std::vector<int> params{ cv::IMWRITE_JPEG_QUALITY, BENCH_JPEG_QUALITY };
+    const std::string tmpPath = "padetect_bench_tmp.jpg";
+
+    printStats("cv::imwrite (BGRA screen)", runBench(iterations, [&]() {
+        cv::imwrite(tmpPath, screen, params);
+    }));
+    printStats("cv::imencode (BGRA screen)", runBench(iterations, [&]() {
+        std::vector<uint8_t> buf;
+        cv::imencode(".jpg", screen, buf, params);
+    }));
+    std::vector<uint8_t> reuseBuf;
+    printStats("JpegEncoderPool::encode (BGRA screen)", runBench(iterations, [&]() {
+        JpegEncoderPool::encode(screen, BENCH_JPEG_QUALITY, reuseBuf);
+    }));
+
+    // 一次告警的屏幕+摄像头证据：串行 vs 线程池并行
+    printStats("serial imwrite screen+camera", runBench(iterations, [&]() {
+        cv::imwrite(tmpPath, screen, params);
+        cv::imwrite(tmpPath, camera, params);
+    }));
+    JpegEncoderPool* pool = JpegEncoderPool::getInstance();
+    pool->start();
+    printStats("pool parallel screen+camera", runBench(iterations, [&]() {
+        auto f1 = pool->submit(screen, BENCH_JPEG_QUALITY);
+        auto f2 = pool->submit(camera, BENCH_JPEG_QUALITY);
+        f1.get();
+        f2.get();
+    }));
+    pool->stop();
+    std::remove(tmpPath.c_str());
+}
+
+// 截图证据缩小：自有BGRA->BGR块平均内核 vs OpenCV两步实现，以及缩小前后的编码耗时和字节数
+void benchEvidenceDownscale(int iterations, int width, int height, int maxWidth, int maxHeight) {
+    std::printf("== evidence downscale %dx%d -> max %dx%d\n", width, height, maxWidth, maxHeight);
+    cv::Mat screen = makeSyntheticFrame(width, height, CV_8UC4);
+    const int32_t factor = ImageKernels::fitDownscaleFactor(width, height, maxWidth, maxHeight);
+    const cv::Size outSize(width / factor, height / factor);
+
+    cv::Mat kernelOut, cvOut, cvTmp;
+    printStats("ImageKernels::downscaleBgraToBgr", runBench(iterations, [&]() {
+        ImageKernels::downscaleBgraToBgr(screen, kernelOut, factor);
+    }));
+    printStats("cv::resize(INTER_AREA) + cvtColor", runBench(iterations, [&]() {
+        cv::resize(screen, cvTmp, outSize, 0, 0, cv::INTER_AREA);
+        cv::cvtColor(cvTmp, cvOut, cv::COLOR_BGRA2BGR);
+    }));
+
+    JpegEncodeResult full, fitted;
+    printStats("encode full resolution", runBench(iterations, [&]() {
+        full = JpegEncoderPool::encodeFitted(screen, BENCH_JPEG_QUALITY, std::move(full.data), 0, 0);
+    }));
+    printStats("downscale + encode", runBench(iterations, [&]() {
+        fitted = JpegEncoderPool::encodeFitted(screen, BENCH_JPEG_QUALITY, std::move(fitted.data), maxWidth, maxHeight);
+    }));
+    std::printf("bytes per screen alert: full %dx%d %zu, fitted %dx%d %zu\n",
+        full.width, full.height, full.data.size(), fitted.width, fitted.height, fitted.data.size());
+}
+
+// 告警类型名，顺序与ImageProcessor的ALERT_TYPE一致
+const char* const REPLAY_ALERT_TYPES[] = { "phone", "peep", "nobody", "occlude", "noconnect", "suspect" };
+
+int32_t replayAlertType(const std::string& name) {
+    for (int32_t i = 0; i < static_cast<int32_t>(sizeof(REPLAY_ALERT_TYPES) / sizeof(REPLAY_ALERT_TYPES[0])); ++i) {
+        if (name == REPLAY_ALERT_TYPES[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// 回放判定使用的规则表：指定规则文件时按alert_rules格式编译，否则与未配置alert_rules时的开关规则一致
+std::shared_ptr<AlertRuleTable> loadReplayRules(const std::string& rulesPath) {
+    if (rulesPath.empty()) {
+        AlertRuleTable::Switches switches;
+        switches.phoneAlert = true;
+        switches.peepAlert = true;
+        switches.occludeAlert = true;
+        switches.nobodyAlert = true;
+        switches.suspectAlert = true;
+        return AlertRuleTable::fromSwitches(switches, replayAlertType);
+    }
+    std::ifstream in(rulesPath);
+    const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::string error;
+    std::shared_ptr<AlertRuleTable> table = AlertRuleTable::compile(json, replayAlertType, error);
+    if (!table) {
+        std::fprintf(stderr, "invalid alert rules %s: %s\n", rulesPath.c_str(), error.c_str());
+    }
+    return table;
+}
+
+// 离线回放吞吐基准：视频全速解码(可预读) -> 推理 -> 与ImageProcessor相同的规则表判定，
+// 判定时钟按视频帧率推进，不等待节拍、不产生告警，输出与test.json中replay字段相同格式的报告
+int benchReplay(const std::string& videoPath, const std::string& modelPath,
+    const std::string& reportPath, bool prefetch, const std::string& rulesPath) {
+    std::printf("== replay %s, model %s, prefetch %d\n", videoPath.c_str(), modelPath.c_str(), prefetch ? 1 : 0);
+    cv::VideoCapture cap(videoPath);
+    if (!cap.isOpened()) {
+        std::fprintf(stderr, "open video failed: %s\n", videoPath.c_str());
+        return 1;
+    }
+    std::shared_ptr<const AlertRuleTable> rules = loadReplayRules(rulesPath);
+    if (!rules) {
+        return 1;
+    }
+    std::unique_ptr<MNNDetector> detector;
+    try {
+        // 类别顺序与模型输出一致(AlertClass)
+        detector = std::make_unique<MNNDetector>(modelPath, std::vector<std::string>{ "face", "lens", "phone" });
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "load model failed: %s\n", e.what());
+        return 1;
+    }
+
+    FramePool framePool;
+    VideoPrefetcher prefetcher;
+    if (prefetch) {
+        prefetcher.start(&cap, &framePool);
+    }
+    OcclusionAnalyzer occlusion;
+    AlertRuleEvaluator evaluator;
+    std::chrono::steady_clock::duration frameStep = std::chrono::milliseconds(40);
+    const double fps = cap.get(cv::CAP_PROP_FPS);
+    if (fps > 0.0) {
+        frameStep = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+    }
+    const auto startTime = std::chrono::steady_clock::now();
+    ReplayReport report;
+    report.begin(videoPath, prefetch, true);
+
+    for (uint64_t index = 0; ; ++index) {
+        ReplayReport::FrameRecord record;
+        FrameHandle frame;
+        auto begin = std::chrono::steady_clock::now();
+        if (prefetch) {
+            if (!prefetcher.pop(frame, record.stageMs[ReplayReport::STAGE_DECODE])) {
+                break;
+            }
+            begin = std::chrono::steady_clock::now();
+        }
+        else {
+            frame = framePool.acquire();
+            if (!cap.read(frame.writable()) || frame.empty()) {
+                break;
+            }
+            record.stageMs[ReplayReport::STAGE_DECODE] = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - begin).count();
+        }
+
+        auto detectBegin = std::chrono::steady_clock::now();
+        record.detections = detector->detect(frame.image());
+        auto decideBegin = std::chrono::steady_clock::now();
+
+        std::array<uint32_t, CLASS_SLOTS> counts{};
+        for (const auto& det : record.detections) {
+            if (det.class_id >= 0 && det.class_id < CLASS_SLOTS) { ++counts[det.class_id]; }
+        }
+        AlertRuleEvaluator::Result result = evaluator.evaluate(rules, counts, [&] {
+            return occlusion.analyze(frame.image()).occluded;
+        }, startTime + frameStep * static_cast<int64_t>(index));
+        record.decision = result.ruleIndex >= 0 ? rules->getRules()[result.ruleIndex].name : "normal";
+
+        auto end = std::chrono::steady_clock::now();
+        record.index = index;
+        record.stageMs[ReplayReport::STAGE_DETECT] = std::chrono::duration<double, std::milli>(decideBegin - detectBegin).count();
+        record.stageMs[ReplayReport::STAGE_DECIDE] = std::chrono::duration<double, std::milli>(end - decideBegin).count();
+        record.stageMs[ReplayReport::STAGE_TOTAL] = (prefetch ? record.stageMs[ReplayReport::STAGE_DECODE] : 0.0) +
+            std::chrono::duration<double, std::milli>(end - begin).count();
+        report.addFrame(std::move(record));
+    }
+    prefetcher.stop();
+    report.end();
+
+    Json::Value root = report.toJson();
+    std::printf("frames %llu, %.2f fps, total p50/p95/p99 %.2f/%.2f/%.2f ms\n",
+        static_cast<unsigned long long>(report.getFrameCount()), root["fps"].asDouble(),
+        root["stages"]["total"]["p50Ms"].asDouble(), root["stages"]["total"]["p95Ms"].asDouble(),
+        root["stages"]["total"]["p99Ms"].asDouble());
+
+    Json::StreamWriterBuilder writer;
+    writer["indentation"] = "  ";
+    std::ofstream out(reportPath);
+    out << Json::writeString(writer, root);
+    std::printf("report written to %s\n", reportPath.c_str());
+    return out.good() ? 0 : 1;
+}
+
+// 回环HTTP服务：支持keep-alive，对每个请求回复{"code":0}，可延迟回复模拟公网往返，只用于上传基准。
+// 批量接口的请求体按EvidenceBatch格式解码校验，失败时回复code 1
+class LoopbackHttpServer {
+public:
+    ~LoopbackHttpServer() { stop(); }
+
+    int start(int replyDelayMs = 0) {
+        m_replyDelayMs = replyDelayMs;
+        m_listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (m_listenFd < 0) {
+            return -1;
+        }
+        int reuse = 1;
+        setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        socklen_t len = sizeof(addr);
+        if (0 != bind(m_listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) || 0 != listen(m_listenFd, 64) ||
+            0 != getsockname(m_listenFd, reinterpret_cast<sockaddr*>(&addr), &len)) {
+            close(m_listenFd);
+            m_listenFd = -1;
+            return -1;
+        }
+        m_acceptThd = std::thread(&LoopbackHttpServer::acceptLoop, this);
+        return ntohs(addr.sin_port);
+    }
+
+    void stop() {
+        if (m_listenFd >= 0) {
+            shutdown(m_listenFd, SHUT_RDWR);
+            close(m_listenFd);
+            m_listenFd = -1;
+        }
+        if (m_acceptThd.joinable()) {
+            m_acceptThd.join();
+        }
+        // 客户端连接可能仍在池中保持，主动断开以结束服务线程，fd在线程结束后统一关闭
+        for (int fd : m_connFds) {
+            shutdown(fd, SHUT_RDWR);
+        }
+        for (auto& thd : m_connThds) {
+            thd.join();
+        }
+        m_connThds.clear();
+        for (int fd : m_connFds) {
+            close(fd);
+        }
+        m_connFds.clear();
+    }
+
+    uint64_t connections() const { return m_connections.load(); }
+    uint64_t batchRecords() const { return m_batchRecords.load(); }
+    uint64_t badBatches() const { return m_badBatches.load(); }
+
+private:
+    void acceptLoop() {
+        while (true) {
+            const int fd = accept(m_listenFd, nullptr, nullptr);
+            if (fd < 0) {
+                break;
+            }
+            ++m_connections;
+            m_connFds.push_back(fd);
+            m_connThds.emplace_back(&LoopbackHttpServer::serve, this, fd);
+        }
+    }
+
+    static std::string makeReply(const std::string& body) {
+        return "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+            std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+    void serve(int fd) {
+        static const std::string okReply = makeReply("{\"code\":0,\"msg\":\"\",\"data\":{}}");
+        std::string buf;
+        char chunk[16384];
+        while (true) {
+            size_t headerEnd = buf.find("\r\n\r\n");
+            while (std::string::npos == headerEnd) {
+                const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    return;
+                }
+                buf.append(chunk, static_cast<size_t>(n));
+                headerEnd = buf.find("\r\n\r\n");
+            }
+            size_t contentLength = 0;
+            std::string headers = buf.substr(0, headerEnd);
+            std::transform(headers.begin(), headers.end(), headers.begin(), ::tolower);
+            const size_t pos = headers.find("content-length:");
+            if (std::string::npos != pos) {
+                contentLength = std::strtoul(headers.c_str() + pos + 15, nullptr, 10);
+            }
+            const size_t total = headerEnd + 4 + contentLength;
+            while (buf.size() < total) {
+                const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) {
+                    return;
+                }
+                buf.append(chunk, static_cast<size_t>(n));
+            }
+            std::string reply = okReply;
+            static const std::string batchRequest = "POST /client/risk/uploadBatch ";
+            if (0 == buf.compare(0, batchRequest.size(), batchRequest)) {
+                std::vector<DecodedEvidenceRecord> records;
+                std::string error;
+                const uint8_t* body = reinterpret_cast<const uint8_t*>(buf.data()) + headerEnd + 4;
+                if (EvidenceBatch::decode(body, contentLength, records, error)) {
+                    m_batchRecords += records.size();
+                }
+                else {
+                    ++m_badBatches;
+                    reply = makeReply("{\"code\":1,\"msg\":\"" + error + "\",\"data\":{}}");
+                }
+            }
+            buf.erase(0, total);
+            if (m_replyDelayMs > 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(m_replyDelayMs));
+            }
+            if (send(fd, reply.data(), reply.size(), 0) < 0) {
+                return;
+            }
+        }
+    }
+
+private:
+    int m_listenFd{ -1 };
+    int m_replyDelayMs{ 0 };
+    std::thread m_acceptThd;
+    std::vector<std::thread> m_connThds;
+    std::vector<int> m_connFds;
+    std::atomic<uint64_t> m_connections{ 0 };
+    std::atomic<uint64_t> m_batchRecords{ 0 };
+    std::atomic<uint64_t> m_badBatches{ 0 };
+};
+
+// 证据上传：每次新建连接(旧行为) vs 共享连接/DNS/TLS缓存，输出吞吐和延迟分位；
+// 再用异步接口对比同时在途1个和多个上传的吞吐
+int benchHttp(int requests, size_t payloadBytes, std::string baseUrl, const std::string& caCert) {
+    LoopbackHttpServer server;
+    const bool loopback = baseUrl.empty();
+    if (loopback) {
+        const int port = server.start();
+        if (port <= 0) {
+            std::fprintf(stderr, "start loopback server failed\n");
+            return 1;
+        }
+        baseUrl = "http://127.0.0.1:" + std::to_string(port);
+    }
+    std::printf("== http upload %s, %d requests, payload %zu bytes\n", baseUrl.c_str(), requests, payloadBytes);
+
+    HttpClient* client = HttpClient::getInstance();
+    client->setHttpClientParam("bench", "bench", "00:00:00:00:00:00", "bench", baseUrl, "bench", caCert);
+    const std::vector<uint8_t> payload(payloadBytes, 0x5A);
+
+    for (bool reuse : { false, true }) {
+        client->setConnectionReuse(reuse);
+        const uint64_t connBefore = server.connections();
+        client->uploadPicData(payload); // 预热
+        std::vector<double> costs;
+        costs.reserve(requests);
+        int failed = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < requests; ++i) {
+            auto reqBegin = std::chrono::steady_clock::now();
+            failed += client->uploadPicData(payload) ? 0 : 1;
+            costs.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - reqBegin).count());
+        }
+        const double totalSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::sort(costs.begin(), costs.end());
+        auto percentile = [&](double p) {
+            return costs.empty() ? 0.0 : costs[std::min(costs.size() - 1, static_cast<size_t>(p * costs.size()))];
+        };
+        std::printf("%-40s %8.1f req/s  p50 %7.2f ms  p99 %7.2f ms  failed %d  connections %llu\n",
+            reuse ? "connection reuse + shared cache" : "new connection per request",
+            totalSec > 0.0 ? requests / totalSec : 0.0, percentile(0.50), percentile(0.99), failed,
+            static_cast<unsigned long long>(server.connections() - connBefore));
+    }
+    client->setConnectionReuse(true);
+
+    // 回环服务每个请求延迟20ms回复，模拟公网往返
+    LoopbackHttpServer slowServer;
+    if (loopback) {
+        const int port = slowServer.start(20);
+        if (port <= 0) {
+            std::fprintf(stderr, "start loopback server failed\n");
+            return 1;
+        }
+        client->setHttpClientParam("bench", "bench", "00:00:00:00:00:00", "bench",
+            "http://127.0.0.1:" + std::to_string(port), "bench", caCert);
+        std::printf("== async upload, server reply delay 20 ms\n");
+    }
+    auto data = std::make_shared<const std::vector<uint8_t>>(payload);
+    for (int concurrency : { 1, 4 }) {
+        client->setMaxConcurrentUploads(concurrency);
+        std::mutex mtx;
+        std::condition_variable cond;
+        int remaining = requests;
+        int failed = 0;
+        auto done = [&](bool success) {
+            std::lock_guard<std::mutex> lock(mtx);
+            failed += success ? 0 : 1;
+            if (0 == --remaining) {
+                cond.notify_all();
+            }
+        };
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < requests; ++i) {
+            if (0 == client->uploadPicDataAsync(data, [&](bool success, bool) { done(success); })) {
+                done(false);
+            }
+        }
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [&] { return 0 == remaining; });
+        const double totalSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        const HttpTransferStats stats = client->getTransferStats();
+        std::printf("async uploads, concurrency %-14d %8.1f req/s  failed %d  peak in flight %zu\n",
+            concurrency, totalSec > 0.0 ? requests / totalSec : 0.0, failed, stats.peakActive);
+    }
+
+    // 离线积压回放：同样的证据逐条上传 vs 每32条合并为一个批量请求
+    constexpr size_t BATCH_RECORDS = 32;
+    client->setMaxConcurrentUploads(3);
+    for (bool batched : { false, true }) {
+        std::mutex mtx;
+        std::condition_variable cond;
+        int remaining = 0;
+        int failed = 0;
+        auto done = [&](bool success) {
+            std::lock_guard<std::mutex> lock(mtx);
+            failed += success ? 0 : 1;
+            if (0 == --remaining) {
+                cond.notify_all();
+            }
+        };
+        const uint64_t recordsBefore = slowServer.batchRecords();
+        int sent = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = 0; i < requests; i += batched ? static_cast<int>(BATCH_RECORDS) : 1) {
+            uint64_t id = 0;
+            {
+                std::lock_guard<std::mutex> lock(mtx);
+                ++remaining;
+            }
+            if (batched) {
+                std::vector<EvidenceRecord> records;
+                for (int j = i; j < requests && records.size() < BATCH_RECORDS; ++j) {
+                    EvidenceRecord record;
+                    record.name = "bench_" + std::to_string(j) + ".jpg";
+                    record.data = data;
+                    records.emplace_back(std::move(record));
+                }
+                auto batch = std::make_shared<EvidenceBatchWriter>();
+                if (batch->prepare(std::move(records), 0)) {
+                    id = client->uploadBatchAsync(batch, [&](bool success, bool) { done(success); });
+                }
+            }
+            else {
+                id = client->uploadPicDataAsync(data, [&](bool success, bool) { done(success); });
+            }
+            ++sent;
+            if (0 == id) {
+                done(false);
+            }
+        }
+        std::unique_lock<std::mutex> lock(mtx);
+        cond.wait(lock, [&] { return 0 == remaining; });
+        const double totalSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::printf("backlog replay, %-26s %8.1f evidence/s  requests %d  failed %d  server decoded %llu\n",
+            batched ? "batches of 32" : "one request each", totalSec > 0.0 ? requests / totalSec : 0.0, sent, failed,
+            static_cast<unsigned long long>(slowServer.batchRecords() - recordsBefore));
+    }
+    return 0;
+}
+
+// 证据去重：按告警间隔从录制视频中取帧当作同一告警的连续证据，
+// 对比不过滤与dHash过滤后的证据张数、编码字节数(即落盘和上传字节数)
+int benchDedup(const std::string& videoPath, int alertIntervalMs, int hamming, int windowMs) {
+    std::printf("== evidence dedup %s, alert every %d ms, hamming %d, window %d ms\n", videoPath.c_str(),
+        alertIntervalMs, hamming, windowMs);
+    cv::VideoCapture cap(videoPath);
+    if (!cap.isOpened()) {
+        std::fprintf(stderr, "open video failed: %s\n", videoPath.c_str());
+        return 1;
+    }
+    double fps = cap.get(cv::CAP_PROP_FPS);
+    if (fps <= 0.0) {
+        fps = 25.0;
+    }
+
+    EvidenceDeduper deduper;
+    EvidenceDeduper::Params params;
+    params.hammingThreshold = hamming;
+    params.windowMs = windowMs;
+    deduper.setParams(params);
+
+    uint64_t frames = 0, allCnt = 0, keptCnt = 0, allBytes = 0, keptBytes = 0;
+    double hashMs = 0.0;
+    int64_t nextAlertMs = 0;
+    JpegEncodeResult encoded;
+    cv::Mat frame;
+    while (cap.read(frame)) {
+        // 按视频时间轴取帧，结果与解码速度无关
+        const int64_t videoMs = static_cast<int64_t>(frames * 1000.0 / fps);
+        ++frames;
+        if (videoMs < nextAlertMs) {
+            continue;
+        }
+        nextAlertMs = videoMs + alertIntervalMs;
+        encoded = JpegEncoderPool::encodeFitted(frame, BENCH_JPEG_QUALITY, std::move(encoded.data), 1920, 1080);
+        if (!encoded.ok) {
+            continue;
+        }
+        ++allCnt;
+        allBytes += encoded.data.size();
+        auto begin = std::chrono::steady_clock::now();
+        const bool keep = deduper.shouldKeep("camera_replay_", frame, videoMs);
+        hashMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        if (keep) {
+            ++keptCnt;
+            keptBytes += encoded.data.size();
+        }
+    }
+    if (0 == allCnt) {
+        std::fprintf(stderr, "no frames sampled\n");
+        return 1;
+    }
+    std::printf("video frames %llu, evidence without dedup %llu (%llu bytes), with dedup %llu (%llu bytes)\n",
+        static_cast<unsigned long long>(frames), static_cast<unsigned long long>(allCnt),
+        static_cast<unsigned long long>(allBytes), static_cast<unsigned long long>(keptCnt),
+        static_cast<unsigned long long>(keptBytes));
+    std::printf("bytes written/uploaded reduced by %.1f%%, dHash %.3f ms per evidence\n",
+        100.0 * (allBytes - keptBytes) / static_cast<double>(allBytes), hashMs / allCnt);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && 0 == std::strcmp(argv[1], "--http")) {
+        const int requests = argc > 2 ? std::max(1, std::atoi(argv[2])) : 500;
+        const size_t payloadBytes = argc > 3 ? static_cast<size_t>(std::max(0, std::atoi(argv[3]))) : 200 * 1024;
+        const std::string baseUrl = argc > 4 ? argv[4] : "";
+        const std::string caCert = argc > 5 ? argv[5] : "";
+        return benchHttp(requests, payloadBytes, baseUrl, caCert);
+    }
+    if (argc > 1 && 0 == std::strcmp(argv[1], "--dedup")) {
+        if (argc < 3) {
+            std::fprintf(stderr, "usage: %s --dedup <video> [alert_interval_ms] [hamming] [window_ms]\n", argv[0]);
+            return 1;
+        }
+        const int alertIntervalMs = argc > 3 ? std::max(1, std::atoi(argv[3])) : 2000;
+        const int hamming = argc > 4 ? std::atoi(argv[4]) : 6;
+        const int windowMs = argc > 5 ? std::max(0, std::atoi(argv[5])) : 60000;
+        return benchDedup(argv[2], alertIntervalMs, hamming, windowMs);
+    }
+    if (argc > 1 && 0 == std::strcmp(argv[1], "--replay")) {
+        if (argc < 4) {
+            std::fprintf(stderr, "usage: %s --replay <video> <model.mnn> [report.json] [--no-prefetch] [--rules <alert_rules.json>]\n", argv[0]);
+            return 1;
+        }
+        std::string reportPath = "replay_report.json";
+        bool prefetch = true;
+        std::string rulesPath;
+        for (int i = 4; i < argc; ++i) {
+            if (0 == std::strcmp(argv[i], "--no-prefetch")) { prefetch = false; }
+            else if (0 == std::strcmp(argv[i], "--rules") && i + 1 < argc) { rulesPath = argv[++i]; }
+            else { reportPath = argv[i]; }
+        }
+        return benchReplay(argv[2], argv[3], reportPath, prefetch, rulesPath);
+    }
+
+    const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    const int width = argc > 2 ? std::atoi(argv[2]) : 3840;
+    const int height = argc > 3 ? std::atoi(argv[3]) : 2160;
+
+    const int maxWidth = argc > 4 ? std::atoi(argv[4]) : 1920;
+    const int maxHeight = argc > 5 ? std::atoi(argv[5]) : 1080;
+
+    benchJpeg(iterations, width, height);
+    benchEvidenceDownscale(iterations, width, height, maxWidth, maxHeight);
+    return 0;
+}
@@ -9,6 +9,9 @@
 #include "ImageProcessor.h"
 #include "MNNDetector.h"
 #include "PicFileUploader.h"
+#include "InferenceScheduler.h"
+#include "LatencyStats.h"
+#include "LoadGovernor.h"
 
 #include <memory>
 #include <functional>
@@ -16,6 +19,7 @@
 #include <cstdint>
 #include <chrono>
 #include <thread>
+#include <sstream>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -41,7 +45,6 @@ PADetectCore::PADetectCore()
     , logger_(nullptr)
     , configParser_(nullptr)
     , detector_(nullptr)
-    , imageProcessor_(nullptr)
     , picUploader_(nullptr)
     , status_(DetectionStatus::Stopped)
     , isInitialized_(false)
@@ -57,6 +60,7 @@ PADetectCore::PADetectCore()
 
 PADetectCore::~PADetectCore() {
     stopDetection();
+    InferenceScheduler::getInstance()->stop();
     if (detector_) {
         delete detector_;
         detector_ = nullptr;
@@ -212,6 +216,34 @@ bool PADetectCore::startDetection() {
         return false;
     }
 
+    // 各阶段耗时周期输出到日志
+    int32_t latencyDumpInterval = 60;
+    if (configParser_ && configParser_->getLogMeta()) {
+        latencyDumpInterval = configParser_->getLogMeta()->getInt32OrDefault("latency_dump_interval", latencyDumpInterval);
+    }
+    LatencyStats::getInstance()->startPeriodicDump(latencyDumpInterval);
+
+    // 按系统负载、本进程CPU和电源状态调整检测间隔和模型输入尺寸
+    LoadGovernorConfig governorConfig;
+    std::shared_ptr<MyMeta> inferMeta = configParser_ ? configParser_->getInferMeta() : nullptr;
+    if (inferMeta) {
+        governorConfig.enable = inferMeta->getBoolOrDefault("governor_enable", governorConfig.enable);
+        governorConfig.sampleIntervalMs = inferMeta->getInt32OrDefault("governor_sample_ms", governorConfig.sampleIntervalMs);
+        governorConfig.cpuBudget = inferMeta->getDoubleOrDefault("governor_cpu_budget", governorConfig.cpuBudget);
+        governorConfig.busyLoad = inferMeta->getDoubleOrDefault("governor_busy_load", governorConfig.busyLoad);
+        governorConfig.busyScale = inferMeta->getDoubleOrDefault("governor_busy_scale", governorConfig.busyScale);
+        governorConfig.batteryScale = inferMeta->getDoubleOrDefault("governor_battery_scale", governorConfig.batteryScale);
+        governorConfig.lowBatteryPercent = inferMeta->getInt32OrDefault("governor_low_battery_percent", governorConfig.lowBatteryPercent);
+        governorConfig.lowBatteryScale = inferMeta->getDoubleOrDefault("governor_low_battery_scale", governorConfig.lowBatteryScale);
+        governorConfig.maxIntervalScale = inferMeta->getDoubleOrDefault("governor_max_interval_scale", governorConfig.maxIntervalScale);
+        governorConfig.inputSizes = LoadGovernorConfig::parseInputSizes(
+            inferMeta->getStringOrDefault("governor_input_sizes", ""));
+    }
+    MNNDetector* detector = detector_;
+    LoadGovernor::getInstance()->start(governorConfig, [detector](int32_t side) {
+        detector->setInputSize(side);
+    });
+
     status_ = DetectionStatus::Running;
     notifyStatusChange(DetectionStatus::Running);
     
@@ -220,9 +252,17 @@ bool PADetectCore::startDetection() {
 
 void PADetectCore::stopDetection() {
     if (status_ == DetectionStatus::Running) {
-        if (imageProcessor_) {
-            imageProcessor_->stop();
+        for (auto& processor : imageProcessors_) {
+            processor->stop();
         }
+        InferenceScheduler::getInstance()->stop();
+        const LoadGovernorStats governorStats = LoadGovernor::getInstance()->getStats();
+        LoadGovernor::getInstance()->stop();
+        MY_SPDLOG_INFO("load governor stats: samples {}, interval changes {}, input changes {}, last scale {:.2f}, last reason: {}",
+            governorStats.samples, governorStats.intervalChanges, governorStats.inputChanges,
+            governorStats.intervalScale, governorStats.reason);
+        LatencyStats::getInstance()->stopPeriodicDump();
+        LatencyStats::getInstance()->dumpToLog(false);
         status_ = DetectionStatus::Stopped;
         notifyStatusChange(DetectionStatus::Stopped);
     }
@@ -253,54 +293,53 @@ void PADetectCore::setSourcePreview(bool enabled) {
 }
 
 void PADetectCore::setAlertEnabled(bool enabled, AlertType alertType) {
-    if (!imageProcessor_) {
-        return;
-    }
-    
-    // 直接调用对应的单独setter方法
-    switch (alertType) {
-        case AlertType::Phone:
-            imageProcessor_->setAlertPhoneEnabled(enabled);
-            break;
-        case AlertType::Peep:
-            imageProcessor_->setAlertPeepEnabled(enabled);
-            break;
-        case AlertType::Suspect:
-            imageProcessor_->setAlertSuspectEnabled(enabled);
-            break;
-        case AlertType::Nobody:
-            imageProcessor_->setAlertNobodyEnabled(enabled);
-            break;
-        case AlertType::Occlude:
-            imageProcessor_->setAlertOccludeEnabled(enabled);
-            break;
-        case AlertType::NoConnect:
-            imageProcessor_->setAlertNoconnectEnabled(enabled);
-            break;
-        default:
-            break;
+    // 各路摄像头的告警开关保持一致
+    for (auto& processor : imageProcessors_) {
+        switch (alertType) {
+            case AlertType::Phone:
+                processor->setAlertPhoneEnabled(enabled);
+                break;
+            case AlertType::Peep:
+                processor->setAlertPeepEnabled(enabled);
+                break;
+            case AlertType::Suspect:
+                processor->setAlertSuspectEnabled(enabled);
+                break;
+            case AlertType::Nobody:
+                processor->setAlertNobodyEnabled(enabled);
+                break;
+            case AlertType::Occlude:
+                processor->setAlertOccludeEnabled(enabled);
+                break;
+            case AlertType::NoConnect:
+                processor->setAlertNoconnectEnabled(enabled);
+                break;
+            default:
+                break;
+        }
     }
 }
 
 bool PADetectCore::getAlertEnabled(AlertType alertType) const {
-    if (!imageProcessor_) {
+    if (imageProcessors_.empty()) {
         return false;
     }
+    const ImageProcessor* processor = imageProcessors_.front().get();
     
     // 根据告警类型获取对应的开关状态
     switch (alertType) {
         case AlertType::Phone:
-            return imageProcessor_->getAlertPhoneEnabled();
+            return processor->getAlertPhoneEnabled();
         case AlertType::Peep:
-            return imageProcessor_->getAlertPeepEnabled();
+            return processor->getAlertPeepEnabled();
         case AlertType::Suspect:
-            return imageProcessor_->getAlertSuspectEnabled();
+            return processor->getAlertSuspectEnabled();
         case AlertType::Nobody:
-            return imageProcessor_->getAlertNobodyEnabled();
+            return processor->getAlertNobodyEnabled();
         case AlertType::Occlude:
-            return imageProcessor_->getAlertOccludeEnabled();
+            return processor->getAlertOccludeEnabled();
         case AlertType::NoConnect:
-            return imageProcessor_->getAlertNoconnectEnabled();
+            return processor->getAlertNoconnectEnabled();
         default:
             return false;
     }
@@ -365,15 +404,27 @@ DetectionStatus PADetectCore::getStatus() const {
     return status_;
 }
 
+std::vector<LatencySnapshot> PADetectCore::getLatencyStats(bool reset) {
+    return LatencyStats::getInstance()->snapshot(reset);
+}
+
+void PADetectCore::dumpLatencyStats() {
+    LatencyStats::getInstance()->dumpToLog(false);
+}
+
+LoadGovernorStats PADetectCore::getLoadGovernorStats() {
+    return LoadGovernor::getInstance()->getStats();
+}
+
 void PADetectCore::setNoFaceLockEnabled(bool enabled) {
-    if (imageProcessor_) {
-        imageProcessor_->setNoFaceLockEnabled(enabled);
+    for (auto& processor : imageProcessors_) {
+        processor->setNoFaceLockEnabled(enabled);
     }
 }
 
 void PADetectCore::setNoFaceLockTimeout(int32_t timeoutMs) {
-    if (imageProcessor_) {
-        imageProcessor_->setNoFaceLockTimeout(timeoutMs);
+    for (auto& processor : imageProcessors_) {
+        processor->setNoFaceLockTimeout(timeoutMs);
     }
 }
 
@@ -399,7 +450,34 @@ MNNDetector* PADetectCore::getDetector() {
 }
 
 ImageProcessor* PADetectCore::getImageProcessor() {
-    return imageProcessor_.get();
+    return imageProcessors_.empty() ? nullptr : imageProcessors_.front().get();
+}
+
+std::vector<std::string> PADetectCore::getCameraIdList() const {
+    std::vector<std::string> cameraIds;
+    // 测试视频回放只需要一路
+    std::shared_ptr<MyMeta> testMeta = configParser_ ? configParser_->getTestMeta() : nullptr;
+    if (testMeta && !testMeta->getStringOrDefault("test_video_path", "").empty()) {
+        cameraIds.emplace_back(cameraId_);
+        return cameraIds;
+    }
+    // camera_ids与camera_id一起放在detectSettings中
+    std::shared_ptr<MyMeta> detectMeta = configParser_ ? configParser_->getDetectMeta() : nullptr;
+    if (detectMeta) {
+        std::stringstream ss(detectMeta->getStringOrDefault("camera_ids", ""));
+        std::string item;
+        while (std::getline(ss, item, ',')) {
+            item.erase(0, item.find_first_not_of(" \t"));
+            item.erase(item.find_last_not_of(" \t") + 1);
+            if (!item.empty()) {
+                cameraIds.emplace_back(item);
+            }
+        }
+    }
+    if (cameraIds.empty()) {
+        cameraIds.emplace_back(cameraId_);
+    }
+    return cameraIds;
 }
 
 // 私有方法实现
@@ -443,9 +521,33 @@ bool PADetectCore::initializeDetector() {
     }
     
     try {
+        // 重新开始检测时释放上一次的检测器，负载调节会回调检测器，需先停止
+        InferenceScheduler::getInstance()->stop();
+        LoadGovernor::getInstance()->stop();
+        if (detector_) {
+            g_mnn_detector = nullptr;
+            delete detector_;
+            detector_ = nullptr;
+        }
+
+        // 会话数默认与摄像头数一致，多路摄像头可并发推理；模型支持batch时合并推理
+        const int32_t cameraCount = static_cast<int32_t>(getCameraIdList().size());
+        int32_t sessionCount = cameraCount;
+        int32_t maxBatch = 1;
+        int32_t batchWaitMs = 5;
+        std::shared_ptr<MyMeta> inferMeta = configParser_ ? configParser_->getInferMeta() : nullptr;
+        if (inferMeta) {
+            sessionCount = inferMeta->getInt32OrDefault("detect_session_count", 0);
+            maxBatch = inferMeta->getInt32OrDefault("detect_max_batch", 1);
+            batchWaitMs = inferMeta->getInt32OrDefault("detect_batch_wait_ms", 5);
+        }
+        if (sessionCount <= 0) {
+            sessionCount = cameraCount;
+        }
+
         // 创建MNN检测器实例
-        const std::vector<std::string> class_names{"lens", "phone", "face"};
-        detector_ = new MNNDetector(modelPath_, class_names);
+        const std::vector<std::string> class_names{"face", "lens", "phone"};  // 与模型输出顺序(AlertClass)一致
+        detector_ = new MNNDetector(modelPath_, class_names, sessionCount, maxBatch);
         if (!detector_) {
             MY_SPDLOG_ERROR("Failed to create MNNDetector instance");
             return false;
@@ -453,6 +555,7 @@ bool PADetectCore::initializeDetector() {
         
         // 设置全局检测器指针
         g_mnn_detector = detector_;
+        InferenceScheduler::getInstance()->start(detector_, batchWaitMs);
         
         MY_SPDLOG_INFO("MNN Detector initialized successfully with model: {}", modelPath_);
         return true;
@@ -465,34 +568,48 @@ bool PADetectCore::initializeDetector() {
 
 bool PADetectCore::initializeImageProcessor() {
     try {
-        // 使用带参数的构造函数创建ImageProcessor
-        imageProcessor_ = std::make_unique<ImageProcessor>(captureInterval_, cameraId_, cameraWidth_, cameraHeight_);
-        if (!imageProcessor_) {
-            MY_SPDLOG_ERROR("Failed to create ImageProcessor instance");
-            return false;
-        }
+        imageProcessors_.clear();
+        const std::vector<std::string> cameraIds = getCameraIdList();
+        for (size_t i = 0; i < cameraIds.size(); ++i) {
+            // 使用带参数的构造函数创建ImageProcessor，每路摄像头独立的判定状态
+            std::unique_ptr<ImageProcessor> processor =
+                std::make_unique<ImageProcessor>(captureInterval_, cameraIds[i], cameraWidth_, cameraHeight_);
+            if (!processor) {
+                MY_SPDLOG_ERROR("Failed to create ImageProcessor instance");
+                return false;
+            }
+            processor->setCameraIndex(static_cast<int32_t>(i));
 
-        // 从配置文件加载参数
-        if (configParser_) {
-            std::shared_ptr<MyMeta> detectMeta = configParser_->getDetectMeta();
-            if (detectMeta) {
-                imageProcessor_->setDetectParam(detectMeta);
+            // 从配置文件加载参数
+            if (configParser_) {
+                std::shared_ptr<MyMeta> detectMeta = configParser_->getDetectMeta();
+                if (detectMeta) {
+                    processor->setDetectParam(detectMeta);
+                }
+                std::shared_ptr<MyMeta> testMeta = configParser_->getTestMeta();
+                if (testMeta) {
+                    processor->setTestParam(testMeta);
+                }
             }
+
+            // 准备图像处理器
+            processor->prepare();
+
+            // 启动图像处理（这里可能会抛出摄像头相关异常）
+            processor->start();
+            imageProcessors_.emplace_back(std::move(processor));
+            MY_SPDLOG_INFO("ImageProcessor {} started with camera: {}", i, cameraIds[i]);
         }
 
-        // 准备图像处理器
-        imageProcessor_->prepare();
-        
-        // 启动图像处理（这里可能会抛出摄像头相关异常）
-        imageProcessor_->start();
-        
         // 等待一小段时间确保工作线程启动
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        
+
         // 检查工作线程状态
-        if (!imageProcessor_->getWorkThreadStatus()) {
-            MY_SPDLOG_ERROR("ImageProcessor work thread failed to start properly");
-            return false;
+        for (const auto& processor : imageProcessors_) {
+            if (!processor->getWorkThreadStatus()) {
+                MY_SPDLOG_ERROR("ImageProcessor {} work thread failed to start properly", processor->getCameraIndex());
+                return false;
+            }
         }
 
         
@@ -504,7 +621,7 @@ bool PADetectCore::initializeImageProcessor() {
         // }
         
         
-        MY_SPDLOG_INFO("ImageProcessor initialized successfully");
+        MY_SPDLOG_INFO("ImageProcessor initialized successfully, cameras: {}", imageProcessors_.size());
         return true;
     }
     catch (const std::exception& e) {
@@ -651,9 +768,9 @@ void PADetectCore::runMainLoop() {
             break;
         }
         
-        // 检查图像处理线程状态
-        if (imageProcessor_) {
-            if (!imageProcessor_->getWorkThreadStatus()) {
+        // 检查图像处理线程状态，任一路摄像头异常即退出
+        for (const auto& processor : imageProcessors_) {
+            if (!processor->getWorkThreadStatus()) {
                 if (configParser_) {
                     std::shared_ptr<MyMeta> testMeta = configParser_->getTestMeta();
                     std::string testVideoPath = testMeta ? testMeta->getStringOrDefault("test_video_path", "") : "";
@@ -669,6 +786,9 @@ void PADetectCore::runMainLoop() {
                 break;
             }
         }
+        if (status_ != DetectionStatus::Running) {
+            break;
+        }
         
         std::this_thread::sleep_for(std::chrono::milliseconds(1000));
     }
@@ -11,10 +11,13 @@ class MyMeta;
 class MNNDetector;
 class SingletonApp;
 class PicFileUploader;
+struct LatencySnapshot;
+struct LoadGovernorStats;
 
 #include <memory>
 #include <functional>
 #include <string>
+#include <vector>
 #include <cstdint>
 
 // 检测结果结构体
@@ -106,6 +109,12 @@ public:
     
     // 获取当前状态
     DetectionStatus getStatus() const;
+
+    // 各阶段耗时统计快照(采集->告警链路)，reset为true时读取后清零
+    std::vector<LatencySnapshot> getLatencyStats(bool reset = false);
+    void dumpLatencyStats();
+    // 负载调节的最近一次采样和调整结果
+    LoadGovernorStats getLoadGovernorStats();
     
     // 锁屏相关方法
     void setNoFaceLockEnabled(bool enabled);
@@ -124,8 +133,9 @@ public:
     // 获取检测器
     MNNDetector* getDetector();
     
-    // 获取图像处理器
+    // 获取图像处理器(主摄像头)
     ImageProcessor* getImageProcessor();
+    size_t getImageProcessorCount() const { return imageProcessors_.size(); }
     
     // 基于main.cpp的完整业务逻辑方法
     bool verifyOnlineKey();
@@ -147,6 +157,9 @@ private:
     void notifyDetectionResult(const DetectionResult& result);
     void notifyAlert(AlertType alertType);
     void notifyStatusChange(DetectionStatus status, const std::string& errorMessage = "");
+
+    // 解析配置中的摄像头列表(camera_ids，逗号分隔)，为空时使用cameraId_
+    std::vector<std::string> getCameraIdList() const;
     
     // 检查授权过期
     bool isAfterTargetDate();
@@ -162,7 +175,7 @@ private:
     MySpdlog* logger_;
     ConfigParser* configParser_;
     MNNDetector* detector_;
-    std::unique_ptr<ImageProcessor> imageProcessor_;
+    std::vector<std::unique_ptr<ImageProcessor>> imageProcessors_; // 每路摄像头一个，共享检测器
     PicFileUploader* picUploader_;
     
     // 状态变量
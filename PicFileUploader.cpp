@@ -1,18 +1,45 @@
+
+
+#include <algorithm>
 #include <filesystem>
 #include <istream>
 #include <fstream>
 #include <vector>
 #include <sstream>
+#include <chrono>
+#include <utility>
 
 #include "PicFileUploader.h"
+#include "CameraManager.h"
 #include "KeyVerifier.h"
 #include "MyLogger.hpp"
 #include "CommonUtils.h"
+#include "LatencyStats.h"
+#include "EvidenceBatch.h"
 
 namespace fs = std::filesystem;
 
+namespace {
+
+#if ONLINE_MODE
+constexpr bool UPLOAD_ENABLED = true;
+#else
+constexpr bool UPLOAD_ENABLED = false;   // 离线版本只落盘不上传
+#endif
+
+std::string defaultSpillDir() {
+    const char* home = std::getenv("HOME");
+    return std::string(home ? home : "/tmp") + "/.padetect_data";
+}
+
+const char* const UPLOAD_PRIORITY_NAMES[UPLOAD_PRIORITY_COUNT] = { "backlog", "environment", "peep", "suspect", "phone" };
+
+} // namespace
+
 PicFileUploader::PicFileUploader()
+    : m_spillDir(defaultSpillDir())
 {
+    m_store.configure(m_spillDir, m_segmentMaxBytes);
 }
 
 PicFileUploader::~PicFileUploader()
@@ -21,68 +48,558 @@ PicFileUploader::~PicFileUploader()
 
 void PicFileUploader::start()
 {
+    // 多路摄像头共用一个上传线程，按引用计数启停
+    std::lock_guard<std::mutex> lock(m_lifeMtx);
+    if (m_startCount++ > 0) {
+        return;
+    }
     m_httpClient = HttpClient::getInstance();
-    m_scanContinue.store(true);
-    m_scanThd = std::move(std::thread(&PicFileUploader::scanThread, this));
+    recoverSpilled();
+    m_uploadContinue.store(true);
+    m_uploadThd = std::thread(&PicFileUploader::uploadThread, this);
 }
 
 void PicFileUploader::stop()
 {
-    m_scanContinue.store(false);
-    m_scanCond.notify_all();
-    if (m_scanThd.joinable()) { m_scanThd.join(); }
+    std::lock_guard<std::mutex> lock(m_lifeMtx);
+    if (0 == m_startCount || --m_startCount > 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> queueLock(m_queueMtx);
+        m_uploadContinue.store(false);
+    }
+    m_queueCond.notify_all();
+    if (m_uploadThd.joinable()) { m_uploadThd.join(); }
+
+    // 取消在途上传，回调把证据放回队列
+    std::vector<uint64_t> inFlight;
+    {
+        std::lock_guard<std::mutex> queueLock(m_queueMtx);
+        inFlight.assign(m_inFlightIds.begin(), m_inFlightIds.end());
+    }
+    for (uint64_t id : inFlight) {
+        m_httpClient->cancelTransfer(id);
+    }
+
+    // 未上传的证据全部落盘，下次启动时恢复
+    std::unique_lock<std::mutex> queueLock(m_queueMtx);
+    m_queueCond.wait(queueLock, [this] { return m_inFlightIds.empty(); });
+    spillAllLocked();
+    m_store.close();
+    size_t pending = 0;
+    std::string pendingByPriority;
+    for (int32_t priority = UPLOAD_PRIORITY_COUNT - 1; priority >= 0; --priority) {
+        auto& queue = m_queues[priority];
+        pending += queue.size();
+        pendingByPriority += std::string(pendingByPriority.empty() ? "" : ", ")
+            + priorityName(static_cast<UploadPriority>(priority)) + "=" + std::to_string(queue.size());
+        queue.clear();
+    }
+    m_memoryBytes = 0;
+    const SegmentStoreStats storeStats = m_store.getStats();
+    MY_SPDLOG_INFO("uploader stopped, enqueued: {}, uploaded: {} ({} batches), failed: {}, spilled: {}, recovered: {}, left on disk: {} ({}; {} segments, {} bytes), throttled: {} ms",
+        m_stats.enqueued, m_stats.uploaded, m_stats.batches, m_stats.failed, m_stats.spilled, m_stats.recovered, pending,
+        pendingByPriority, storeStats.segments, storeStats.diskBytes, m_stats.throttledMs);
 }
 
-void PicFileUploader::scanThread()
+void PicFileUploader::recoverSpilled()
+{
+    // 旧版本留下的单个证据文件由段存储一并迁入
+    std::vector<SegmentStoredRecord> records;
+    m_store.recover(records);
+    if (records.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    for (auto& record : records) {
+        UploadItem item;
+        item.filePath = (fs::path(m_spillDir) / record.name).string();
+        item.segment = record.ref;
+        // 段记录保存了原优先级，旧版本迁入的文件按文件名推断
+        item.priority = record.priority > UPLOAD_PRIORITY_BACKLOG && record.priority < UPLOAD_PRIORITY_COUNT ?
+            static_cast<UploadPriority>(record.priority) : priorityForName(record.name);
+        item.createdMs = record.createdMs;
+        item.seq = m_nextSeq++;
+        m_queues[item.priority].emplace_back(std::move(item));
+    }
+    m_stats.recovered += records.size();
+    MY_SPDLOG_INFO("recovered {} pending evidence records from {}", records.size(), m_spillDir);
+}
+
+void PicFileUploader::uploadThread()
 {
     MY_SPDLOG_DEBUG(">>>");
-#if ONLINE_MODE
-    while (m_scanContinue.load()) {
-        try {
-            std::vector<fs::path> filesToUpload;
-            {
-                std::unique_lock<std::mutex> lock(m_scanMtx);
-                for (const auto& entry : fs::directory_iterator("./data")) {
-                    if (entry.is_regular_file()) {
-                        filesToUpload.emplace_back(entry.path());
-                    }
-                }
+    if (!UPLOAD_ENABLED) {
+        MY_SPDLOG_DEBUG("<<<");
+        return;
+    }
+    std::unique_lock<std::mutex> lock(m_queueMtx);
+    m_backoff = ReconnectBackoff(m_retryBaseMs, m_retryMaxMs);
+    while (m_uploadContinue.load()) {
+        // 离线时按退避时间重试，新证据不提前唤醒
+        if (m_offline && std::chrono::steady_clock::now() < m_retryAt) {
+            m_queueCond.wait_until(lock, m_retryAt, [this] { return !m_uploadContinue.load() || !m_offline; });
+            continue;
+        }
+        // 离线时只发一个探测上传，恢复在线后再放开并发
+        const size_t limit = m_offline ? 1 : static_cast<size_t>(m_maxInFlight);
+        const bool queued = std::any_of(m_queues.begin(), m_queues.end(),
+            [](const std::deque<UploadItem>& queue) { return !queue.empty(); });
+        if (!queued || m_inFlightIds.size() >= limit) {
+            // 有证据入队、上传完成或离线状态变化时唤醒
+            m_queueCond.wait(lock);
+            continue;
+        }
+        std::chrono::steady_clock::time_point deadline;
+        if (batchWindowOpenLocked(deadline)) {
+            m_queueCond.wait_until(lock, deadline);
+            continue;
+        }
+        // 带宽额度用完时等令牌补足，期间到达的高优先级证据在下一轮先发出
+        const auto now = std::chrono::steady_clock::now();
+        if (!m_bandwidth.ready(now, deadline)) {
+            m_queueCond.wait_until(lock, deadline);
+            m_stats.throttledMs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - now).count());
+            continue;
+        }
+        std::vector<UploadItem> items = takeBatchLocked();
+        if (!items.empty()) {
+            uint64_t bytes = 0;
+            for (const auto& item : items) {
+                bytes += item.data.empty() ? item.segment.payloadSize : item.data.size();
             }
-            for (const auto &file : filesToUpload) {
-                if (m_httpClient->uploadFile(file)) {
-                    fs::remove(file);
-                    MY_SPDLOG_DEBUG("upload file: {} success", file.string());
-                }
-                else {
-                    MY_SPDLOG_ERROR("upload file: {} false", file.string());
+            m_bandwidth.consume(bytes, now);
+            // 未能提交(如HTTPS缺少证书)时按失败处理进入退避
+            dispatchLocked(std::move(items));
+        }
+    }
+    MY_SPDLOG_DEBUG("<<<");
+}
+
+bool PicFileUploader::batchingEnabledLocked() const
+{
+    return m_batchMaxRecords > 1 && m_batchMaxBytes > 0 && !m_offline && m_httpClient->isBatchUploadSupported();
+}
+
+bool PicFileUploader::batchWindowOpenLocked(std::chrono::steady_clock::time_point& deadline) const
+{
+    // 手机告警的证据不等凑批
+    if (!batchingEnabledLocked() || m_batchWindowMs <= 0 || !m_queues[UPLOAD_PRIORITY_PHONE].empty()) {
+        return false;
+    }
+    size_t count = 0;
+    for (const auto& queue : m_queues) {
+        count += queue.size();
+    }
+    if (count >= static_cast<size_t>(m_batchMaxRecords) || m_memoryBytes >= m_batchMaxBytes) {
+        return false;
+    }
+    auto oldest = std::chrono::steady_clock::time_point::max();
+    for (const auto& queue : m_queues) {
+        for (const auto& item : queue) {
+            oldest = (std::min)(oldest, item.enqueueTime);
+        }
+    }
+    deadline = oldest + std::chrono::milliseconds(m_batchWindowMs);
+    return std::chrono::steady_clock::now() < deadline;
+}
+
+std::vector<PicFileUploader::UploadItem> PicFileUploader::takeBatchLocked()
+{
+    std::vector<UploadItem> items;
+    const size_t maxRecords = batchingEnabledLocked() ? static_cast<size_t>(m_batchMaxRecords) : 1;
+    size_t bytes = 0;
+    for (int32_t priority = UPLOAD_PRIORITY_COUNT - 1; priority >= 0 && items.size() < maxRecords; --priority) {
+        auto& queue = m_queues[priority];
+        while (!queue.empty() && items.size() < maxRecords) {
+            UploadItem& front = queue.front();
+            const size_t size = front.data.empty() ? front.segment.payloadSize : front.data.size();
+            // 超出字节上限的留给下一批，单条超限的仍单独发送
+            if (!items.empty() && bytes + size > m_batchMaxBytes) {
+                return items;
+            }
+            bytes += size;
+            m_memoryBytes -= front.data.size();
+            items.emplace_back(std::move(front));
+            queue.pop_front();
+        }
+    }
+    return items;
+}
+
+bool PicFileUploader::dispatchLocked(std::vector<UploadItem>&& items)
+{
+    auto upload = std::make_shared<InFlightUpload>();
+    for (auto& item : items) {
+        std::shared_ptr<std::vector<uint8_t>> data;
+        SegmentRecordView view;
+        if (!item.data.empty()) {
+            data = std::make_shared<std::vector<uint8_t>>(std::move(item.data));
+            item.data = std::vector<uint8_t>();
+        }
+        else if (!m_store.view(item.segment, view)) {
+            // 段文件被外部删除或损坏，继续重试只会一直失败，确认掉让段可以回收
+            MY_SPDLOG_WARN("drop unreadable evidence {}", item.filePath);
+            m_store.acknowledge(item.segment);
+            continue;
+        }
+        upload->items.emplace_back(std::move(item));
+        upload->data.emplace_back(std::move(data));
+        upload->views.emplace_back(std::move(view));
+    }
+    if (upload->items.empty()) {
+        return true;
+    }
+    upload->begin = std::chrono::steady_clock::now();
+    auto callback = [this, upload](bool success, bool cancelled) {
+        onUploadDone(upload, success, cancelled);
+    };
+
+    // 持锁提交，保证完成回调(需要m_queueMtx)在id登记之后执行
+    uint64_t id = 0;
+    const UploadItem& first = upload->items.front();
+    try {
+        if (1 == upload->items.size()) {
+            // 落盘的证据直接发送段文件映射中的报文，不读入内存
+            const SegmentRecordView& view = upload->views[0];
+            id = upload->data[0] ? m_httpClient->uploadPicDataAsync(upload->data[0], callback) :
+                m_httpClient->uploadPicDataAsync(view.payload, view.size, view.owner, callback);
+        }
+        else {
+            std::vector<EvidenceRecord> records;
+            records.reserve(upload->items.size());
+            for (size_t i = 0; i < upload->items.size(); ++i) {
+                const UploadItem& item = upload->items[i];
+                EvidenceRecord record;
+                record.name = fs::path(item.filePath).filename().string();
+                record.priority = static_cast<uint8_t>(item.priority);
+                record.attempts = static_cast<uint8_t>((std::min)(item.attempts, 255u));
+                record.timestampMs = item.createdMs;
+                record.data = upload->data[i];
+                if (!record.data) {
+                    record.view = upload->views[i].payload;
+                    record.size = upload->views[i].size;
+                    record.viewOwner = upload->views[i].owner;
                 }
+                records.emplace_back(std::move(record));
+            }
+            const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            auto batch = std::make_shared<EvidenceBatchWriter>();
+            if (batch->prepare(std::move(records), nowMs)) {
+                id = m_httpClient->uploadBatchAsync(batch, callback);
             }
         }
-        catch (const std::exception &e) {
-            MY_SPDLOG_ERROR("scan upload file exception: {}", e.what());
+    }
+    catch (const std::exception& e) {
+        MY_SPDLOG_ERROR("upload file {} exception: {}", first.filePath, e.what());
+    }
+    if (0 == id) {
+        const std::string what = first.filePath;
+        const uint32_t attempts = first.attempts + 1;
+        for (size_t i = upload->items.size(); i-- > 0;) {
+            if (upload->data[i]) {
+                upload->items[i].data = std::move(*upload->data[i]);
+            }
+            ++upload->items[i].attempts;
+            requeueLocked(std::move(upload->items[i]));
         }
+        enterOfflineLocked(what, attempts);
+        return false;
+    }
+    upload->id = id;
+    m_inFlightIds.insert(id);
+    return true;
+}
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(m_scanInterval));
+void PicFileUploader::onUploadDone(const std::shared_ptr<InFlightUpload>& upload, bool success, bool cancelled)
+{
+    if (!cancelled) {
+        LatencyStats::getInstance()->record(LatencyStage::Upload, std::chrono::steady_clock::now() - upload->begin);
+    }
+    // 提交方持锁登记id，这里拿到锁后id一定已写入
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    m_inFlightIds.erase(upload->id);
+    const size_t count = upload->items.size();
+    if (success) {
+        for (size_t i = 0; i < count; ++i) {
+            if (upload->data[i]) {
+                recycleBuffer(std::move(*upload->data[i]));
+            }
+            else {
+                m_store.acknowledge(upload->items[i].segment);
+            }
+        }
+        MY_SPDLOG_DEBUG("upload file: {} success, records: {}", upload->items.front().filePath, count);
+        m_stats.uploaded += count;
+        m_stats.batches += count > 1 ? 1 : 0;
+        if (m_offline) {
+            MY_SPDLOG_INFO("uploader back online after {} retries", m_backoff.attempts());
+        }
+        m_offline = false;
+        m_backoff.reset();
+    }
+    else {
+        // 传输结束后引擎已释放请求体，数据收回到证据中，倒序放回队首保持原有顺序
+        const std::string what = upload->items.front().filePath;
+        const uint32_t attempts = upload->items.front().attempts + 1;
+        for (size_t i = count; i-- > 0;) {
+            if (upload->data[i]) {
+                upload->items[i].data = std::move(*upload->data[i]);
+            }
+            upload->items[i].attempts += cancelled ? 0 : 1;
+            requeueLocked(std::move(upload->items[i]));
+        }
+        if (!cancelled) {
+            enterOfflineLocked(count > 1 ? what + " (batch of " + std::to_string(count) + ")" : what, attempts);
+        }
+    }
+    m_queueCond.notify_all();
+}
+
+void PicFileUploader::requeueLocked(UploadItem&& item)
+{
+    m_memoryBytes += item.data.size();
+    const UploadPriority priority = item.priority;
+    m_queues[priority].emplace_front(std::move(item));
+}
+
+void PicFileUploader::enterOfflineLocked(const std::string& what, uint32_t attempts)
+{
+    // 转为离线并把内存中的证据全部落盘，避免崩溃丢失
+    const std::chrono::milliseconds delay = m_backoff.nextDelay();
+    MY_SPDLOG_ERROR("upload file: {} failed, attempts: {}, retry after {} ms", what, attempts, delay.count());
+    ++m_stats.failed;
+    m_offline = true;
+    m_retryAt = std::chrono::steady_clock::now() + delay;
+    spillAllLocked();
+}
+
+bool PicFileUploader::spillItem(UploadItem& item)
+{
+    if (item.data.empty()) {
+        return true;
+    }
+    // 追加到当前段文件，段内记录带校验，恢复时不会读到写了一半的证据
+    ScopedStageTimer timer(LatencyStage::DiskWrite);
+    const std::string name = fs::path(item.filePath).filename().string();
+    if (!m_store.append(name, static_cast<uint8_t>(item.priority), item.createdMs,
+        item.data.data(), item.data.size(), item.segment)) {
+        return false;
+    }
+    MY_SPDLOG_DEBUG("append evidence {} to segment {} ({} bytes)", name, item.segment.segmentId, item.data.size());
+    recycleBuffer(std::move(item.data));
+    item.data = std::vector<uint8_t>();
+    return true;
+}
+
+void PicFileUploader::enforceMemoryCapLocked()
+{
+    // 从最低优先级的最新证据开始落盘，高优先级和先到的证据留在内存中尽快上传
+    for (auto& queue : m_queues) {
+        for (auto it = queue.rbegin(); it != queue.rend() && m_memoryBytes > m_queueMaxBytes; ++it) {
+            const size_t bytes = it->data.size();
+            if (bytes > 0 && spillItem(*it)) {
+                m_memoryBytes -= bytes;
+                ++m_stats.spilled;
+            }
+        }
+        if (m_memoryBytes <= m_queueMaxBytes) {
+            return;
+        }
+    }
+}
+
+void PicFileUploader::spillAllLocked()
+{
+    for (auto& queue : m_queues) {
+        for (auto& item : queue) {
+            const size_t bytes = item.data.size();
+            if (bytes > 0 && spillItem(item)) {
+                m_memoryBytes -= bytes;
+                ++m_stats.spilled;
+            }
+        }
     }
-#endif
-    MY_SPDLOG_DEBUG("<<<");
 }
 
 void PicFileUploader::writePic2Disk(const std::string& inFilePath, const std::vector<uint8_t> &pic_data)
 {
+    std::vector<uint8_t> data = acquireBuffer();
+    data.assign(pic_data.begin(), pic_data.end());
+    submitPic(inFilePath, std::move(data), priorityForName(inFilePath));
+}
+
+void PicFileUploader::submitPic(const std::string& inFilePath, std::vector<uint8_t>&& pic_data, UploadPriority priority)
+{
+    UploadItem item;
+    item.filePath = inFilePath;
+    item.data = std::move(pic_data);
+    item.priority = priority;
+    item.createdMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    item.enqueueTime = std::chrono::steady_clock::now();
 
-    std::unique_lock<std::mutex> lock(m_scanMtx);
-    std::ofstream out(inFilePath, std::ios::binary);
-    if (out) {
-        out.write(reinterpret_cast<const char*>(pic_data.data()), pic_data.size());
+    // 离线、上传线程未运行或不上传的版本直接落盘，落盘失败仍留在内存中
+    bool spill = !UPLOAD_ENABLED;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        spill = spill || m_offline || !m_uploadContinue.load();
+    }
+    const bool spilled = spill && spillItem(item);
+    if (!UPLOAD_ENABLED && spilled) {
+        return;
     }
-    out.close();
-    MY_SPDLOG_DEBUG("write pic file into : {}", inFilePath);
 
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        item.seq = m_nextSeq++;
+        m_memoryBytes += item.data.size();
+        ++m_stats.enqueued;
+        m_stats.spilled += spilled ? 1 : 0;
+        m_queues[priority].emplace_back(std::move(item));
+        enforceMemoryCapLocked();
+    }
+    m_queueCond.notify_one();
+}
+
+void PicFileUploader::recycleBuffer(std::vector<uint8_t>&& data)
+{
+    std::lock_guard<std::mutex> lock(m_bufMtx);
+    if (m_bufPool.size() < MAX_POOLED_BUFFERS) {
+        data.clear();
+        m_bufPool.emplace_back(std::move(data));
+    }
+}
+
+std::vector<uint8_t> PicFileUploader::acquireBuffer()
+{
+    std::lock_guard<std::mutex> lock(m_bufMtx);
+    if (m_bufPool.empty()) {
+        return std::vector<uint8_t>();
+    }
+    std::vector<uint8_t> buf(std::move(m_bufPool.back()));
+    m_bufPool.pop_back();
+    return buf;
+}
+
+UploadStats PicFileUploader::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    UploadStats stats = m_stats;
+    stats.pending = 0;
+    for (size_t priority = 0; priority < m_queues.size(); ++priority) {
+        const auto& queue = m_queues[priority];
+        stats.pending += queue.size();
+        stats.pendingByPriority[priority] = queue.size();
+        for (const auto& item : queue) {
+            stats.pendingBytesByPriority[priority] += item.data.empty() ? item.segment.payloadSize : item.data.size();
+        }
+    }
+    stats.inFlight = m_inFlightIds.size();
+    stats.memoryBytes = m_memoryBytes;
+    stats.offline = m_offline;
+    const SegmentStoreStats storeStats = m_store.getStats();
+    stats.segments = storeStats.segments;
+    stats.diskBytes = storeStats.diskBytes;
+    return stats;
 }
 
 void PicFileUploader::setUploadParam(std::shared_ptr<MyMeta>& meta) {
-    m_scanInterval = meta->getInt32OrDefault("upload_interval", m_scanInterval);
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    // upload_interval原为目录扫描周期，现作为离线重试退避上限
+    m_retryMaxMs = meta->getInt32OrDefault("upload_interval", m_retryMaxMs);
+    m_retryBaseMs = meta->getInt32OrDefault("upload_retry_base_ms", m_retryBaseMs);
+    m_queueMaxBytes = static_cast<size_t>(meta->getInt32OrDefault("upload_queue_max_bytes",
+        static_cast<int32_t>(m_queueMaxBytes)));
+    m_maxInFlight = (std::max)(1, meta->getInt32OrDefault("upload_concurrency", m_maxInFlight));
+    HttpClient::getInstance()->setMaxConcurrentUploads(m_maxInFlight);
+    m_batchMaxBytes = static_cast<size_t>((std::max)(0, meta->getInt32OrDefault("upload_batch_max_bytes",
+        static_cast<int32_t>(m_batchMaxBytes))));
+    m_batchMaxRecords = meta->getInt32OrDefault("upload_batch_max_records", m_batchMaxRecords);
+    m_batchWindowMs = meta->getInt32OrDefault("upload_batch_window_ms", m_batchWindowMs);
+    const std::string spillDir = meta->getStringOrDefault("upload_spill_dir", "");
+    if (!spillDir.empty()) {
+        m_spillDir = spillDir;
+    }
+    m_segmentMaxBytes = static_cast<uint64_t>((std::max)(0, meta->getInt32OrDefault("upload_segment_max_bytes",
+        static_cast<int32_t>(m_segmentMaxBytes))));
+    m_store.configure(m_spillDir, m_segmentMaxBytes);
+    // 令牌桶控制平均速率，单个传输的发送速率也不超过上限，避免大批量请求瞬间占满上行
+    m_maxBytesPerSec = meta->getInt32OrDefault("upload_max_bytes_per_sec", m_maxBytesPerSec);
+    m_burstBytes = meta->getInt32OrDefault("upload_burst_bytes", m_burstBytes);
+    m_bandwidth.configure(m_maxBytesPerSec, m_burstBytes > 0 ? m_burstBytes : m_maxBytesPerSec);
+    HttpClient::getInstance()->setMaxUploadSpeed(m_maxBytesPerSec);
+
+    MY_SPDLOG_DEBUG("上传参数更新: retry={}~{}ms, queue_max_bytes={}, concurrency={}, batch={}B/{}条/{}ms, spill_dir={}, segment={}B, bandwidth={}B/s burst={}B",
+        m_retryBaseMs, m_retryMaxMs, m_queueMaxBytes, m_maxInFlight, m_batchMaxBytes, m_batchMaxRecords,
+        m_batchWindowMs, m_spillDir, m_segmentMaxBytes, m_maxBytesPerSec, m_burstBytes);
+}
+
+UploadPriority PicFileUploader::priorityForName(const std::string& fileName)
+{
+    // 证据文件名形如[camN_]screen_phone_时间.jpg，无人/遮挡/断连同属环境类
+    const std::string name = fs::path(fileName).filename().string();
+    static const std::pair<const char*, UploadPriority> TOKENS[] = {
+        { "_phone_", UPLOAD_PRIORITY_PHONE },
+        { "_suspect_", UPLOAD_PRIORITY_SUSPECT },
+        { "_peep_", UPLOAD_PRIORITY_PEEP },
+        { "_nobody_", UPLOAD_PRIORITY_ENVIRONMENT },
+        { "_occlude_", UPLOAD_PRIORITY_ENVIRONMENT },
+        { "_noconnect_", UPLOAD_PRIORITY_ENVIRONMENT },
+    };
+    for (const auto& token : TOKENS) {
+        if (std::string::npos != name.find(token.first)) {
+            return token.second;
+        }
+    }
+    return UPLOAD_PRIORITY_BACKLOG;
+}
+
+const char* PicFileUploader::priorityName(UploadPriority priority)
+{
+    return priority >= 0 && priority < UPLOAD_PRIORITY_COUNT ? UPLOAD_PRIORITY_NAMES[priority] : "unknown";
+}
+
+void UploadTokenBucket::configure(int64_t bytesPerSec, int64_t burstBytes)
+{
+    m_rate = bytesPerSec > 0 ? static_cast<double>(bytesPerSec) : 0.0;
+    m_burst = (std::max)(static_cast<double>(burstBytes), m_rate);
+    // 参数变化后从满桶开始
+    m_tokens = m_burst;
+    m_last = std::chrono::steady_clock::now();
+}
+
+void UploadTokenBucket::refill(std::chrono::steady_clock::time_point now)
+{
+    if (now > m_last) {
+        m_tokens = (std::min)(m_burst, m_tokens + m_rate * std::chrono::duration<double>(now - m_last).count());
+        m_last = now;
+    }
+}
 
-    MY_SPDLOG_DEBUG("上传参数更新: scan_interval={}", m_scanInterval);
+bool UploadTokenBucket::ready(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& readyAt)
+{
+    if (!limited()) {
+        return true;
+    }
+    refill(now);
+    if (m_tokens >= 0.0) {
+        return true;
+    }
+    readyAt = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(-m_tokens / m_rate)) + std::chrono::milliseconds(1);
+    return false;
+}
+
+void UploadTokenBucket::consume(uint64_t bytes, std::chrono::steady_clock::time_point now)
+{
+    if (!limited()) {
+        return;
+    }
+    refill(now);
+    m_tokens -= static_cast<double>(bytes);
 }
@@ -1,15 +1,86 @@
 #ifndef PIC_FILE_UPLOADER_H
 #define PIC_FILE_UPLOADER_H
 
+#include <array>
 #include <mutex>
 #include <memory>
 #include <condition_variable>
 #include <atomic>
+#include <chrono>
+#include <deque>
 #include <thread>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
+#include "CameraManager.h"
+#include "EvidenceSegmentStore.h"
 #include "HttpClient.h"
 #include "MyMeta.h"
 
+// 上传优先级，按告警类型分级，高优先级先上传，同级按入队顺序
+enum UploadPriority {
+	UPLOAD_PRIORITY_BACKLOG = 0,  // 类型未知的证据(旧版本遗留文件等)
+	UPLOAD_PRIORITY_ENVIRONMENT,  // 无人、遮挡、断连
+	UPLOAD_PRIORITY_PEEP,
+	UPLOAD_PRIORITY_SUSPECT,
+	UPLOAD_PRIORITY_PHONE,        // 手机拍照，最紧急
+	UPLOAD_PRIORITY_COUNT,
+};
+
+struct UploadStats {
+	uint64_t enqueued{ 0 };
+	uint64_t uploaded{ 0 };
+	uint64_t batches{ 0 };        // 以批量请求上传成功的批次数
+	uint64_t failed{ 0 };         // 上传失败次数(含重试)
+	uint64_t spilled{ 0 };        // 写入磁盘的证据数
+	uint64_t recovered{ 0 };      // 启动时从磁盘恢复的证据数
+	size_t pending{ 0 };
+	size_t inFlight{ 0 };
+	size_t memoryBytes{ 0 };
+	size_t segments{ 0 };         // 磁盘上尚未回收的段数
+	uint64_t diskBytes{ 0 };
+	bool offline{ false };
+	std::array<size_t, UPLOAD_PRIORITY_COUNT> pendingByPriority{};        // 各优先级排队的证据数
+	std::array<uint64_t, UPLOAD_PRIORITY_COUNT> pendingBytesByPriority{};
+	uint64_t throttledMs{ 0 };    // 因带宽限制推迟发起上传的累计时间
+};
+
+/**
+ * UploadTokenBucket - 上传带宽令牌桶
+ * 令牌按rate字节/秒补充，最多积累burst字节；每次上传按报文字节数取令牌，允许透支，
+ * 余额为负时下一次上传要等到补足为止，长时间平均速率不超过rate。非线程安全
+ */
+class UploadTokenBucket {
+public:
+	// bytesPerSec<=0不限速
+	void configure(int64_t bytesPerSec, int64_t burstBytes);
+	bool limited() const { return m_rate > 0; }
+	// 可以发起上传时返回true，否则readyAt为令牌补足的时刻
+	bool ready(std::chrono::steady_clock::time_point now, std::chrono::steady_clock::time_point& readyAt);
+	void consume(uint64_t bytes, std::chrono::steady_clock::time_point now);
+
+private:
+	void refill(std::chrono::steady_clock::time_point now);
+
+	double m_rate{ 0.0 };
+	double m_burst{ 0.0 };
+	double m_tokens{ 0.0 };
+	std::chrono::steady_clock::time_point m_last;
+};
+
+/**
+ * PicFileUploader - 证据上传队列
+ * 证据由告警线程直接投递到内存优先级队列，上传线程被条件变量立即唤醒，按优先级异步提交给HttpClient，
+ * 同时最多upload_concurrency个在途；离线时只保留一个探测上传。
+ * 优先级按告警类型区分(手机 > 可疑 > 偷窥 > 无人/遮挡)，积压的低优先级证据不会挡住新的手机告警；
+ * 配置upload_max_bytes_per_sec后按令牌桶控制发起节奏，单个传输同时限制发送速率，避免占满网点上行带宽。
+ * 多条证据按upload_batch_window_ms时间窗和upload_batch_max_bytes/records合并为一个批量请求(EvidenceBatch)，
+ * 离线恢复后的积压不再逐条回放；服务端不支持批量接口时退回单条上传。
+ * 仅在离线(上传失败)或内存积压超过upload_queue_max_bytes时落盘，证据追加到upload_segment_max_bytes大小的段文件中
+ * (EvidenceSegmentStore)，上传时直接使用段文件的映射内存，整段确认后删除。
+ * 启动时从段文件恢复上次未上传的证据，停止时把内存中未上传的证据全部落盘
+ */
 class PicFileUploader
 {
 public:
@@ -20,28 +91,95 @@ public:
 	void start();
 	void stop();
 	void writePic2Disk(const std::string& inFilePath, const std::vector<uint8_t>& pic_data);
+	// 接管已编码数据的所有权并入队，上传或落盘后缓冲回收复用
+	void submitPic(const std::string& inFilePath, std::vector<uint8_t>&& pic_data, UploadPriority priority);
+	std::vector<uint8_t> acquireBuffer();
 	void setUploadParam(std::shared_ptr<MyMeta> &meta);
+	UploadStats getStats() const;
+	// 按证据文件名中的告警类型(如screen_phone_)推断优先级，无法识别时为UPLOAD_PRIORITY_BACKLOG
+	static UploadPriority priorityForName(const std::string& fileName);
+	static const char* priorityName(UploadPriority priority);
 
 private:
+	struct UploadItem {
+		std::string filePath;             // 证据路径，上传和段记录的文件名取自这里
+		std::vector<uint8_t> data;        // 为空表示已写入段文件
+		SegmentRecordRef segment;         // 落盘后在段文件中的位置
+		UploadPriority priority{ UPLOAD_PRIORITY_BACKLOG };
+		uint64_t seq{ 0 };
+		uint32_t attempts{ 0 };
+		int64_t createdMs{ 0 };           // 证据产生的系统时间，重启恢复的为0
+		std::chrono::steady_clock::time_point enqueueTime;
+	};
+
+	struct InFlightUpload {
+		uint64_t id{ 0 };
+		std::vector<UploadItem> items;
+		std::vector<std::shared_ptr<std::vector<uint8_t>>> data;   // 与items对应，已落盘的为空
+		std::vector<SegmentRecordView> views;                      // 与items对应，已落盘证据的映射
+		std::chrono::steady_clock::time_point begin;
+	};
+
 	PicFileUploader();
 	~PicFileUploader();
-	void scanThread();
+	void uploadThread();
+	// 以下调用方持有m_queueMtx
+	bool batchingEnabledLocked() const;
+	// 未凑满一批且最早的证据未超过时间窗时返回true，deadline为时间窗结束时刻
+	bool batchWindowOpenLocked(std::chrono::steady_clock::time_point& deadline) const;
+	// 按优先级取出一批证据，不能批量时只取一条
+	std::vector<UploadItem> takeBatchLocked();
+	// 一条走原有单条接口，多条走批量接口；返回false表示未能提交
+	bool dispatchLocked(std::vector<UploadItem>&& items);
+	void requeueLocked(UploadItem&& item);
+	void enterOfflineLocked(const std::string& what, uint32_t attempts);
+	void onUploadDone(const std::shared_ptr<InFlightUpload>& upload, bool success, bool cancelled);
+	void recoverSpilled();
+	bool spillItem(UploadItem& item);
+	// 调用方持有m_queueMtx
+	void enforceMemoryCapLocked();
+	void spillAllLocked();
+	void recycleBuffer(std::vector<uint8_t>&& data);
 	PicFileUploader(const PicFileUploader&) = delete;
 	PicFileUploader& operator=(const PicFileUploader&) = delete;
 private:
-	std::string m_scanPath{ "picDataDir" };
-	std::atomic_bool m_scanContinue{ false };
-	//std::queue<std::string> m_picPathVec{};
+	std::string m_spillDir;
+	std::atomic_bool m_uploadContinue{ false };
 	HttpClient* m_httpClient{ nullptr };
-	int32_t m_scanInterval{ 60000 }; //ms
+	int32_t m_retryBaseMs{ 1000 };             // 离线重试退避初始间隔
+	int32_t m_retryMaxMs{ 60000 };             // 离线重试退避上限(沿用upload_interval)
+	size_t m_queueMaxBytes{ 32u << 20 };       // 内存积压上限，超出后低优先级证据落盘
+	int32_t m_maxInFlight{ 3 };                // 同时在途的上传数
+	size_t m_batchMaxBytes{ 4u << 20 };        // 单个批量请求的报文总长上限
+	int32_t m_batchMaxRecords{ 32 };           // 单个批量请求的证据数上限，不大于1时关闭批量
+	int32_t m_batchWindowMs{ 200 };            // 凑批等待时间窗
+	uint64_t m_segmentMaxBytes{ 64u << 20 };   // 落盘段文件大小上限
+	int32_t m_maxBytesPerSec{ 0 };             // 上传带宽上限，<=0不限速
+	int32_t m_burstBytes{ 0 };                 // 令牌桶容量，<=0时取1秒的量
+	UploadTokenBucket m_bandwidth;
+	EvidenceSegmentStore m_store;
+
+	std::thread m_uploadThd;
+	std::mutex m_lifeMtx;
+	int32_t m_startCount{ 0 };
 
-	std::thread m_scanThd;
-	std::mutex m_scanMtx;
-	std::condition_variable m_scanCond;
+	mutable std::mutex m_queueMtx;
+	std::condition_variable m_queueCond;
+	std::array<std::deque<UploadItem>, UPLOAD_PRIORITY_COUNT> m_queues;
+	size_t m_memoryBytes{ 0 };
+	uint64_t m_nextSeq{ 0 };
+	std::unordered_set<uint64_t> m_inFlightIds;
+	bool m_offline{ false };
+	std::chrono::steady_clock::time_point m_retryAt;
+	ReconnectBackoff m_backoff{ 1000, 60000 };
+	UploadStats m_stats;
+
+	static constexpr size_t MAX_POOLED_BUFFERS = 4;
+	std::mutex m_bufMtx;
+	std::vector<std::vector<uint8_t>> m_bufPool;
 };
 
 
 #endif // !PIC_FILE_UPLOADER_H
 
 
-
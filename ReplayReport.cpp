@@ -0,0 +1,119 @@
+#include "ReplayReport.h"
+
+#include <algorithm>
+#include <cmath>
+
+void ReplayReport::begin(const std::string& source, bool prefetch, bool frameDetail) {
+    m_active = true;
+    m_prefetch = prefetch;
+    m_frameDetail = frameDetail;
+    m_source = source;
+    m_frameCnt = 0;
+    for (auto& samples : m_stageSamples) {
+        samples.clear();
+    }
+    m_decisionCnt.clear();
+    m_frames.clear();
+    m_beginTime = std::chrono::steady_clock::now();
+    m_endTime = m_beginTime;
+}
+
+void ReplayReport::addFrame(FrameRecord&& record) {
+    if (!m_active) {
+        return;
+    }
+    ++m_frameCnt;
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        m_stageSamples[i].push_back(record.stageMs[i]);
+    }
+    ++m_decisionCnt[record.decision];
+    if (m_frameDetail) {
+        m_frames.emplace_back(std::move(record));
+    }
+    m_endTime = std::chrono::steady_clock::now();
+}
+
+void ReplayReport::end() {
+    if (m_active) {
+        m_endTime = std::chrono::steady_clock::now();
+    }
+}
+
+double ReplayReport::percentile(std::vector<double>& samples, double pct) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    // 最近秩法
+    size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * samples.size()));
+    rank = (std::min)((std::max)(rank, static_cast<size_t>(1)), samples.size());
+    std::nth_element(samples.begin(), samples.begin() + (rank - 1), samples.end());
+    return samples[rank - 1];
+}
+
+const char* ReplayReport::stageName(int stage) {
+    switch (stage) {
+    case STAGE_DECODE: return "decode";
+    case STAGE_DETECT: return "detect";
+    case STAGE_DECIDE: return "decide";
+    case STAGE_TOTAL: return "total";
+    default: return "unknown";
+    }
+}
+
+Json::Value ReplayReport::toJson() const {
+    Json::Value root;
+    const double elapsedSec = std::chrono::duration<double>(m_endTime - m_beginTime).count();
+    root["source"] = m_source;
+    root["prefetch"] = m_prefetch;
+    root["frames"] = Json::Value::UInt64(m_frameCnt);
+    root["elapsedSec"] = elapsedSec;
+    root["fps"] = elapsedSec > 0.0 ? m_frameCnt / elapsedSec : 0.0;
+
+    Json::Value stages;
+    for (int i = 0; i < STAGE_COUNT; ++i) {
+        std::vector<double> samples = m_stageSamples[i];
+        Json::Value stage;
+        double sum = 0.0;
+        for (double v : samples) {
+            sum += v;
+        }
+        stage["avgMs"] = samples.empty() ? 0.0 : sum / samples.size();
+        stage["p50Ms"] = percentile(samples, 50.0);
+        stage["p95Ms"] = percentile(samples, 95.0);
+        stage["p99Ms"] = percentile(samples, 99.0);
+        stage["maxMs"] = samples.empty() ? 0.0 : *std::max_element(samples.begin(), samples.end());
+        stages[stageName(i)] = stage;
+    }
+    root["stages"] = stages;
+
+    Json::Value decisions(Json::objectValue);
+    for (const auto& item : m_decisionCnt) {
+        decisions[item.first] = Json::Value::UInt64(item.second);
+    }
+    root["decisions"] = decisions;
+
+    if (m_frameDetail) {
+        Json::Value frames(Json::arrayValue);
+        for (const auto& record : m_frames) {
+            Json::Value frame;
+            frame["index"] = Json::Value::UInt64(record.index);
+            frame["decision"] = record.decision;
+            frame["totalMs"] = record.stageMs[STAGE_TOTAL];
+            Json::Value dets(Json::arrayValue);
+            for (const auto& det : record.detections) {
+                Json::Value d;
+                d["class"] = det.class_id;
+                d["conf"] = det.conf;
+                d["box"].append(det.box.x);
+                d["box"].append(det.box.y);
+                d["box"].append(det.box.width);
+                d["box"].append(det.box.height);
+                dets.append(d);
+            }
+            frame["detections"] = dets;
+            frames.append(frame);
+        }
+        root["perFrame"] = frames;
+    }
+    return root;
+}
@@ -0,0 +1,62 @@
+#ifndef REPLAY_REPORT_H
+#define REPLAY_REPORT_H
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "json/json.h"
+#include "Detection.h"
+
+/**
+ * ReplayReport - 离线回放基准的统计与报告
+ * 记录每帧各阶段耗时、检测结果和判定结果，结束时输出吞吐(fps)、
+ * 各阶段p50/p95/p99以及判定计数，仅由检测线程写入
+ */
+class ReplayReport {
+public:
+    enum Stage {
+        STAGE_DECODE = 0,   // 视频解码(预读时在预读线程)
+        STAGE_DETECT,       // 推理(含预处理/后处理)
+        STAGE_DECIDE,       // 判定逻辑+告警入队
+        STAGE_TOTAL,        // 取到帧到判定完成
+        STAGE_COUNT
+    };
+
+    struct FrameRecord {
+        uint64_t index{ 0 };
+        double stageMs[STAGE_COUNT]{};
+        std::string decision;
+        std::vector<Detection> detections;
+    };
+
+    void begin(const std::string& source, bool prefetch, bool frameDetail);
+    void addFrame(FrameRecord&& record);
+    void end();
+
+    bool isActive() const { return m_active; }
+    uint64_t getFrameCount() const { return m_frameCnt; }
+
+    // 生成报告JSON
+    Json::Value toJson() const;
+
+private:
+    static double percentile(std::vector<double>& samples, double pct);
+    static const char* stageName(int stage);
+
+private:
+    bool m_active{ false };
+    bool m_prefetch{ false };
+    bool m_frameDetail{ true };
+    std::string m_source;
+    std::chrono::steady_clock::time_point m_beginTime;
+    std::chrono::steady_clock::time_point m_endTime;
+    uint64_t m_frameCnt{ 0 };
+    std::vector<double> m_stageSamples[STAGE_COUNT];
+    std::map<std::string, uint64_t> m_decisionCnt;
+    std::vector<FrameRecord> m_frames;   // 仅frameDetail时保存
+};
+
+#endif // REPLAY_REPORT_H
@@ -0,0 +1,79 @@
+#include "TemporalVoter.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstdio>
+
+bool TemporalVoter::parseRule(const std::string& spec, Rule& rule) {
+    unsigned int n = 0, m = 0, c = 0;
+    const int fields = std::sscanf(spec.c_str(), "%u/%u/%u", &n, &m, &c);
+    if (fields < 2 || 0 == n || n > m || m > 64 || (3 == fields && c >= n)) {
+        return false;
+    }
+    rule.raiseCount = n;
+    rule.window = m;
+    rule.clearCount = 3 == fields ? c : n - 1;
+    return true;
+}
+
+TemporalVoter::Rule TemporalVoter::normalize(const Rule& rule) {
+    Rule out;
+    out.window = (std::min)((std::max)(rule.window, 1u), 64u);
+    out.raiseCount = (std::min)((std::max)(rule.raiseCount, 1u), out.window);
+    out.clearCount = (std::min)(rule.clearCount, out.raiseCount - 1);
+    return out;
+}
+
+void TemporalVoter::configure(const std::vector<Rule>& rules) {
+    m_channels.resize(rules.size());
+    for (size_t i = 0; i < rules.size(); ++i) {
+        const Rule rule = normalize(rules[i]);
+        if (m_channels[i].rule != rule) {
+            m_channels[i].rule = rule;
+            m_channels[i].history = 0;
+            m_channels[i].active = false;
+        }
+    }
+}
+
+bool TemporalVoter::update(size_t channel, bool positive) {
+    if (channel >= m_channels.size()) {
+        return positive;
+    }
+    Channel& ch = m_channels[channel];
+    const uint64_t mask = (64 == ch.rule.window) ? ~0ull : ((1ull << ch.rule.window) - 1);
+    ch.history = ((ch.history << 1) | (positive ? 1ull : 0ull)) & mask;
+    const uint32_t positives = static_cast<uint32_t>(std::bitset<64>(ch.history).count());
+
+    ++ch.stats.frames;
+    if (positive && !ch.lastRaw) {
+        ++ch.stats.rawRises;
+    }
+    ch.lastRaw = positive;
+
+    if (!ch.active && positives >= ch.rule.raiseCount) {
+        ch.active = true;
+        ++ch.stats.votedRises;
+    }
+    else if (ch.active && positives <= ch.rule.clearCount) {
+        ch.active = false;
+    }
+    return ch.active;
+}
+
+bool TemporalVoter::isActive(size_t channel) const {
+    return channel < m_channels.size() && m_channels[channel].active;
+}
+
+void TemporalVoter::reset() {
+    for (auto& ch : m_channels) {
+        ch.history = 0;
+        ch.active = false;
+        ch.lastRaw = false;
+        ch.stats = ChannelStats();
+    }
+}
+
+TemporalVoter::ChannelStats TemporalVoter::getStats(size_t channel) const {
+    return channel < m_channels.size() ? m_channels[channel].stats : ChannelStats();
+}
@@ -0,0 +1,59 @@
+#ifndef TEMPORAL_VOTER_H
+#define TEMPORAL_VOTER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * TemporalVoter - 按告警类型的N-of-M时间投票，带滞回
+ * 每个通道用一个64位移位寄存器记录最近M帧的判定，最近M帧中阳性数>=N时触发，
+ * 触发后阳性数降到<=C才解除，单帧误检不再直接产生告警任务
+ */
+class TemporalVoter {
+public:
+    struct Rule {
+        uint32_t raiseCount{ 1 };   // N
+        uint32_t window{ 1 };       // M，最大64
+        uint32_t clearCount{ 0 };   // C，小于N
+
+        bool operator==(const Rule& other) const {
+            return raiseCount == other.raiseCount && window == other.window && clearCount == other.clearCount;
+        }
+        bool operator!=(const Rule& other) const { return !(*this == other); }
+    };
+
+    struct ChannelStats {
+        uint64_t frames{ 0 };
+        uint64_t rawRises{ 0 };     // 单帧判定由阴转阳的次数(不投票时的告警任务数)
+        uint64_t votedRises{ 0 };   // 投票后触发的次数
+    };
+
+    // 解析"N/M/C"或"N/M"(省略C时为N-1，即无滞回)，格式非法时返回false且不修改rule
+    static bool parseRule(const std::string& spec, Rule& rule);
+
+    // 规则与当前不同的通道会清空历史；通道数随rules变化
+    void configure(const std::vector<Rule>& rules);
+    // 输入本帧判定，返回投票后该通道是否处于触发状态
+    bool update(size_t channel, bool positive);
+    bool isActive(size_t channel) const;
+    void reset();
+
+    size_t getChannelCount() const { return m_channels.size(); }
+    ChannelStats getStats(size_t channel) const;
+
+private:
+    struct Channel {
+        Rule rule;
+        uint64_t history{ 0 };      // bit0为最新一帧
+        bool active{ false };
+        bool lastRaw{ false };
+        ChannelStats stats;
+    };
+
+    static Rule normalize(const Rule& rule);
+
+    std::vector<Channel> m_channels;
+};
+
+#endif // TEMPORAL_VOTER_H
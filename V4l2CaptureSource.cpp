@@ -0,0 +1,323 @@
+#include "V4l2CaptureSource.h"
+
+#if defined(__linux__)
+
+#include "MyLogger.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+uint32_t fourccFromName(const std::string& name) {
+    if ("yuyv" == name) { return V4L2_PIX_FMT_YUYV; }
+    if ("nv12" == name) { return V4L2_PIX_FMT_NV12; }
+    return V4L2_PIX_FMT_MJPEG;
+}
+
+std::string fourccToString(uint32_t fourcc) {
+    std::string str(4, ' ');
+    for (int i = 0; i < 4; ++i) {
+        str[i] = static_cast<char>((fourcc >> (8 * i)) & 0xFF);
+    }
+    return str;
+}
+
+bool isSupportedFourcc(uint32_t fourcc) {
+    return V4L2_PIX_FMT_YUYV == fourcc || V4L2_PIX_FMT_NV12 == fourcc || V4L2_PIX_FMT_MJPEG == fourcc;
+}
+
+} // namespace
+
+V4l2CaptureSource::V4l2CaptureSource(int32_t captureWidth, int32_t captureHeight,
+    const std::string& pixelFormat, uint32_t bufferCount)
+    : m_captureWidth(captureWidth), m_captureHeight(captureHeight),
+    m_pixelFormatName(pixelFormat), m_bufferCount((std::max)(bufferCount, 2u)) {
+}
+
+V4l2CaptureSource::~V4l2CaptureSource() {
+    close();
+}
+
+bool V4l2CaptureSource::xioctl(unsigned long request, void* arg) const {
+    int ret = 0;
+    do {
+        ret = ioctl(m_fd, request, arg);
+    } while (-1 == ret && EINTR == errno);
+    return -1 != ret;
+}
+
+bool V4l2CaptureSource::open(int32_t deviceIndex, int32_t width, int32_t height) {
+    close();
+    const std::string devPath = "/dev/video" + std::to_string(deviceIndex);
+    m_fd = ::open(devPath.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0) {
+        MY_SPDLOG_ERROR("open {} failed: {}", devPath, strerror(errno));
+        return false;
+    }
+
+    v4l2_capability cap{};
+    if (!xioctl(VIDIOC_QUERYCAP, &cap)) {
+        MY_SPDLOG_ERROR("VIDIOC_QUERYCAP {} failed: {}", devPath, strerror(errno));
+        close();
+        return false;
+    }
+    const uint32_t caps = (cap.capabilities & V4L2_CAP_DEVICE_CAPS) ? cap.device_caps : cap.capabilities;
+    if (!(caps & V4L2_CAP_VIDEO_CAPTURE) || !(caps & V4L2_CAP_STREAMING)) {
+        MY_SPDLOG_ERROR("{} ({}) does not support streaming capture", devPath, reinterpret_cast<const char*>(cap.card));
+        close();
+        return false;
+    }
+
+    m_targetLongSide = (std::max)(width, height);
+    if (!setupFormat() || !setupBuffers()) {
+        close();
+        return false;
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (!xioctl(VIDIOC_STREAMON, &type)) {
+        MY_SPDLOG_ERROR("VIDIOC_STREAMON failed: {}", strerror(errno));
+        close();
+        return false;
+    }
+    m_streaming = true;
+    MY_SPDLOG_INFO("v4l2 capture {} ({}) streaming {} {}x{}, buffers: {}", devPath,
+        reinterpret_cast<const char*>(cap.card), fourccToString(m_fourcc),
+        m_frameSize.width, m_frameSize.height, m_buffers.size());
+    return true;
+}
+
+bool V4l2CaptureSource::setupFormat() {
+    v4l2_format fmt{};
+    fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    fmt.fmt.pix.width = static_cast<uint32_t>(m_captureWidth);
+    fmt.fmt.pix.height = static_cast<uint32_t>(m_captureHeight);
+    fmt.fmt.pix.pixelformat = fourccFromName(m_pixelFormatName);
+    fmt.fmt.pix.field = V4L2_FIELD_NONE;
+    if (!xioctl(VIDIOC_S_FMT, &fmt)) {
+        MY_SPDLOG_ERROR("VIDIOC_S_FMT failed: {}", strerror(errno));
+        return false;
+    }
+    // 驱动可能调整分辨率或格式，以返回值为准
+    if (!isSupportedFourcc(fmt.fmt.pix.pixelformat)) {
+        MY_SPDLOG_ERROR("v4l2 pixel format {} not supported", fourccToString(fmt.fmt.pix.pixelformat));
+        return false;
+    }
+    if (fmt.fmt.pix.pixelformat != fourccFromName(m_pixelFormatName)) {
+        MY_SPDLOG_WARN("v4l2 pixel format {} requested, driver chose {}", m_pixelFormatName,
+            fourccToString(fmt.fmt.pix.pixelformat));
+    }
+    m_fourcc = fmt.fmt.pix.pixelformat;
+    m_bytesPerLine = fmt.fmt.pix.bytesperline;
+    m_frameSize = cv::Size(static_cast<int>(fmt.fmt.pix.width), static_cast<int>(fmt.fmt.pix.height));
+    return true;
+}
+
+bool V4l2CaptureSource::setupBuffers() {
+    v4l2_requestbuffers req{};
+    req.count = m_bufferCount;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (!xioctl(VIDIOC_REQBUFS, &req) || req.count < 2) {
+        MY_SPDLOG_ERROR("VIDIOC_REQBUFS failed, count: {}, error: {}", req.count, strerror(errno));
+        return false;
+    }
+
+    m_buffers.resize(req.count);
+    for (uint32_t i = 0; i < req.count; ++i) {
+        v4l2_buffer buf{};
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (!xioctl(VIDIOC_QUERYBUF, &buf)) {
+            MY_SPDLOG_ERROR("VIDIOC_QUERYBUF {} failed: {}", i, strerror(errno));
+            return false;
+        }
+        void* start = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, buf.m.offset);
+        if (MAP_FAILED == start) {
+            MY_SPDLOG_ERROR("mmap buffer {} failed: {}", i, strerror(errno));
+            return false;
+        }
+        m_buffers[i].start = start;
+        m_buffers[i].length = buf.length;
+        if (!queueBuffer(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool V4l2CaptureSource::queueBuffer(uint32_t index) {
+    v4l2_buffer buf{};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+    if (!xioctl(VIDIOC_QBUF, &buf)) {
+        MY_SPDLOG_ERROR("VIDIOC_QBUF {} failed: {}", index, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool V4l2CaptureSource::dequeueBuffer(V4l2FrameView& view, int32_t& index) {
+    v4l2_buffer buf{};
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (!xioctl(VIDIOC_DQBUF, &buf)) {
+        if (EAGAIN != errno) {
+            MY_SPDLOG_ERROR("VIDIOC_DQBUF failed: {}", strerror(errno));
+        }
+        return false;
+    }
+    index = static_cast<int32_t>(buf.index);
+    view.data = static_cast<const uint8_t*>(m_buffers[buf.index].start);
+    view.bytes = buf.bytesused;
+    view.width = static_cast<uint32_t>(m_frameSize.width);
+    view.height = static_cast<uint32_t>(m_frameSize.height);
+    view.bytesPerLine = m_bytesPerLine;
+    view.fourcc = m_fourcc;
+    view.sequence = buf.sequence;
+    // 单调时钟时间戳与steady_clock同源(Linux下均为CLOCK_MONOTONIC)
+    if (V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC == (buf.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK)) {
+        view.timestamp = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::seconds(buf.timestamp.tv_sec) + std::chrono::microseconds(buf.timestamp.tv_usec)));
+    }
+    else {
+        view.timestamp = std::chrono::steady_clock::now();
+    }
+    return true;
+}
+
+void V4l2CaptureSource::releaseHeld() {
+    if (m_heldIndex >= 0) {
+        queueBuffer(static_cast<uint32_t>(m_heldIndex));
+        m_heldIndex = -1;
+        m_held = V4l2FrameView();
+    }
+}
+
+bool V4l2CaptureSource::grab() {
+    if (!m_streaming) {
+        return false;
+    }
+    releaseHeld();
+
+    pollfd pfd{ m_fd, POLLIN, 0 };
+    const int ret = poll(&pfd, 1, 2000);
+    if (ret <= 0 || (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))) {
+        MY_SPDLOG_WARN("v4l2 poll failed, ret: {}, revents: {}", ret, pfd.revents);
+        return false;
+    }
+    if (!dequeueBuffer(m_held, m_heldIndex)) {
+        m_heldIndex = -1;
+        return EAGAIN == errno;
+    }
+    // 积压的旧帧立即归还，只保留最新一帧
+    V4l2FrameView newer;
+    int32_t newerIndex = -1;
+    while (dequeueBuffer(newer, newerIndex)) {
+        queueBuffer(static_cast<uint32_t>(m_heldIndex));
+        m_held = newer;
+        m_heldIndex = newerIndex;
+        ++m_staleDropCnt;
+    }
+    return true;
+}
+
+bool V4l2CaptureSource::peek(V4l2FrameView& view) const {
+    if (m_heldIndex < 0) {
+        return false;
+    }
+    view = m_held;
+    return true;
+}
+
+bool V4l2CaptureSource::getCaptureTime(std::chrono::steady_clock::time_point& captureTime) const {
+    if (m_heldIndex < 0) {
+        return false;
+    }
+    captureTime = m_held.timestamp;
+    return true;
+}
+
+bool V4l2CaptureSource::convert(const V4l2FrameView& view, FrameHandle& frame) {
+    const int width = static_cast<int>(view.width);
+    const int height = static_cast<int>(view.height);
+    switch (view.fourcc) {
+    case V4L2_PIX_FMT_YUYV: {
+        const cv::Mat src(height, width, CV_8UC2, const_cast<uint8_t*>(view.data), view.bytesPerLine);
+        cv::cvtColor(src, frame.writable(), cv::COLOR_YUV2BGR_YUYV);
+        return true;
+    }
+    case V4L2_PIX_FMT_NV12: {
+        const size_t step = view.bytesPerLine ? view.bytesPerLine : static_cast<size_t>(width);
+        const cv::Mat src(height * 3 / 2, width, CV_8UC1, const_cast<uint8_t*>(view.data), step);
+        cv::cvtColor(src, frame.writable(), cv::COLOR_YUV2BGR_NV12);
+        return true;
+    }
+    case V4L2_PIX_FMT_MJPEG: {
+        cv::Size fullSize;
+        int32_t denom = 1;
+        if (!MjpegCaptureSource::decodeForDetect(view.data, view.bytes, m_targetLongSide,
+            frame.writable(), fullSize, denom)) {
+            return false;
+        }
+        frame.writableEncoded().assign(view.data, view.data + view.bytes);
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+bool V4l2CaptureSource::retrieve(FrameHandle& frame) {
+    if (m_heldIndex < 0) {
+        return false;
+    }
+    const bool ok = convert(m_held, frame);
+    if (!ok) {
+        MY_SPDLOG_WARN("v4l2 frame {} convert failed, bytes: {}", m_held.sequence, m_held.bytes);
+    }
+    // 转换完成即归还，驱动缓冲不被下游占用
+    releaseHeld();
+    return ok && !frame.empty();
+}
+
+void V4l2CaptureSource::close() {
+    if (m_fd < 0) {
+        return;
+    }
+    if (m_streaming) {
+        v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        xioctl(VIDIOC_STREAMOFF, &type);
+        m_streaming = false;
+    }
+    m_heldIndex = -1;
+    m_held = V4l2FrameView();
+    for (auto& buffer : m_buffers) {
+        if (buffer.start) {
+            munmap(buffer.start, buffer.length);
+        }
+    }
+    m_buffers.clear();
+    v4l2_requestbuffers req{};
+    req.count = 0;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    xioctl(VIDIOC_REQBUFS, &req);
+    ::close(m_fd);
+    m_fd = -1;
+    if (m_staleDropCnt > 0) {
+        MY_SPDLOG_INFO("v4l2 capture closed, stale frames dropped: {}", m_staleDropCnt);
+    }
+}
+
+#endif // __linux__
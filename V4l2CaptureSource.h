@@ -0,0 +1,86 @@
+#ifndef V4L2_CAPTURE_SOURCE_H
+#define V4L2_CAPTURE_SOURCE_H
+
+#if defined(__linux__)
+
+#include "CaptureSource.h"
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 驱动缓冲的只读视图，直接指向mmap内存，不拷贝
+struct V4l2FrameView {
+    const uint8_t* data{ nullptr };
+    size_t bytes{ 0 };
+    uint32_t width{ 0 };
+    uint32_t height{ 0 };
+    uint32_t bytesPerLine{ 0 };
+    uint32_t fourcc{ 0 };
+    uint32_t sequence{ 0 };
+    std::chrono::steady_clock::time_point timestamp;   // 内核采集时间(CLOCK_MONOTONIC)
+};
+
+/**
+ * V4l2CaptureSource - Linux原生V4L2 mmap流式采集
+ * VIDIOC_REQBUFS申请少量驱动缓冲并mmap，grab出队最新一帧(更旧的立即归还)，
+ * retrieve直接从映射内存转换/解码到帧池缓冲后归还，中间不经过VideoCapture的拷贝。
+ * 支持YUYV、NV12、MJPEG；MJPEG按检测尺寸DCT缩放解码，并保留原始JPEG用于证据
+ */
+class V4l2CaptureSource : public CaptureSource {
+public:
+    V4l2CaptureSource(int32_t captureWidth, int32_t captureHeight,
+        const std::string& pixelFormat, uint32_t bufferCount = 4);
+    ~V4l2CaptureSource() override;
+
+    bool open(int32_t deviceIndex, int32_t width, int32_t height) override;
+    bool isOpened() const override { return m_streaming; }
+    bool grab() override;
+    bool retrieve(FrameHandle& frame) override;
+    cv::Size getFrameSize() const override { return m_frameSize; }
+    const char* getName() const override { return "v4l2"; }
+    bool getCaptureTime(std::chrono::steady_clock::time_point& captureTime) const override;
+
+    // 最近grab帧的零拷贝视图，下一次grab/retrieve/close后失效
+    bool peek(V4l2FrameView& view) const;
+    void close();
+
+    uint64_t getStaleDropCount() const { return m_staleDropCnt; }
+
+private:
+    struct Buffer {
+        void* start{ nullptr };
+        size_t length{ 0 };
+    };
+
+    bool xioctl(unsigned long request, void* arg) const;
+    bool setupFormat();
+    bool setupBuffers();
+    bool queueBuffer(uint32_t index);
+    bool dequeueBuffer(V4l2FrameView& view, int32_t& index);
+    void releaseHeld();
+    bool convert(const V4l2FrameView& view, FrameHandle& frame);
+
+private:
+    int32_t m_captureWidth;
+    int32_t m_captureHeight;
+    std::string m_pixelFormatName;
+    uint32_t m_bufferCount;
+
+    int m_fd{ -1 };
+    std::vector<Buffer> m_buffers;
+    bool m_streaming{ false };
+    uint32_t m_fourcc{ 0 };
+    uint32_t m_bytesPerLine{ 0 };
+    cv::Size m_frameSize;
+    int32_t m_targetLongSide{ 640 };
+
+    V4l2FrameView m_held;           // 当前出队未归还的缓冲
+    int32_t m_heldIndex{ -1 };
+    uint64_t m_staleDropCnt{ 0 };   // grab时丢弃的积压帧
+};
+
+#endif // __linux__
+
+#endif // V4L2_CAPTURE_SOURCE_H
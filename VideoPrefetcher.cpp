@@ -0,0 +1,89 @@
+#include "VideoPrefetcher.h"
+#include "MyLogger.hpp"
+
+#include <chrono>
+
+VideoPrefetcher::VideoPrefetcher(size_t depth)
+    : m_depth(depth > 0 ? depth : 1) {
+}
+
+VideoPrefetcher::~VideoPrefetcher() {
+    stop();
+}
+
+void VideoPrefetcher::start(cv::VideoCapture* cap, FramePool* pool) {
+    stop();
+    m_cap = cap;
+    m_pool = pool;
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        m_queue.clear();
+        m_endOfStream = false;
+    }
+    m_running.store(true);
+    m_readThd = std::thread(&VideoPrefetcher::readLoop, this);
+}
+
+void VideoPrefetcher::stop() {
+    m_running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+    }
+    m_notFull.notify_all();
+    m_notEmpty.notify_all();
+    if (m_readThd.joinable()) {
+        m_readThd.join();
+    }
+    std::lock_guard<std::mutex> lock(m_queueMtx);
+    m_queue.clear();
+}
+
+bool VideoPrefetcher::pop(FrameHandle& frame, double& decodeMs) {
+    std::unique_lock<std::mutex> lock(m_queueMtx);
+    m_notEmpty.wait(lock, [this] { return !m_queue.empty() || m_endOfStream || !m_running.load(); });
+    if (m_queue.empty()) {
+        return false;
+    }
+    frame = std::move(m_queue.front().frame);
+    decodeMs = m_queue.front().decodeMs;
+    m_queue.pop_front();
+    lock.unlock();
+    m_notFull.notify_one();
+    return true;
+}
+
+void VideoPrefetcher::readLoop() {
+    MY_SPDLOG_INFO(">>>");
+    uint64_t frameCnt = 0;
+    while (m_running.load()) {
+        {
+            std::unique_lock<std::mutex> lock(m_queueMtx);
+            m_notFull.wait(lock, [this] { return m_queue.size() < m_depth || !m_running.load(); });
+        }
+        if (!m_running.load()) {
+            break;
+        }
+
+        // 帧缓冲被检测/告警线程占满时稍后重试，不丢帧
+        FrameHandle frame = m_pool->acquire();
+        if (!frame) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        const bool ok = m_cap->read(frame.writable()) && !frame.empty();
+        double decodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        std::lock_guard<std::mutex> lock(m_queueMtx);
+        if (!ok) {
+            m_endOfStream = true;
+            m_notEmpty.notify_all();
+            break;
+        }
+        m_queue.push_back({ std::move(frame), decodeMs });
+        ++frameCnt;
+        m_notEmpty.notify_one();
+    }
+    MY_SPDLOG_INFO("<<< prefetched frames: {}", frameCnt);
+}
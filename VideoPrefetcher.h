@@ -0,0 +1,56 @@
+#ifndef VIDEO_PREFETCHER_H
+#define VIDEO_PREFETCHER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "FramePool.h"
+
+/**
+ * VideoPrefetcher - 测试视频回放的预读线程
+ * 独立线程按顺序解码到有界队列，解码与检测流水并行；与摄像头信箱不同，不丢帧，
+ * 队列满时解码线程等待，保证每次回放处理的帧序列完全一致
+ */
+class VideoPrefetcher {
+public:
+    explicit VideoPrefetcher(size_t depth = DEFAULT_DEPTH);
+    ~VideoPrefetcher();
+    VideoPrefetcher(const VideoPrefetcher&) = delete;
+    VideoPrefetcher& operator=(const VideoPrefetcher&) = delete;
+
+    // cap和pool在stop之前必须保持有效
+    void start(cv::VideoCapture* cap, FramePool* pool);
+    void stop();
+
+    // 按顺序取下一帧，decodeMs为该帧解码耗时；视频结束或已停止返回false
+    bool pop(FrameHandle& frame, double& decodeMs);
+
+    static constexpr size_t DEFAULT_DEPTH = 4;
+
+private:
+    struct Item {
+        FrameHandle frame;
+        double decodeMs{ 0.0 };
+    };
+
+    void readLoop();
+
+private:
+    size_t m_depth;
+    cv::VideoCapture* m_cap{ nullptr };
+    FramePool* m_pool{ nullptr };
+    std::thread m_readThd;
+    std::atomic_bool m_running{ false };
+    bool m_endOfStream{ false };
+    std::mutex m_queueMtx;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::deque<Item> m_queue;
+};
+
+#endif // VIDEO_PREFETCHER_H
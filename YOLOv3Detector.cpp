@@ -1,5 +1,7 @@
 #include "YOLOv3Detector.h"
 #include "MyLogger.hpp"
+#include "DebugVisualizer.h"
+#include "LatencyStats.h"
 #include <fstream>
 #include <sstream>
 #include <cmath>
@@ -215,13 +217,6 @@ const std::map<int, std::string> labelMap = {
     {2, "phone"}
 };
 
-// 颜色映射 (BGR格式)
-const std::map<int, cv::Scalar> colorMap = {
-    {0, cv::Scalar(0, 255, 0)},    // 绿色 - face
-    {1, cv::Scalar(0, 165, 255)},  // 橙色 - len
-    {2, cv::Scalar(255, 0, 0)}     // 红色 - phone
-};
-
 void YOLOv3Detector::detect(const cv::Mat& frame, uint32_t& lenCnt, uint32_t& phoneCnt,
         uint32_t& faceCnt, uint32_t& suspectedCnt) {
     if (!m_initialized) {
@@ -229,6 +224,8 @@ void YOLOv3Detector::detect(const cv::Mat& frame, uint32_t& lenCnt, uint32_t& ph
     }
 
     try {
+        LatencyStats* latency = LatencyStats::getInstance();
+        auto t0 = std::chrono::steady_clock::now();
         // 预处理图像 (包含缩放和填充)
         PreprocessImage(frame);
 
@@ -241,6 +238,7 @@ void YOLOv3Detector::detect(const cv::Mat& frame, uint32_t& lenCnt, uint32_t& ph
         );
 
         // 设置输入并推理
+        auto t1 = std::chrono::steady_clock::now();
         m_infer_request.set_input_tensor(input_tensor);
         m_infer_request.infer();
 
@@ -255,10 +253,12 @@ void YOLOv3Detector::detect(const cv::Mat& frame, uint32_t& lenCnt, uint32_t& ph
 
         const float* dets = dets_tensor.data<const float>();
         const int64_t* labels = labels_tensor.data<const int64_t>();
+        auto t2 = std::chrono::steady_clock::now();
 
         // 处理后处理结果
         lenCnt = 0, phoneCnt = 0, faceCnt = 0, suspectedCnt = 0;
         std::vector<cv::Rect> phones, lens;
+        std::vector<Detection> debugDets;
         cv::Rect bbox(0, 0, 0, 0);
         float score = 0.0f;
         int64_t label = 0;
@@ -335,17 +335,8 @@ void YOLOv3Detector::detect(const cv::Mat& frame, uint32_t& lenCnt, uint32_t& ph
             }
 
             if (m_imgDebugMode) {
-                // 绘制检测结果
-                std::string labelText = labelMap.count(label) ? labelMap.at(label) : "Unknown";
-                cv::Scalar color = colorMap.count(label) ? colorMap.at(label) : cv::Scalar(0, 255, 255);
-
-                cv::rectangle(frame, bbox, color, 2);
-                std::ostringstream label_ss;
-                label_ss << labelText << ": " << std::fixed << std::setprecision(2) << score;
-
-                cv::putText(frame, label_ss.str(),
-                    cv::Point(bbox.x, bbox.y - 5),
-                    cv::FONT_HERSHEY_SIMPLEX, 0.5, color, 1);
+                // 仅收集结果，绘制在DebugVisualizer渲染线程完成
+                debugDets.push_back({ bbox, score, static_cast<int>(label) });
             }
 
         }
@@ -357,17 +348,14 @@ void YOLOv3Detector::detect(const cv::Mat& frame, uint32_t& lenCnt, uint32_t& ph
                 }
             }
         }
+        latency->record(LatencyStage::Preprocess, t1 - t0);
+        latency->record(LatencyStage::Inference, t2 - t1);
+        latency->record(LatencyStage::Postprocess, std::chrono::steady_clock::now() - t2);
 
         if (m_imgDebugMode) {
-            // 显示计数信息
-            std::ostringstream info;
-            info << "Lens: " << lenCnt << " | Phones: " << phoneCnt
-                << " | Faces: " << faceCnt << " | Suspected: " << suspectedCnt;
-            cv::putText(frame, info.str(), cv::Point(10, 30),
-                cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 255), 2);
-
-            // 显示帧
-            cv::imshow("debug", frame);
+            DebugVisualizer::getInstance()->submit(frame, debugDets,
+                cv::format("Lens: %u | Phones: %u | Faces: %u | Suspected: %u",
+                    lenCnt, phoneCnt, faceCnt, suspectedCnt));
         }
     }
     catch (const std::exception& e) {
@@ -422,6 +410,13 @@ void YOLOv3Detector::setDetectParam(std::shared_ptr<MyMeta>& meta) {
 
 void YOLOv3Detector::setImgDebugMode(bool imgDebugMode) {
     m_imgDebugMode = imgDebugMode;
+    if (m_imgDebugMode) {
+        std::vector<std::string> classNames;
+        for (const auto& item : labelMap) {
+            classNames.push_back(item.second);
+        }
+        DebugVisualizer::getInstance()->setClassNames(classNames);
+    }
 }
 
 void YOLOv3Detector::onConfigUpdated(std::shared_ptr<MyMeta>& newMeta) {
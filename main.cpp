@@ -24,6 +24,7 @@
 #include "MyWindMsgBox.h"
 #include "YOLOv3Detector.h"
 #include "SingletonApp.h"
+#include "DebugVisualizer.h"
 
 #include <chrono>
 #include <cstddef>
@@ -246,7 +247,8 @@ int main(int argc, char* argv[]) {
             break;
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        // 调试预览窗口只能在主线程显示，等待期间顺便刷新
+        DebugVisualizer::getInstance()->pumpWindow(1000);
         if (false == imgProc->getWorkThreadStatus()) {
             if (testVideoPath.empty()) {
                 MyWindMsgBox box("打开摄像头失败, 请联系管理员");
@@ -261,6 +263,7 @@ int main(int argc, char* argv[]) {
     }
     confSub->stop();
     imgProc->stop();
+    DebugVisualizer::getInstance()->showPending();
     // 恢复原始的 stdout 和 stderr
     fclose(stdout);
     fclose(stderr);